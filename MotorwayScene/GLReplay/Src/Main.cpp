@@ -0,0 +1,129 @@
+#include "TraceReplayer.h"
+#include "Core/WindowFrame.h"
+#include "Utils/LoggingManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct ReplayOptions
+	{
+		std::string m_tracePath;
+		std::string m_outputPath;
+		uint32_t m_numLoops; // How many times the frames are run back to back
+		bool m_headless;
+	};
+
+	float GetPercentile(const std::vector<float>& sortedTimes, float percentile)
+	{
+		// Nearest rank, the same as the benchmark, so the two reports can be compared
+		const size_t rank = (size_t)std::ceil(percentile / 100.0f * (float)sortedTimes.size());
+		return sortedTimes[std::min(std::max(rank, (size_t)1), sortedTimes.size()) - 1];
+	}
+
+	void WriteResults(const ReplayOptions& options, const GLTrace::Header& header, std::vector<float> frameTimes,
+		float totalTime)
+	{
+		std::sort(frameTimes.begin(), frameTimes.end());
+
+		float sum = 0.0f;
+		for (const float time : frameTimes)
+			sum += time;
+
+		const float average = sum / (float)frameTimes.size();
+		OutputLog("Replayed " + std::to_string(frameTimes.size()) + " frames in " + std::to_string(totalTime) + "ms, " +
+			"frame time average " + std::to_string(average) + "ms, p50 " + std::to_string(GetPercentile(frameTimes, 50.0f)) +
+			"ms, p99 " + std::to_string(GetPercentile(frameTimes, 99.0f)) + "ms", Logging::Severity::NOTIFICATION);
+
+		std::ofstream file(options.m_outputPath);
+		if (!file.is_open())
+		{
+			OutputLog("Failed to write the replay results to \"" + options.m_outputPath + "\"", Logging::Severity::WARNING);
+			return;
+		}
+
+		file << std::fixed << std::setprecision(3);
+		file << "{\n";
+		file << "\t\"trace\": \"" << options.m_tracePath << "\",\n";
+		file << "\t\"width\": " << header.m_width << ",\n";
+		file << "\t\"height\": " << header.m_height << ",\n";
+		file << "\t\"headless\": " << (options.m_headless ? "true" : "false") << ",\n";
+		file << "\t\"loops\": " << options.m_numLoops << ",\n";
+		file << "\t\"frames\": " << frameTimes.size() << ",\n";
+		file << "\t\"total_ms\": " << totalTime << ",\n";
+		file << "\t\"frame_time_ms\": { \"average\": " << average << ", \"p50\": " << GetPercentile(frameTimes, 50.0f) <<
+			", \"p95\": " << GetPercentile(frameTimes, 95.0f) << ", \"p99\": " << GetPercentile(frameTimes, 99.0f) <<
+			", \"min\": " << frameTimes.front() << ", \"max\": " << frameTimes.back() << " }\n";
+		file << "}\n";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// "GLReplay <trace> [--headless] [--loops=<count>] [--output=<path>]", where the trace is one written by running the
+	// scene with "--gl-capture"
+	ReplayOptions options = { "gl_capture.trace", "replay.json", 1, false };
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+		if (argument == "--headless")
+			options.m_headless = true;
+		else if (argument.compare(0, 8, "--loops=") == 0)
+			options.m_numLoops = (uint32_t)std::max(std::atoi(argument.substr(8).c_str()), 1);
+		else if (argument.compare(0, 9, "--output=") == 0)
+			options.m_outputPath = argument.substr(9);
+		else if (argument.compare(0, 2, "--") != 0)
+			options.m_tracePath = argument;
+	}
+
+	TraceReplayer replayer;
+	if (!replayer.LoadTrace(options.m_tracePath))
+		return 1;
+
+	const GLTrace::Header& header = replayer.GetHeader();
+	auto window = Core::GenerateWindow("GLReplay", header.m_width, header.m_height, options.m_headless);
+
+	// The frames are run as fast as they'll go. Besides the driver and GPU, the times include decoding the trace, which
+	// stops allocating once its scratch buffers have grown to fit the first loop's commands.
+	window->SetVSync(false);
+	replayer.ReplayLoad();
+
+	std::vector<float> frameTimes;
+	frameTimes.reserve((size_t)header.m_numFrames * options.m_numLoops);
+
+	const auto replayStart = std::chrono::steady_clock::now();
+	for (uint32_t loop = 0; loop < options.m_numLoops && !window->WasRequestedClose(); loop++)
+	{
+		replayer.RewindFrames();
+
+		auto frameStart = std::chrono::steady_clock::now();
+		while (replayer.ReplayFrame() && !window->WasRequestedClose())
+		{
+			window->UpdateTick();
+
+			const auto frameEnd = std::chrono::steady_clock::now();
+			frameTimes.emplace_back(std::chrono::duration<float, std::milli>(frameEnd - frameStart).count());
+			frameStart = frameEnd;
+		}
+	}
+
+	// Anything still queued is waited on, so the total covers all of the work
+	glFinish();
+	const float totalTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - replayStart).count();
+
+	if (frameTimes.empty())
+	{
+		OutputLog("The GL trace \"" + options.m_tracePath + "\" has no frames to replay", Logging::Severity::WARNING);
+		return 1;
+	}
+
+	WriteResults(options, header, frameTimes, totalTime);
+	return 0;
+}
\ No newline at end of file
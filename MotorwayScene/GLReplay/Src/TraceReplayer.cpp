@@ -0,0 +1,611 @@
+#include "TraceReplayer.h"
+#include "Utils/LoggingManager.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+using GLTrace::Command;
+
+TraceReplayer::TraceReplayer() :
+	m_header(), m_readOffset(0), m_framesOffset(0), m_currentProgram(0)
+{}
+
+TraceReplayer::~TraceReplayer() {}
+
+bool TraceReplayer::LoadTrace(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		OutputLog("Failed to open the GL trace \"" + filePath + "\"", Logging::Severity::WARNING);
+		return false;
+	}
+
+	const std::streamsize fileSize = file.tellg();
+	file.seekg(0);
+
+	if (fileSize < (std::streamsize)sizeof(GLTrace::Header) || !file.read((char*)&m_header, sizeof(m_header)) ||
+		m_header.m_magic != GLTrace::MAGIC)
+	{
+		OutputLog("\"" + filePath + "\" isn't a GL trace", Logging::Severity::WARNING);
+		return false;
+	}
+
+	if (m_header.m_version != GLTrace::VERSION)
+	{
+		OutputLog("The GL trace \"" + filePath + "\" is version " + std::to_string(m_header.m_version) + ", but only " +
+			"version " + std::to_string(GLTrace::VERSION) + " can be replayed", Logging::Severity::WARNING);
+		return false;
+	}
+
+	m_trace.resize((size_t)fileSize - sizeof(GLTrace::Header));
+	file.read((char*)m_trace.data(), m_trace.size());
+
+	return true;
+}
+
+void TraceReplayer::ReplayLoad()
+{
+	m_readOffset = 0;
+	while (m_readOffset < m_trace.size() && this->RunCommand() != Command::LOAD_END) {}
+
+	m_framesOffset = m_readOffset;
+}
+
+bool TraceReplayer::ReplayFrame()
+{
+	if (m_readOffset >= m_trace.size())
+		return false;
+
+	while (m_readOffset < m_trace.size() && this->RunCommand() != Command::FRAME_END) {}
+	return true;
+}
+
+void TraceReplayer::RewindFrames()
+{
+	m_readOffset = m_framesOffset;
+}
+
+template<typename T>
+T TraceReplayer::Read()
+{
+	// The records are packed with no padding, so the values are copied out rather than read in place
+	T value;
+	std::memcpy(&value, &m_trace[m_readOffset], sizeof(T));
+	m_readOffset += sizeof(T);
+
+	return value;
+}
+
+const void* TraceReplayer::ReadPayload(uint32_t& size)
+{
+	size = this->Read<uint32_t>();
+	const void* data = (size > 0) ? &m_trace[m_readOffset] : nullptr;
+	m_readOffset += size;
+
+	return data;
+}
+
+template<typename T>
+const T* TraceReplayer::ReadArray(uint32_t& count)
+{
+	uint32_t size = 0;
+	const void* data = this->ReadPayload(size);
+	count = size / sizeof(T);
+
+	static_assert(alignof(T) <= alignof(uint64_t), "The scratch buffer isn't aligned for the array's type");
+	if (m_scratch.size() * sizeof(uint64_t) < size)
+		m_scratch.resize((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+	if (size > 0)
+		std::memcpy(m_scratch.data(), data, count * sizeof(T));
+
+	return (const T*)m_scratch.data();
+}
+
+GLuint TraceReplayer::MapName(const NameMap& names, GLuint name) const
+{
+	return (name < names.size()) ? names[name] : 0;
+}
+
+void TraceReplayer::AddName(NameMap& names, GLuint name, GLuint newName)
+{
+	if (name >= names.size())
+		names.resize((size_t)name + 1, 0);
+
+	names[name] = newName;
+}
+
+GLint TraceReplayer::MapUniform(GLint location) const
+{
+	if (m_currentProgram >= m_uniformLocations.size() || location < 0)
+		return -1;
+
+	const auto& locations = m_uniformLocations[m_currentProgram];
+	return ((size_t)location < locations.size()) ? locations[location] : -1;
+}
+
+void TraceReplayer::GenerateNames(NameMap& names, PFNGLGENBUFFERSPROC generate)
+{
+	const GLsizei count = this->Read<GLsizei>();
+	uint32_t numRecorded = 0;
+	const GLuint* recordedNames = this->ReadArray<GLuint>(numRecorded);
+
+	m_names.resize(count);
+	generate(count, m_names.data());
+
+	for (GLsizei i = 0; i < count; i++)
+		this->AddName(names, recordedNames[i], m_names[i]);
+}
+
+void TraceReplayer::DeleteNames(NameMap& names, PFNGLDELETEBUFFERSPROC erase)
+{
+	const GLsizei count = this->Read<GLsizei>();
+	uint32_t numRecorded = 0;
+	const GLuint* recordedNames = this->ReadArray<GLuint>(numRecorded);
+
+	m_names.resize(numRecorded);
+	for (uint32_t i = 0; i < numRecorded; i++)
+	{
+		m_names[i] = this->MapName(names, recordedNames[i]);
+		if (recordedNames[i] < names.size())
+			names[recordedNames[i]] = 0;
+	}
+
+	erase(count, m_names.data());
+}
+
+GLTrace::Command TraceReplayer::RunCommand()
+{
+	const Command command = this->Read<Command>();
+	uint32_t payloadSize = 0;
+
+	switch (command)
+	{
+	case Command::LOAD_END:
+	case Command::FRAME_END:
+		break;
+	case Command::GEN_BUFFERS:
+		this->GenerateNames(m_buffers, glGenBuffers);
+		break;
+	case Command::GEN_TEXTURES:
+		this->GenerateNames(m_textures, glGenTextures);
+		break;
+	case Command::GEN_FRAMEBUFFERS:
+		this->GenerateNames(m_framebuffers, glGenFramebuffers);
+		break;
+	case Command::GEN_RENDERBUFFERS:
+		this->GenerateNames(m_renderbuffers, glGenRenderbuffers);
+		break;
+	case Command::GEN_VERTEX_ARRAYS:
+		this->GenerateNames(m_vertexArrays, glGenVertexArrays);
+		break;
+	case Command::GEN_QUERIES:
+		this->GenerateNames(m_queries, glGenQueries);
+		break;
+	case Command::DELETE_BUFFERS:
+		this->DeleteNames(m_buffers, glDeleteBuffers);
+		break;
+	case Command::DELETE_TEXTURES:
+		this->DeleteNames(m_textures, glDeleteTextures);
+		break;
+	case Command::DELETE_FRAMEBUFFERS:
+		this->DeleteNames(m_framebuffers, glDeleteFramebuffers);
+		break;
+	case Command::DELETE_RENDERBUFFERS:
+		this->DeleteNames(m_renderbuffers, glDeleteRenderbuffers);
+		break;
+	case Command::DELETE_VERTEX_ARRAYS:
+		this->DeleteNames(m_vertexArrays, glDeleteVertexArrays);
+		break;
+	case Command::DELETE_QUERIES:
+		this->DeleteNames(m_queries, glDeleteQueries);
+		break;
+	case Command::CREATE_SHADER:
+	{
+		const GLenum type = this->Read<GLenum>();
+		this->AddName(m_programs, this->Read<GLuint>(), glCreateShader(type));
+		break;
+	}
+	case Command::CREATE_PROGRAM:
+	{
+		const GLuint program = this->Read<GLuint>();
+		this->AddName(m_programs, program, glCreateProgram());
+		break;
+	}
+	case Command::DELETE_SHADER:
+	{
+		const GLuint shader = this->Read<GLuint>();
+		glDeleteShader(this->MapName(m_programs, shader));
+		this->AddName(m_programs, shader, 0);
+		break;
+	}
+	case Command::DELETE_PROGRAM:
+	{
+		const GLuint program = this->Read<GLuint>();
+		glDeleteProgram(this->MapName(m_programs, program));
+		this->AddName(m_programs, program, 0);
+		break;
+	}
+	case Command::SHADER_SOURCE:
+	{
+		const GLuint shader = this->MapName(m_programs, this->Read<GLuint>());
+		const GLchar* source = (const GLchar*)this->ReadPayload(payloadSize);
+		const GLint length = (GLint)payloadSize;
+		glShaderSource(shader, 1, &source, &length);
+		break;
+	}
+	case Command::COMPILE_SHADER:
+		glCompileShader(this->MapName(m_programs, this->Read<GLuint>()));
+		break;
+	case Command::ATTACH_SHADER:
+	{
+		const GLuint program = this->MapName(m_programs, this->Read<GLuint>());
+		glAttachShader(program, this->MapName(m_programs, this->Read<GLuint>()));
+		break;
+	}
+	case Command::LINK_PROGRAM:
+		glLinkProgram(this->MapName(m_programs, this->Read<GLuint>()));
+		break;
+	case Command::USE_PROGRAM:
+		m_currentProgram = this->Read<GLuint>();
+		glUseProgram(this->MapName(m_programs, m_currentProgram));
+		break;
+	case Command::GET_UNIFORM_LOCATION:
+	{
+		const GLuint program = this->Read<GLuint>();
+		const GLint location = this->Read<GLint>();
+		const char* name = (const char*)this->ReadPayload(payloadSize);
+
+		// The payload isn't null terminated
+		m_uniformName.assign(name, payloadSize);
+		const GLint newLocation = glGetUniformLocation(this->MapName(m_programs, program), m_uniformName.c_str());
+
+		if (location >= 0)
+		{
+			if (program >= m_uniformLocations.size())
+				m_uniformLocations.resize((size_t)program + 1);
+
+			auto& locations = m_uniformLocations[program];
+			if ((size_t)location >= locations.size())
+				locations.resize((size_t)location + 1, -1);
+
+			locations[location] = newLocation;
+		}
+		break;
+	}
+	case Command::UNIFORM_1I:
+	{
+		const GLint location = this->MapUniform(this->Read<GLint>());
+		glUniform1i(location, this->Read<GLint>());
+		break;
+	}
+	case Command::UNIFORM_1F:
+	{
+		const GLint location = this->MapUniform(this->Read<GLint>());
+		glUniform1f(location, this->Read<GLfloat>());
+		break;
+	}
+	case Command::UNIFORM_2FV:
+	case Command::UNIFORM_3FV:
+	{
+		const GLint location = this->MapUniform(this->Read<GLint>());
+		const GLsizei count = this->Read<GLsizei>();
+		uint32_t numValues = 0;
+		const GLfloat* values = this->ReadArray<GLfloat>(numValues);
+
+		if (command == Command::UNIFORM_2FV)
+			glUniform2fv(location, count, values);
+		else
+			glUniform3fv(location, count, values);
+		break;
+	}
+	case Command::UNIFORM_MATRIX_4FV:
+	{
+		const GLint location = this->MapUniform(this->Read<GLint>());
+		const GLsizei count = this->Read<GLsizei>();
+		const GLboolean transpose = this->Read<GLboolean>();
+		uint32_t numValues = 0;
+		glUniformMatrix4fv(location, count, transpose, this->ReadArray<GLfloat>(numValues));
+		break;
+	}
+	case Command::BIND_BUFFER:
+	{
+		const GLenum target = this->Read<GLenum>();
+		glBindBuffer(target, this->MapName(m_buffers, this->Read<GLuint>()));
+		break;
+	}
+	case Command::BUFFER_DATA:
+	{
+		const GLenum target = this->Read<GLenum>();
+		const GLsizeiptr size = (GLsizeiptr)this->Read<uint64_t>();
+		const GLenum usage = this->Read<GLenum>();
+		glBufferData(target, size, this->ReadPayload(payloadSize), usage);
+		break;
+	}
+	case Command::BUFFER_SUB_DATA:
+	{
+		const GLenum target = this->Read<GLenum>();
+		const GLintptr offset = (GLintptr)this->Read<uint64_t>();
+		const void* data = this->ReadPayload(payloadSize);
+		glBufferSubData(target, offset, payloadSize, data);
+		break;
+	}
+	case Command::BIND_VERTEX_ARRAY:
+		glBindVertexArray(this->MapName(m_vertexArrays, this->Read<GLuint>()));
+		break;
+	case Command::ENABLE_VERTEX_ATTRIB_ARRAY:
+		glEnableVertexAttribArray(this->Read<GLuint>());
+		break;
+	case Command::VERTEX_ATTRIB_POINTER:
+	{
+		const GLuint index = this->Read<GLuint>();
+		const GLint size = this->Read<GLint>();
+		const GLenum type = this->Read<GLenum>();
+		const GLboolean normalized = this->Read<GLboolean>();
+		const GLsizei stride = this->Read<GLsizei>();
+		glVertexAttribPointer(index, size, type, normalized, stride, (const void*)(uintptr_t)this->Read<uint64_t>());
+		break;
+	}
+	case Command::VERTEX_ATTRIB_DIVISOR:
+	{
+		const GLuint index = this->Read<GLuint>();
+		glVertexAttribDivisor(index, this->Read<GLuint>());
+		break;
+	}
+	case Command::ACTIVE_TEXTURE:
+		glActiveTexture(this->Read<GLenum>());
+		break;
+	case Command::BIND_TEXTURE:
+	{
+		const GLenum target = this->Read<GLenum>();
+		glBindTexture(target, this->MapName(m_textures, this->Read<GLuint>()));
+		break;
+	}
+	case Command::TEX_IMAGE_2D:
+	{
+		const GLenum target = this->Read<GLenum>();
+		const GLint level = this->Read<GLint>(), internalFormat = this->Read<GLint>();
+		const GLsizei width = this->Read<GLsizei>(), height = this->Read<GLsizei>();
+		const GLint border = this->Read<GLint>();
+		const GLenum format = this->Read<GLenum>(), type = this->Read<GLenum>();
+		glTexImage2D(target, level, internalFormat, width, height, border, format, type, this->ReadPayload(payloadSize));
+		break;
+	}
+	case Command::TEX_SUB_IMAGE_2D:
+	{
+		const GLenum target = this->Read<GLenum>();
+		const GLint level = this->Read<GLint>(), x = this->Read<GLint>(), y = this->Read<GLint>();
+		const GLsizei width = this->Read<GLsizei>(), height = this->Read<GLsizei>();
+		const GLenum format = this->Read<GLenum>(), type = this->Read<GLenum>();
+		glTexSubImage2D(target, level, x, y, width, height, format, type, this->ReadPayload(payloadSize));
+		break;
+	}
+	case Command::TEX_IMAGE_2D_MULTISAMPLE:
+	{
+		const GLenum target = this->Read<GLenum>();
+		const GLsizei samples = this->Read<GLsizei>();
+		const GLenum internalFormat = this->Read<GLenum>();
+		const GLsizei width = this->Read<GLsizei>(), height = this->Read<GLsizei>();
+		glTexImage2DMultisample(target, samples, internalFormat, width, height, this->Read<GLboolean>());
+		break;
+	}
+	case Command::TEX_PARAMETER_I:
+	{
+		const GLenum target = this->Read<GLenum>(), name = this->Read<GLenum>();
+		glTexParameteri(target, name, this->Read<GLint>());
+		break;
+	}
+	case Command::TEX_PARAMETER_FV:
+	{
+		const GLenum target = this->Read<GLenum>(), name = this->Read<GLenum>();
+		uint32_t numValues = 0;
+		glTexParameterfv(target, name, this->ReadArray<GLfloat>(numValues));
+		break;
+	}
+	case Command::TEX_BUFFER:
+	{
+		const GLenum target = this->Read<GLenum>(), internalFormat = this->Read<GLenum>();
+		glTexBuffer(target, internalFormat, this->MapName(m_buffers, this->Read<GLuint>()));
+		break;
+	}
+	case Command::GENERATE_MIPMAP:
+		glGenerateMipmap(this->Read<GLenum>());
+		break;
+	case Command::BIND_FRAMEBUFFER:
+	{
+		const GLenum target = this->Read<GLenum>();
+		glBindFramebuffer(target, this->MapName(m_framebuffers, this->Read<GLuint>()));
+		break;
+	}
+	case Command::BIND_RENDERBUFFER:
+	{
+		const GLenum target = this->Read<GLenum>();
+		glBindRenderbuffer(target, this->MapName(m_renderbuffers, this->Read<GLuint>()));
+		break;
+	}
+	case Command::RENDERBUFFER_STORAGE:
+	{
+		const GLenum target = this->Read<GLenum>(), internalFormat = this->Read<GLenum>();
+		const GLsizei width = this->Read<GLsizei>();
+		glRenderbufferStorage(target, internalFormat, width, this->Read<GLsizei>());
+		break;
+	}
+	case Command::RENDERBUFFER_STORAGE_MULTISAMPLE:
+	{
+		const GLenum target = this->Read<GLenum>();
+		const GLsizei samples = this->Read<GLsizei>();
+		const GLenum internalFormat = this->Read<GLenum>();
+		const GLsizei width = this->Read<GLsizei>();
+		glRenderbufferStorageMultisample(target, samples, internalFormat, width, this->Read<GLsizei>());
+		break;
+	}
+	case Command::FRAMEBUFFER_TEXTURE:
+	{
+		const GLenum target = this->Read<GLenum>(), attachment = this->Read<GLenum>();
+		const GLuint texture = this->MapName(m_textures, this->Read<GLuint>());
+		glFramebufferTexture(target, attachment, texture, this->Read<GLint>());
+		break;
+	}
+	case Command::FRAMEBUFFER_TEXTURE_2D:
+	{
+		const GLenum target = this->Read<GLenum>(), attachment = this->Read<GLenum>(), textureTarget = this->Read<GLenum>();
+		const GLuint texture = this->MapName(m_textures, this->Read<GLuint>());
+		glFramebufferTexture2D(target, attachment, textureTarget, texture, this->Read<GLint>());
+		break;
+	}
+	case Command::FRAMEBUFFER_RENDERBUFFER:
+	{
+		const GLenum target = this->Read<GLenum>(), attachment = this->Read<GLenum>();
+		const GLenum renderbufferTarget = this->Read<GLenum>();
+		glFramebufferRenderbuffer(target, attachment, renderbufferTarget, this->MapName(m_renderbuffers, 
+			this->Read<GLuint>()));
+		break;
+	}
+	case Command::DRAW_BUFFER:
+		glDrawBuffer(this->Read<GLenum>());
+		break;
+	case Command::DRAW_BUFFERS:
+	{
+		const GLsizei count = this->Read<GLsizei>();
+		uint32_t numBuffers = 0;
+		glDrawBuffers(count, this->ReadArray<GLenum>(numBuffers));
+		break;
+	}
+	case Command::READ_BUFFER:
+		glReadBuffer(this->Read<GLenum>());
+		break;
+	case Command::BLIT_FRAMEBUFFER:
+	{
+		GLint coords[8];
+		for (GLint& coord : coords)
+			coord = this->Read<GLint>();
+
+		const GLbitfield mask = this->Read<GLbitfield>();
+		glBlitFramebuffer(coords[0], coords[1], coords[2], coords[3], coords[4], coords[5], coords[6], coords[7], mask,
+			this->Read<GLenum>());
+		break;
+	}
+	case Command::ENABLE:
+		glEnable(this->Read<GLenum>());
+		break;
+	case Command::DISABLE:
+		glDisable(this->Read<GLenum>());
+		break;
+	case Command::BLEND_FUNC:
+	{
+		const GLenum source = this->Read<GLenum>();
+		glBlendFunc(source, this->Read<GLenum>());
+		break;
+	}
+	case Command::DEPTH_FUNC:
+		glDepthFunc(this->Read<GLenum>());
+		break;
+	case Command::DEPTH_MASK:
+		glDepthMask(this->Read<GLboolean>());
+		break;
+	case Command::COLOR_MASK:
+	{
+		GLboolean mask[4];
+		for (GLboolean& channel : mask)
+			channel = this->Read<GLboolean>();
+
+		glColorMask(mask[0], mask[1], mask[2], mask[3]);
+		break;
+	}
+	case Command::VIEWPORT:
+	case Command::SCISSOR:
+	{
+		const GLint x = this->Read<GLint>(), y = this->Read<GLint>();
+		const GLsizei width = this->Read<GLsizei>(), height = this->Read<GLsizei>();
+
+		if (command == Command::VIEWPORT)
+			glViewport(x, y, width, height);
+		else
+			glScissor(x, y, width, height);
+		break;
+	}
+	case Command::CLEAR_COLOR:
+	{
+		GLfloat color[4];
+		for (GLfloat& channel : color)
+			channel = this->Read<GLfloat>();
+
+		glClearColor(color[0], color[1], color[2], color[3]);
+		break;
+	}
+	case Command::CLEAR:
+		glClear(this->Read<GLbitfield>());
+		break;
+	case Command::CLEAR_BUFFER_UIV:
+	{
+		const GLenum buffer = this->Read<GLenum>();
+		const GLint drawBuffer = this->Read<GLint>();
+		uint32_t numValues = 0;
+		glClearBufferuiv(buffer, drawBuffer, this->ReadArray<GLuint>(numValues));
+		break;
+	}
+	case Command::BEGIN_QUERY:
+	{
+		const GLenum target = this->Read<GLenum>();
+		glBeginQuery(target, this->MapName(m_queries, this->Read<GLuint>()));
+		break;
+	}
+	case Command::END_QUERY:
+		glEndQuery(this->Read<GLenum>());
+		break;
+	case Command::QUERY_COUNTER:
+	{
+		const GLuint query = this->MapName(m_queries, this->Read<GLuint>());
+		glQueryCounter(query, this->Read<GLenum>());
+		break;
+	}
+	case Command::BEGIN_CONDITIONAL_RENDER:
+	{
+		const GLuint query = this->MapName(m_queries, this->Read<GLuint>());
+		glBeginConditionalRender(query, this->Read<GLenum>());
+		break;
+	}
+	case Command::END_CONDITIONAL_RENDER:
+		glEndConditionalRender();
+		break;
+	case Command::DRAW_ARRAYS:
+	{
+		const GLenum mode = this->Read<GLenum>();
+		const GLint first = this->Read<GLint>();
+		glDrawArrays(mode, first, this->Read<GLsizei>());
+		break;
+	}
+	case Command::DRAW_ELEMENTS:
+	case Command::DRAW_ELEMENTS_INSTANCED:
+	{
+		const GLenum mode = this->Read<GLenum>();
+		const GLsizei count = this->Read<GLsizei>();
+		const GLenum type = this->Read<GLenum>();
+		const void* indices = (const void*)(uintptr_t)this->Read<uint64_t>();
+
+		if (command == Command::DRAW_ELEMENTS)
+			glDrawElements(mode, count, type, indices);
+		else
+			glDrawElementsInstanced(mode, count, type, indices, this->Read<GLsizei>());
+		break;
+	}
+	case Command::FLUSH:
+		glFlush();
+		break;
+	default:
+		// Nothing after an unknown command can be trusted, as there's no telling how long its arguments are
+		OutputLog("Unknown command " + std::to_string((int)command) + " in the GL trace, stopping the replay",
+			Logging::Severity::WARNING);
+		m_readOffset = m_trace.size();
+		break;
+	}
+
+	return command;
+}
+
+const GLTrace::Header& TraceReplayer::GetHeader() const
+{
+	return m_header;
+}
\ No newline at end of file
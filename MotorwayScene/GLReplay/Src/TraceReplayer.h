@@ -0,0 +1,70 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+#include "Graphics/GLTrace.h"
+
+/*
+	TraceReplayer : Runs the GL calls of a trace recorded by GLCapture. The names of the objects the app made are mapped
+	to the ones made during the replay, and the uniform locations to the ones the replay's programs hand back, so the
+	trace runs the same no matter what names the driver gives out. The loading is run once, then the frames can be run
+	one at a time as often as wanted. Nothing is allocated while the frames run, so the replayer's own cost stays out of
+	the frame times.
+*/
+class TraceReplayer
+{
+private:
+	// GL hands out small names counting up from 1, so a table indexed by the recorded name is both smaller and faster
+	// than a hash map. Names that aren't mapped are 0.
+	typedef std::vector<GLuint> NameMap;
+
+	std::vector<uint8_t> m_trace;
+	GLTrace::Header m_header;
+	size_t m_readOffset, m_framesOffset; // The frames start just after the loading's marker
+
+	NameMap m_buffers, m_textures, m_framebuffers, m_renderbuffers, m_vertexArrays, m_queries;
+	NameMap m_programs; // Shaders and programs share their names, as they do in GL
+
+	// Indexed by the recorded program then the recorded location, with -1 for locations that aren't mapped
+	std::vector<std::vector<GLint>> m_uniformLocations;
+	GLuint m_currentProgram; // The recorded name of the program in use, which the uniform locations belong to
+
+	// Reused by every command that needs them, so they only grow to the largest array in the trace
+	std::vector<uint64_t> m_scratch;
+	std::vector<GLuint> m_names;
+	std::string m_uniformName;
+private:
+	template<typename T>
+	T Read();
+	const void* ReadPayload(uint32_t& size);
+
+	// Copies the payload into the scratch buffer, as it isn't aligned for anything read through a pointer to its
+	// type. The values are only valid until the next array is read.
+	template<typename T>
+	const T* ReadArray(uint32_t& count);
+
+	GLuint MapName(const NameMap& names, GLuint name) const;
+	void AddName(NameMap& names, GLuint name, GLuint newName);
+	GLint MapUniform(GLint location) const;
+	void GenerateNames(NameMap& names, PFNGLGENBUFFERSPROC generate); // Every glGen* and glDelete* has the same signature
+	void DeleteNames(NameMap& names, PFNGLDELETEBUFFERSPROC erase);
+
+	// Runs one recorded call, returning the marker it hit if it was one
+	GLTrace::Command RunCommand();
+public:
+	TraceReplayer();
+	~TraceReplayer();
+
+	// Reads the whole trace into memory, so the replay is never held up by the disk. Returns false if it isn't a trace.
+	bool LoadTrace(const std::string& filePath);
+
+	// Runs everything up to the end of the loading, then rewinds to the first frame
+	void ReplayLoad();
+
+	// Runs the next frame, returning false once every frame has been run
+	bool ReplayFrame();
+	void RewindFrames();
+public:
+	const GLTrace::Header& GetHeader() const;
+};
\ No newline at end of file
@@ -0,0 +1,31 @@
+// Octahedral normal encoding for the G-buffer, each axis is kept to 16 bits by splitting it over two 8 bit channels
+
+vec2 SignNotZero(vec2 value)
+{
+    return vec2(value.x >= 0.0f ? 1.0f : -1.0f, value.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+vec4 PackNormal(vec3 normal)
+{
+    // Project onto the octahedron, folding the lower half over the upper half
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    vec2 encoded = (normal.z >= 0.0f) ? normal.xy : (1.0f - abs(normal.yx)) * SignNotZero(normal.xy);
+
+    vec2 scaled = floor(clamp(encoded * 0.5f + 0.5f, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    vec2 high = floor(scaled / 256.0f);
+    vec2 low = scaled - high * 256.0f;
+
+    return vec4(high.x, low.x, high.y, low.y) / 255.0f;
+}
+
+vec3 UnpackNormal(vec4 packedNormal)
+{
+    vec4 bytes = floor(packedNormal * 255.0f + 0.5f);
+    vec2 encoded = vec2(bytes.x * 256.0f + bytes.y, bytes.z * 256.0f + bytes.w) / 65535.0f * 2.0f - 1.0f;
+
+    vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold = clamp(-normal.z, 0.0f, 1.0f);
+    normal.xy -= fold * SignNotZero(normal.xy);
+
+    return normalize(normal);
+}
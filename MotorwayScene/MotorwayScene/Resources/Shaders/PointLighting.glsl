@@ -0,0 +1,70 @@
+// Clustered point lights, the light data and cluster lists are filled in by ClusteredLighting on the CPU
+
+// Must match the grid in ClusteredLighting.cpp
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+
+uniform samplerBuffer pointLightData; // Two texels per light, the position and radius then the color
+uniform usamplerBuffer clusterGrid; // The offset and count of each cluster's lights in the index list
+uniform usamplerBuffer clusterLightIndices;
+
+uniform vec2 clusterDepthRange; // The near and far planes the depth slices are spread between
+uniform vec2 projectionDepthTerms; // The camera projection's [2][2] and [3][2], which map view depth to NDC depth
+uniform vec2 clusterTileSize; // In pixels
+uniform bool usePointLights;
+
+int GetClusterIndex(vec3 windowCoord)
+{
+    float near = clusterDepthRange.x, far = clusterDepthRange.y;
+    float ndcDepth = windowCoord.z * 2.0f - 1.0f;
+    float viewDepth = projectionDepthTerms.y / (ndcDepth + projectionDepthTerms.x);
+
+    // The slices are spaced exponentially, so they stay roughly cube shaped with distance
+    int slice = clamp(int(log(viewDepth / near) / log(far / near) * CLUSTER_GRID_Z), 0, CLUSTER_GRID_Z - 1);
+    ivec2 tile = clamp(ivec2(windowCoord.xy / clusterTileSize), ivec2(0), ivec2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1));
+
+    return (slice * CLUSTER_GRID_Y + tile.y) * CLUSTER_GRID_X + tile.x;
+}
+
+/*
+    CalculatePointLights() : Adds up the Blinn-Phong lighting of every light in the fragment's cluster.
+    [windowCoord] - The fragment's window position and depth, e.g. gl_FragCoord.xyz
+    [albedo] - The diffuse color of the surface
+    [specular] - The specular color of the surface
+*/
+vec3 CalculatePointLights(vec3 windowCoord, vec3 fragmentPos, vec3 normalDir, vec3 cameraDir, vec3 albedo, vec3 specular,
+    float shininess)
+{
+    if(!usePointLights)
+        return vec3(0.0f);
+
+    uvec2 cluster = texelFetch(clusterGrid, GetClusterIndex(windowCoord)).rg;
+
+    vec3 color = vec3(0.0f);
+    for(uint i = 0u; i < cluster.y; i++)
+    {
+        int lightIndex = int(texelFetch(clusterLightIndices, int(cluster.x + i)).r);
+        vec4 positionRadius = texelFetch(pointLightData, lightIndex * 2);
+        vec3 lightColor = texelFetch(pointLightData, lightIndex * 2 + 1).rgb;
+
+        vec3 lightVector = positionRadius.xyz - fragmentPos;
+        float lightDistance = length(lightVector);
+        if(lightDistance >= positionRadius.w)
+            continue;
+
+        // Inverse square falloff, windowed so the light reaches zero at its radius
+        float window = clamp(1.0f - pow(lightDistance / positionRadius.w, 4.0f), 0.0f, 1.0f);
+        float attenuation = (window * window) / (lightDistance * lightDistance + 1.0f);
+
+        vec3 lightRay = lightVector / lightDistance;
+        float diffuseStrength = max(dot(lightRay, normalDir), 0.0f);
+
+        vec3 halfwayDir = normalize(cameraDir + lightRay);
+        float specularStrength = pow(max(dot(halfwayDir, normalDir), 0.0f), shininess);
+
+        color += attenuation * lightColor * (diffuseStrength * albedo + specularStrength * specular);
+    }
+
+    return color;
+}
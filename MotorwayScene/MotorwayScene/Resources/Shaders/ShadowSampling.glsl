@@ -0,0 +1,106 @@
+// Shared by the object shader and the screen space shadow mask, so both produce the same shadows
+
+#define SHADOW_FILTER_PCF 0
+#define SHADOW_FILTER_HARDWARE_PCF 1
+#define SHADOW_FILTER_VSM 2
+#define SHADOW_FILTER_EVSM 3
+
+// Must match the exponents the moment map was rendered with
+#define EVSM_POSITIVE_EXPONENT 40.0f
+#define EVSM_NEGATIVE_EXPONENT 5.0f
+
+uniform sampler2D depthMap;
+uniform sampler2DShadow depthMapCompare; // The same depth map, but with hardware comparison turned on
+uniform sampler2D momentMap; // Blurred and mip-mapped moments, for the VSM and EVSM filters
+uniform int shadowFilterMode;
+
+float SampleShadowPCF(vec3 projectedCoord)
+{
+    float currentDepth = projectedCoord.z;
+
+    // Apply PCF to smoothen out the shadows
+    vec2 texelSize = 1.0f / textureSize(depthMap, 0);
+    float bias = 0.001f;
+
+    float shadow = 0.0f;
+    for(int y = -1; y <= 1; y++)
+    {
+        for(int x = -1; x <= 1; x++)
+        {
+            float closestDepth = texture(depthMap, projectedCoord.xy + vec2(x, y) * texelSize).r;
+            shadow += currentDepth - bias > closestDepth ? 1.0f : 0.0f;
+        }
+    }
+
+    return (shadow / 9.0f);
+}
+
+float SampleShadowHardwarePCF(vec3 projectedCoord)
+{
+    // Each tap is already a bilinear blend of 4 comparisons, so 4 taps cover the same area as the 3x3 kernel
+    vec2 texelSize = 1.0f / textureSize(depthMapCompare, 0);
+    float compareDepth = projectedCoord.z - 0.001f;
+
+    float lit = 0.0f;
+    lit += texture(depthMapCompare, vec3(projectedCoord.xy + vec2(-0.5f, -0.5f) * texelSize, compareDepth));
+    lit += texture(depthMapCompare, vec3(projectedCoord.xy + vec2(0.5f, -0.5f) * texelSize, compareDepth));
+    lit += texture(depthMapCompare, vec3(projectedCoord.xy + vec2(-0.5f, 0.5f) * texelSize, compareDepth));
+    lit += texture(depthMapCompare, vec3(projectedCoord.xy + vec2(0.5f, 0.5f) * texelSize, compareDepth));
+
+    return 1.0f - (lit / 4.0f);
+}
+
+float ChebyshevUpperBound(vec2 moments, float depth, float minVariance)
+{
+    if(depth <= moments.x)
+        return 1.0f;
+
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float depthDelta = depth - moments.x;
+    float litProbability = variance / (variance + depthDelta * depthDelta);
+
+    // Cut off the tail of the bound, which is what shows up as light bleeding between overlapping occluders
+    const float BLEED_REDUCTION = 0.2f;
+    return clamp((litProbability - BLEED_REDUCTION) / (1.0f - BLEED_REDUCTION), 0.0f, 1.0f);
+}
+
+float SampleShadowVSM(vec3 projectedCoord)
+{
+    vec2 moments = texture(momentMap, projectedCoord.xy).rg;
+    return 1.0f - ChebyshevUpperBound(moments, projectedCoord.z, 0.00002f);
+}
+
+float SampleShadowEVSM(vec3 projectedCoord)
+{
+    vec4 moments = texture(momentMap, projectedCoord.xy);
+
+    float warpedDepth = 2.0f * projectedCoord.z - 1.0f;
+    float positiveDepth = exp(EVSM_POSITIVE_EXPONENT * warpedDepth);
+    float negativeDepth = -exp(-EVSM_NEGATIVE_EXPONENT * warpedDepth);
+
+    // The minimum variance has to be scaled into each warped space
+    float positiveScale = 0.0001f * EVSM_POSITIVE_EXPONENT * positiveDepth;
+    float negativeScale = 0.0001f * EVSM_NEGATIVE_EXPONENT * negativeDepth;
+
+    float positiveLit = ChebyshevUpperBound(moments.xy, positiveDepth, positiveScale * positiveScale);
+    float negativeLit = ChebyshevUpperBound(moments.zw, negativeDepth, negativeScale * negativeScale);
+    return 1.0f - min(positiveLit, negativeLit);
+}
+
+float SampleShadow(vec4 lightMatrixPos)
+{
+    vec3 projectedCoord = lightMatrixPos.xyz / lightMatrixPos.w;
+    projectedCoord = projectedCoord * 0.5f + 0.5f;
+
+    if(projectedCoord.z > 1.0f)
+        return 0.0f;
+
+    if(shadowFilterMode == SHADOW_FILTER_HARDWARE_PCF)
+        return SampleShadowHardwarePCF(projectedCoord);
+    else if(shadowFilterMode == SHADOW_FILTER_VSM)
+        return SampleShadowVSM(projectedCoord);
+    else if(shadowFilterMode == SHADOW_FILTER_EVSM)
+        return SampleShadowEVSM(projectedCoord);
+
+    return SampleShadowPCF(projectedCoord);
+}
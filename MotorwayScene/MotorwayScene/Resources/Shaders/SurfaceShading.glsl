@@ -0,0 +1,44 @@
+// Shading for the screen space passes, which fetch the surface themselves rather than having it interpolated.
+// This matches the forward object shader, ShadowSampling.glsl and PointLighting.glsl must be included before it.
+
+struct DirectionalLight
+{
+    vec3 direction;
+    vec3 ambient, diffuse, specular;
+};
+
+uniform mat4 lightMatrixVP;
+uniform vec3 skyColor;
+uniform float fogDensity;
+uniform vec3 cameraPos;
+uniform DirectionalLight dirLight;
+
+/*
+    ShadeSurface() : Lights the surface with the directional light (and its shadows) and the point lights, then adds fog.
+    [windowCoord] - The pixel's window position and depth
+    [ambientColor] - The color the ambient light picks up, usually the albedo
+*/
+vec3 ShadeSurface(vec3 windowCoord, vec3 fragmentPos, vec3 normalDir, vec3 ambientColor, vec3 albedo, vec3 specular,
+    float shininess)
+{
+    vec3 cameraDir = normalize(cameraPos - fragmentPos);
+    vec3 lightRay = normalize(-dirLight.direction);
+
+    float diffuseStrength = max(dot(lightRay, normalDir), 0.0f);
+    vec3 diffuseColor = diffuseStrength * dirLight.diffuse * albedo;
+
+    vec3 halfwayDir = normalize(cameraDir + lightRay);
+    float specularStrength = pow(max(dot(halfwayDir, normalDir), 0.0f), shininess);
+    vec3 specularColor = specularStrength * dirLight.specular * specular;
+
+    vec3 pointLightColor = CalculatePointLights(windowCoord, fragmentPos, normalDir, cameraDir, albedo, specular, shininess);
+
+    float shadow = SampleShadow(lightMatrixVP * vec4(fragmentPos, 1.0f));
+    vec3 finalBlinnColor = dirLight.ambient * ambientColor + (1.0f - shadow) * (diffuseColor + specularColor) + 
+        pointLightColor;
+
+    // Same fog as the forward path
+    float fragDistance = length(fragmentPos - cameraPos);
+    float visibility = clamp(exp(-pow(fragDistance * fogDensity, 2.5f)), 0.0f, 1.0f);
+    return clamp(mix(skyColor, finalBlinnColor, visibility), 0.0f, 1.0f);
+}
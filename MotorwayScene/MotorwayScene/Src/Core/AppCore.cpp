@@ -1,13 +1,50 @@
 #include "AppCore.h"
+#include "Scripts/Scalability.h"
+#include "Graphics/RenderStats.h"
+#include "Graphics/GLCapture.h"
+#include "Graphics/GLDebug.h"
+#include "Graphics/GpuMemory.h"
+#include "Utils/AllocationTracker.h"
+#include "Utils/FrameArena.h"
+#include "Utils/Profiler.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 
-AppCore::AppCore() :
-	m_window(Core::GenerateWindow("OpenGLScene 3D", 1600, 900))
+AppCore::AppCore(const LaunchOptions& options) :
+	m_window(Core::GenerateWindow("OpenGLScene 3D", Scalability::GetPtr()->GetSettings().m_renderWidth, 
+		Scalability::GetPtr()->GetSettings().m_renderHeight, options.m_headless, options.m_glDebug)), m_options(options)
 {
+	Profiler::GetPtr()->SetThreadName("Main");
+
+	// Set up ahead of the GL trace, which would otherwise record enabling the debug output
+	if (m_options.m_glDebug)
+		GLDebug::Initialize(m_window);
+
+	// The GL trace has to go in before anything else swaps the entry points, and before anything is loaded
+	if (m_options.m_glCaptureFrames > 0)
+	{
+		GLCapture::BeginCapture("gl_capture.trace", m_options.m_glCaptureFrames, m_window->GetWidth(), 
+			m_window->GetHeight());
+	}
+
+	// Started before the scripts are set up, so the capture covers the loading as well as the first frames
+	if (m_options.m_captureFrames > 0)
+		Profiler::GetPtr()->BeginCapture(m_options.m_captureFrames, "profile_capture.json");
+
+	if (m_options.m_gpuBudgetMegabytes > 0)
+		GpuMemory::SetBudget((size_t)m_options.m_gpuBudgetMegabytes * 1024 * 1024);
+
 	this->SetupScripts();
+	GLCapture::EndLoad();
+	GpuMemory::CheckBudget();
+
+	// The loading is left out, the warm-up starts from the first frame
+	AllocationTracker::EndFrame();
+	if (m_options.m_zeroAllocWarmupFrames > 0)
+		AllocationTracker::EnforceZeroAllocations(m_options.m_zeroAllocWarmupFrames);
+
 	this->MainLoop();
 }
 
@@ -15,8 +52,13 @@ AppCore::~AppCore() {}
 
 void AppCore::SetupScripts()
 {
+	PROFILE_ZONE("AppCore::SetupScripts");
+
 	m_playerUser.InitScript(m_window, 1.5f);
-	m_worldScene.InitScript(m_playerUser);
+	m_worldScene.InitScript(m_window, m_playerUser);
+
+	if (m_options.m_benchmark)
+		m_benchmark.InitScript(m_window, m_playerUser, m_worldScene, m_options.m_benchmarkOutput);
 }
 
 void AppCore::MainLoop()
@@ -24,24 +66,43 @@ void AppCore::MainLoop()
 	float prevTime = 0.0f;
 	while (!m_window->WasRequestedClose())
 	{
-		// Calculate the delta time
-		const float currentTime = (float)glfwGetTime();
-		const float deltaTime = currentTime - prevTime;
-		prevTime = currentTime;
+		{
+			PROFILE_ZONE("AppCore::MainLoop");
+
+			// Calculate the delta time
+			const float currentTime = (float)m_window->GetTime();
+			const float deltaTime = currentTime - prevTime;
+			prevTime = currentTime;
 
-		this->UpdateTick(deltaTime);
-		this->Render();
+			this->UpdateTick(deltaTime);
+			this->Render();
+		}
+
+		// The frame's zone is closed first, otherwise the last frame of a capture would be left out of it
+		Profiler::GetPtr()->EndFrame();
+		FrameArena::GetPtr()->EndFrame();
+		GpuMemory::CheckBudget();
+		AllocationTracker::EndFrame();
+		RenderStats::EndFrame();
+		GLCapture::EndFrame();
 	}
 }
 
 void AppCore::UpdateTick(const float& deltaTime)
 {
+	PROFILE_ZONE("AppCore::UpdateTick");
+
 	if (m_window->WasKeyPressed(GLFW_KEY_ESCAPE))
 		m_window->RequestClose();
 
 	m_window->UpdateTick();
 
-	m_playerUser.UpdateTick(deltaTime);
+	// The benchmark moves the camera itself, so the player's input is ignored while it runs
+	if (m_options.m_benchmark)
+		m_benchmark.UpdateTick(deltaTime);
+	else
+		m_playerUser.UpdateTick(deltaTime);
+
 	m_worldScene.UpdateTick(deltaTime);
 }
 
@@ -2,17 +2,33 @@
 #include "Core/WindowFrame.h"
 #include "Scripts/Player.h"
 #include "Scripts/WorldScene.h"
+#include "Scripts/Benchmark.h"
 
 #include <memory>
+#include <string>
+
+struct LaunchOptions
+{
+	bool m_headless; // Renders offscreen through EGL instead of opening a window
+	bool m_benchmark; // Flies the camera along the benchmark path instead of taking the player's input
+	std::string m_benchmarkOutput;
+	uint32_t m_captureFrames; // The frames profiled from startup, none if this is zero
+	uint32_t m_glCaptureFrames; // The frames whose GL calls are recorded after the loading, none if this is zero
+	bool m_glDebug; // Makes a debug context and logs the driver's KHR_debug messages
+	uint32_t m_zeroAllocWarmupFrames; // Frames after this many that allocate are reported, nothing's checked if it's zero
+	uint32_t m_gpuBudgetMegabytes; // Going over this much GPU memory is logged, there's no budget if it's zero
+};
 
 class AppCore
 {
 private:
 	const std::shared_ptr<WindowFrame> m_window;
+	const LaunchOptions m_options;
 
 	// Scripts
 	Player m_playerUser;
 	WorldScene m_worldScene;
+	Benchmark m_benchmark;
 private:
 	void SetupScripts();
 
@@ -20,6 +36,6 @@ private:
 	void UpdateTick(const float& deltaTime);
 	void Render() const;
 public:
-	AppCore();
+	AppCore(const LaunchOptions& options);
 	~AppCore();
 };
\ No newline at end of file
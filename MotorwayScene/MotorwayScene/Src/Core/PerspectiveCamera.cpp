@@ -17,7 +17,7 @@ namespace
 	bool cursorFocused = false;
 }
 
-void UpdateCameraRotation(GLFWwindow* window, double xPos, double yPos)
+void UpdateCameraRotation(GLFWwindow*, double xPos, double yPos)
 {
 	if (!cursorFocused)
 	{
@@ -52,12 +52,16 @@ void UpdateCameraRotation(GLFWwindow* window, double xPos, double yPos)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-PerspectiveCamera::PerspectiveCamera() {}
+PerspectiveCamera::PerspectiveCamera() :
+	m_jitter(0.0f)
+{}
 
 PerspectiveCamera::PerspectiveCamera(std::shared_ptr<WindowFrame> window, const glm::vec3& pos, float fov) :
-	CameraObject(window, pos, fov)
+	CameraObject(window, pos, fov), m_jitter(0.0f)
 {
-	glfwSetCursorPosCallback(window->GetPtr(), UpdateCameraRotation);
+	// There's no mouse when headless, the camera is only moved by whatever drives it
+	if (!window->IsHeadless())
+		glfwSetCursorPosCallback(window->GetPtr(), UpdateCameraRotation);
 }
 
 PerspectiveCamera::~PerspectiveCamera() {}
@@ -66,8 +70,33 @@ void PerspectiveCamera::UpdateTick()
 {
 	// Generate the view and projection matrices
 	m_view = glm::lookAt(m_position, m_position + front, up);
-	m_projection = glm::perspective(glm::radians(m_FOV), (float)m_window->GetWidth() / (float)m_window->GetHeight(),
-		0.1f, 1000.0f);
+	m_unjitteredProjection = glm::perspective(glm::radians(m_FOV), (float)m_window->GetWidth() / 
+		(float)m_window->GetHeight(), 0.1f, 1000.0f);
+
+	this->ApplyJitter();
+}
+
+void PerspectiveCamera::SetJitter(const glm::vec2& ndcOffset)
+{
+	m_jitter = ndcOffset;
+	this->ApplyJitter();
+}
+
+void PerspectiveCamera::SetFrontDir(const glm::vec3& direction)
+{
+	front = glm::normalize(direction);
+
+	// The euler angles are kept in step, so the mouse carries on from where the camera was left pointing
+	pitch = glm::degrees(asin(front.y));
+	yaw = glm::degrees(atan2(front.z, front.x));
+}
+
+void PerspectiveCamera::ApplyJitter()
+{
+	// The clip space w is -z, so the offsets are subtracted for the image to move by +jitter after the divide
+	m_projection = m_unjitteredProjection;
+	m_projection[2][0] -= m_jitter.x;
+	m_projection[2][1] -= m_jitter.y;
 }
 
 const glm::vec3& PerspectiveCamera::GetFrontDir() const
@@ -85,6 +114,16 @@ const float& PerspectiveCamera::GetEulerYaw() const
 	return yaw;
 }
 
+glm::mat4 PerspectiveCamera::GetUnjitteredMatrix() const
+{
+	return m_unjitteredProjection * m_view;
+}
+
+const glm::mat4& PerspectiveCamera::GetUnjitteredProjection() const
+{
+	return m_unjitteredProjection;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 namespace Camera
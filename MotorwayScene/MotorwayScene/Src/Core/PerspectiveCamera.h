@@ -5,16 +5,31 @@ class WindowFrame;
 
 class PerspectiveCamera : public CameraObject
 {
+private:
+	glm::mat4 m_unjitteredProjection;
+	glm::vec2 m_jitter;
+private:
+	void ApplyJitter();
 public:
 	PerspectiveCamera();
 	PerspectiveCamera(std::shared_ptr<WindowFrame> window, const glm::vec3& pos, float fov);
 	~PerspectiveCamera();
 
 	void UpdateTick() override;
+
+	// Offsets the projection by the given amount in NDC, used by the temporal anti-aliasing to sample inside each pixel
+	void SetJitter(const glm::vec2& ndcOffset);
+
+	// Points the camera along the direction given, for when it's driven by something other than the mouse
+	void SetFrontDir(const glm::vec3& direction);
 public:
 	const glm::vec3& GetFrontDir() const;
 	const float& GetEulerPitch() const;
 	const float& GetEulerYaw() const;
+
+	// For things that shouldn't move with the jitter, e.g. reprojecting into last frame or building the light clusters
+	glm::mat4 GetUnjitteredMatrix() const;
+	const glm::mat4& GetUnjitteredProjection() const;
 };
 
 namespace Camera
@@ -1,12 +1,40 @@
 #include "WindowFrame.h"
 #include "Utils/LoggingManager.h"
+#include "Utils/Profiler.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <cstdio>
+#include <cstdlib>
 
-WindowFrame::WindowFrame(const char* title, uint32_t width, uint32_t height) :
-	m_width(width), m_height(height)
+#ifdef HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace
+{
+	// Headless runs are unattended and a FATAL log only stops debug builds, so rather than carry on into GL calls
+	// without a context they say why on stderr and exit
+	void ExitHeadless(const char* reason)
+	{
+		std::fprintf(stderr, "%s\n", reason);
+		std::exit(EXIT_FAILURE);
+	}
+}
+
+WindowFrame::WindowFrame(const char* title, uint32_t width, uint32_t height, bool headless, bool debugContext) :
+	m_window(nullptr), m_width(width), m_height(height), m_headless(headless), m_debugContext(debugContext), 
+	m_closeRequested(false), 
+	m_eglDisplay(nullptr), m_eglContext(nullptr), m_eglSurface(nullptr), m_startTime(std::chrono::steady_clock::now())
 {
+	if (m_headless)
+	{
+		this->InitEGL();
+		glEnable(GL_DEPTH_TEST);
+		return;
+	}
+
 	this->InitGLFW();
 
 	m_window = glfwCreateWindow(width, height, title, nullptr, nullptr);
@@ -33,7 +61,18 @@ WindowFrame::WindowFrame(const char* title, uint32_t width, uint32_t height) :
 
 WindowFrame::~WindowFrame()
 {
-	glfwTerminate();
+	if (!m_headless)
+	{
+		glfwTerminate();
+		return;
+	}
+
+#ifdef HEADLESS_EGL
+	eglMakeCurrent((EGLDisplay)m_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroySurface((EGLDisplay)m_eglDisplay, (EGLSurface)m_eglSurface);
+	eglDestroyContext((EGLDisplay)m_eglDisplay, (EGLContext)m_eglContext);
+	eglTerminate((EGLDisplay)m_eglDisplay);
+#endif
 }
 
 void WindowFrame::InitGLFW() const
@@ -45,15 +84,95 @@ void WindowFrame::InitGLFW() const
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_RESIZABLE, false);
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, m_debugContext);
+}
+
+void WindowFrame::InitEGL()
+{
+#ifdef HEADLESS_EGL
+	// The surfaceless platform doesn't need a display server at all, the default display is only a fallback
+	EGLDisplay display = EGL_NO_DISPLAY;
+	auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+		ExitHeadless("Failed to initialize EGL!");
+
+	const EGLint configAttribs[] =
+	{
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+		EGL_NONE
+	};
+
+	EGLConfig config = nullptr;
+	EGLint numConfigs = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0)
+		ExitHeadless("Failed to find an EGL config for the headless surface!");
+
+	// The pbuffer stands in for the window's default framebuffer, so the final pass works the same either way
+	const EGLint surfaceAttribs[] = { EGL_WIDTH, (EGLint)m_width, EGL_HEIGHT, (EGLint)m_height, EGL_NONE };
+	EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+	if (surface == EGL_NO_SURFACE)
+		ExitHeadless("Failed to create the headless surface!");
+
+	eglBindAPI(EGL_OPENGL_API);
+	const EGLint contextAttribs[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_CONTEXT_FLAGS_KHR, m_debugContext ? EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR : 0,
+		EGL_NONE
+	};
+
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context))
+		ExitHeadless("Failed to create the headless OpenGL 3.3 context!");
+
+	m_eglDisplay = display;
+	m_eglContext = context;
+	m_eglSurface = surface;
+
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+		ExitHeadless("Failed to initialize GLAD!");
+#else
+	ExitHeadless("Headless rendering needs the Headless build, which defines HEADLESS_EGL and links libEGL!");
+#endif
 }
 
 void WindowFrame::RequestClose() const
 {
-	glfwSetWindowShouldClose(m_window, true);
+	if (m_headless)
+		m_closeRequested = true;
+	else
+		glfwSetWindowShouldClose(m_window, true);
+}
+
+void WindowFrame::SetVSync(bool enabled) const
+{
+	// A pbuffer is never presented, so there's nothing to wait on when headless
+	if (!m_headless)
+		glfwSwapInterval(enabled ? 1 : 0);
 }
 
 void WindowFrame::UpdateTick() const
 {
+	PROFILE_ZONE("WindowFrame::UpdateTick");
+
+	if (m_headless)
+	{
+		// Nothing is presented, but this keeps a frame's commands from piling up behind the next one
+		glFlush();
+		return;
+	}
+
 	glfwPollEvents();
 	glfwSwapBuffers(m_window);
 }
@@ -73,13 +192,41 @@ const uint32_t& WindowFrame::GetHeight() const
 	return m_height;
 }
 
+const bool& WindowFrame::IsHeadless() const
+{
+	return m_headless;
+}
+
+void* WindowFrame::GetProcAddress(const char* name) const
+{
+	if (!m_headless)
+		return (void*)glfwGetProcAddress(name);
+
+#ifdef HEADLESS_EGL
+	return (void*)eglGetProcAddress(name);
+#else
+	return nullptr;
+#endif
+}
+
+double WindowFrame::GetTime() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
 bool WindowFrame::WasRequestedClose() const
 {
+	if (m_headless)
+		return m_closeRequested;
+
 	return glfwWindowShouldClose(m_window);
 }
 
 bool WindowFrame::WasKeyPressed(int key) const
 {
+	if (m_headless)
+		return false;
+
 	return glfwGetKey(m_window, key) == GLFW_PRESS;
 }
 
@@ -87,8 +234,9 @@ bool WindowFrame::WasKeyPressed(int key) const
 
 namespace Core
 {
-	std::shared_ptr<WindowFrame> GenerateWindow(const char* title, uint32_t width, uint32_t height)
+	std::shared_ptr<WindowFrame> GenerateWindow(const char* title, uint32_t width, uint32_t height, bool headless,
+		bool debugContext)
 	{
-		return std::make_shared<WindowFrame>(title, width, height);
+		return std::make_shared<WindowFrame>(title, width, height, headless, debugContext);
 	}
 }
\ No newline at end of file
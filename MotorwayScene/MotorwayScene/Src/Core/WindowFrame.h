@@ -1,26 +1,45 @@
 #pragma once
 #include <memory>
+#include <chrono>
 
 struct GLFWwindow;
 typedef unsigned int uint32_t;
 
+/*
+	WindowFrame : Either a GLFW window, or when headless an offscreen EGL pbuffer the same size as the window would be.
+	The headless backend needs no display server (e.g. Mesa's surfaceless platform with llvmpipe), it has no input so no
+	key ever reads as pressed, and it's only available in builds with HEADLESS_EGL defined which link against libEGL.
+*/
 class WindowFrame
 {
 private:
-	GLFWwindow* m_window;
+	GLFWwindow* m_window; // Null when headless
 	uint32_t m_width, m_height;
+
+	bool m_headless, m_debugContext;
+	mutable bool m_closeRequested;
+	void* m_eglDisplay, *m_eglContext, *m_eglSurface;
+	std::chrono::steady_clock::time_point m_startTime;
 private:
 	void InitGLFW() const;
+	void InitEGL();
 public:
-	WindowFrame(const char* title, uint32_t width, uint32_t height);
+	WindowFrame(const char* title, uint32_t width, uint32_t height, bool headless = false, bool debugContext = false);
 	~WindowFrame();
 
 	void RequestClose() const;
+	void SetVSync(bool enabled) const;
 	void UpdateTick() const;
 public:
 	GLFWwindow* GetPtr() const;
 	const uint32_t& GetWidth() const;
 	const uint32_t& GetHeight() const;
+	const bool& IsHeadless() const;
+
+	// Looks up an entry point glad wasn't generated with (e.g. an extension's), through GLFW or EGL depending on the backend
+	void* GetProcAddress(const char* name) const;
+
+	double GetTime() const; // Seconds since the window was made, which replaces glfwGetTime() as that needs GLFW running
 
 	bool WasRequestedClose() const;
 	bool WasKeyPressed(int key) const;
@@ -28,5 +47,6 @@ public:
 
 namespace Core
 {
-	std::shared_ptr<WindowFrame> GenerateWindow(const char* title, uint32_t width, uint32_t height);
+	std::shared_ptr<WindowFrame> GenerateWindow(const char* title, uint32_t width, uint32_t height, bool headless = false,
+		bool debugContext = false);
 }
\ No newline at end of file
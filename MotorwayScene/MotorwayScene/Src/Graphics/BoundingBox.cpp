@@ -0,0 +1,68 @@
+#include "BoundingBox.h"
+
+namespace Bounds
+{
+	BoundingBox Merge(const BoundingBox& first, const BoundingBox& second)
+	{
+		return { glm::min(first.m_min, second.m_min), glm::max(first.m_max, second.m_max) };
+	}
+
+	BoundingBox Transform(const BoundingBox& box, const glm::mat4& transform)
+	{
+		const auto corners = GetCorners(box, transform);
+
+		BoundingBox transformedBox = { corners[0], corners[0] };
+		for (const auto& corner : corners)
+		{
+			transformedBox.m_min = glm::min(transformedBox.m_min, corner);
+			transformedBox.m_max = glm::max(transformedBox.m_max, corner);
+		}
+
+		return transformedBox;
+	}
+
+	std::array<glm::vec3, 8> GetCorners(const BoundingBox& box, const glm::mat4& transform)
+	{
+		std::array<glm::vec3, 8> corners;
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			const glm::vec3 corner = { (i & 1) ? box.m_max.x : box.m_min.x, (i & 2) ? box.m_max.y : box.m_min.y,
+				(i & 4) ? box.m_max.z : box.m_min.z };
+
+			corners[i] = glm::vec3(transform * glm::vec4(corner, 1.0f));
+		}
+
+		return corners;
+	}
+
+	std::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4& vpMatrix)
+	{
+		const glm::mat4 matrix = glm::transpose(vpMatrix); // Makes the rows of the matrix easier to access
+		std::array<glm::vec4, 6> planes =
+		{
+			matrix[3] + matrix[0], matrix[3] - matrix[0], // Left and right planes
+			matrix[3] + matrix[1], matrix[3] - matrix[1], // Bottom and top planes
+			matrix[3] + matrix[2], matrix[3] - matrix[2]  // Near and far planes
+		};
+
+		for (auto& plane : planes)
+			plane /= glm::length(glm::vec3(plane));
+
+		return planes;
+	}
+
+	bool IsInsideFrustum(const BoundingBox& box, const std::array<glm::vec4, 6>& frustumPlanes)
+	{
+		for (const auto& plane : frustumPlanes)
+		{
+			// Only the box corner furthest along the plane normal needs to be checked
+			const glm::vec3 positiveCorner = { plane.x >= 0.0f ? box.m_max.x : box.m_min.x, 
+				plane.y >= 0.0f ? box.m_max.y : box.m_min.y, plane.z >= 0.0f ? box.m_max.z : box.m_min.z };
+
+			if (glm::dot(glm::vec3(plane), positiveCorner) + plane.w < 0.0f)
+				return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <array>
+
+struct BoundingBox
+{
+	glm::vec3 m_min, m_max;
+};
+
+namespace Bounds
+{
+	BoundingBox Merge(const BoundingBox& first, const BoundingBox& second);
+	BoundingBox Transform(const BoundingBox& box, const glm::mat4& transform); // Returns the AABB enclosing the transformed box
+	std::array<glm::vec3, 8> GetCorners(const BoundingBox& box, const glm::mat4& transform);
+
+	// The planes are stored as (normal, distance) with the normals pointing into the frustum
+	std::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4& vpMatrix);
+	bool IsInsideFrustum(const BoundingBox& box, const std::array<glm::vec4, 6>& frustumPlanes);
+}
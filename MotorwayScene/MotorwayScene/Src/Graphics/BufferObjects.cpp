@@ -1,21 +1,25 @@
 #include "BufferObjects.h"
 #include "Utils/LoggingManager.h"
 #include "Utils/ResourceManager.h"
+#include "GLDebug.h"
+#include <algorithm>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 
-VertexBuffer::VertexBuffer(const void* data, GLsizeiptr size, GLenum usage)
+VertexBuffer::VertexBuffer(const void* data, GLsizeiptr size, GLenum usage, GpuMemoryCategory category)
 {
 	glGenBuffers(1, &m_ID);
 	glBindBuffer(GL_ARRAY_BUFFER, m_ID);
 	glBufferData(GL_ARRAY_BUFFER, size, data, usage);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GpuMemory::Register(this, category, (size_t)size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	glDeleteBuffers(1, &m_ID);
+	GpuMemory::Unregister(this);
 }
 
 void VertexBuffer::ModifySubData(const void* data, GLintptr offset, GLsizeiptr size)
@@ -25,6 +29,15 @@ void VertexBuffer::ModifySubData(const void* data, GLintptr offset, GLsizeiptr s
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void VertexBuffer::ReallocateData(const void* data, GLsizeiptr size, GLenum usage)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, m_ID);
+	glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	GpuMemory::Resize(this, (size_t)size);
+}
+
 void VertexBuffer::BindBuffer() const
 {
 	glBindBuffer(GL_ARRAY_BUFFER, m_ID);
@@ -35,6 +48,12 @@ void VertexBuffer::UnbindBuffer() const
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void VertexBuffer::SetLabel(const std::string& label) const
+{
+	GpuMemory::SetLabel(this, label);
+	GLDebug::LabelObject(GLDebug::ObjectType::BUFFER, m_ID, label);
+}
+
 const uint32_t& VertexBuffer::GetID() const
 {
 	return m_ID;
@@ -49,11 +68,13 @@ IndexBuffer::IndexBuffer(const void* data, GLsizeiptr size, GLenum usage)
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GpuMemory::Register(this, GpuMemoryCategory::GEOMETRY, (size_t)size);
 }
 
 IndexBuffer::~IndexBuffer()
 {
 	glDeleteBuffers(1, &m_ID);
+	GpuMemory::Unregister(this);
 }
 
 void IndexBuffer::ModifySubData(const void* data, GLintptr offset, GLsizeiptr size)
@@ -63,6 +84,15 @@ void IndexBuffer::ModifySubData(const void* data, GLintptr offset, GLsizeiptr si
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+void IndexBuffer::ReallocateData(const void* data, GLsizeiptr size, GLenum usage)
+{
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	GpuMemory::Resize(this, (size_t)size);
+}
+
 void IndexBuffer::BindBuffer() const
 {
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
@@ -73,6 +103,12 @@ void IndexBuffer::UnbindBuffer() const
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+void IndexBuffer::SetLabel(const std::string& label) const
+{
+	GpuMemory::SetLabel(this, label);
+	GLDebug::LabelObject(GLDebug::ObjectType::BUFFER, m_ID, label);
+}
+
 const uint32_t& IndexBuffer::GetID() const
 {
 	return m_ID;
@@ -91,11 +127,14 @@ RenderBuffer::RenderBuffer(uint32_t width, uint32_t height, GLenum format, bool
 		glRenderbufferStorage(GL_RENDERBUFFER, format, width, height);
 
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	GpuMemory::Register(this, GpuMemoryCategory::RENDER_TARGET, GpuMemory::GetTextureBytes(width, height, format) * 
+		(multisample ? std::max(samples, 1) : 1));
 }
 
 RenderBuffer::~RenderBuffer()
 {
 	glDeleteRenderbuffers(1, &m_ID);
+	GpuMemory::Unregister(this);
 }
 
 void RenderBuffer::BindBuffer() const
@@ -108,6 +147,12 @@ void RenderBuffer::UnbindBuffer() const
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 }
 
+void RenderBuffer::SetLabel(const std::string& label) const
+{
+	GpuMemory::SetLabel(this, label);
+	GLDebug::LabelObject(GLDebug::ObjectType::RENDERBUFFER, m_ID, label);
+}
+
 const uint32_t& RenderBuffer::GetID() const
 {
 	return m_ID;
@@ -154,11 +199,17 @@ TextureBuffer::TextureBuffer(uint32_t width, uint32_t height, GLenum internalFor
 	}
 
 	glBindTexture(m_target, 0);
+
+	// Counted as a texture until it's attached to a framebuffer, which makes it a render target
+	m_bytes = GpuMemory::GetTextureBytes(width, height, internalFormat) * (cubemap ? 6 : 1) * 
+		(multisample ? std::max(samples, 1) : 1);
+	GpuMemory::Register(this, GpuMemoryCategory::TEXTURE, m_bytes);
 }
 
 TextureBuffer::~TextureBuffer()
 {
 	glDeleteTextures(1, &m_ID);
+	GpuMemory::Unregister(this);
 }
 
 void TextureBuffer::SetWrapping(GLenum wrapX, GLenum wrapY, GLenum wrapZ) const
@@ -196,6 +247,24 @@ void TextureBuffer::SetBorderColor(const glm::vec4& color) const
 	glBindTexture(m_target, 0);
 }
 
+void TextureBuffer::SetCompareMode(GLenum mode, GLenum func) const
+{
+	glBindTexture(m_target, m_ID);
+	glTexParameteri(m_target, GL_TEXTURE_COMPARE_MODE, mode);
+	glTexParameteri(m_target, GL_TEXTURE_COMPARE_FUNC, func);
+	glBindTexture(m_target, 0);
+}
+
+void TextureBuffer::GenerateMipmaps() const
+{
+	glBindTexture(m_target, m_ID);
+	glGenerateMipmap(m_target);
+	glBindTexture(m_target, 0);
+
+	// The rest of the chain adds up to a third of the base level
+	GpuMemory::Resize(this, m_bytes + (m_bytes / 3));
+}
+
 void TextureBuffer::BindBuffer(const std::string& samplerName, uint32_t samplerUnit) const
 {
 	ShaderManager::GetPtr()->GetBoundShader()->SetUniform(samplerName, (int)samplerUnit);
@@ -209,6 +278,12 @@ void TextureBuffer::UnbindBuffer() const
 	glBindTexture(m_target, 0);
 }
 
+void TextureBuffer::SetLabel(const std::string& label) const
+{
+	GpuMemory::SetLabel(this, label);
+	GLDebug::LabelObject(GLDebug::ObjectType::TEXTURE, m_ID, label);
+}
+
 const uint32_t& TextureBuffer::GetID() const
 {
 	return m_ID;
@@ -221,6 +296,93 @@ const GLenum& TextureBuffer::GetTarget() const
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 
+BufferTexture::BufferTexture(GLenum internalFormat) :
+	m_internalFormat(internalFormat), m_ownsBuffer(true)
+{
+	glGenBuffers(1, &m_bufferID);
+	glGenTextures(1, &m_textureID);
+
+	GpuMemory::Register(this, GpuMemoryCategory::INSTANCE, 0);
+}
+
+BufferTexture::~BufferTexture()
+{
+	glDeleteTextures(1, &m_textureID);
+
+	if (m_ownsBuffer)
+		glDeleteBuffers(1, &m_bufferID);
+
+	GpuMemory::Unregister(this);
+}
+
+void BufferTexture::ReallocateData(const void* data, GLsizeiptr size)
+{
+	glBindBuffer(GL_TEXTURE_BUFFER, m_bufferID);
+	glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	glBindTexture(GL_TEXTURE_BUFFER, m_textureID);
+	glTexBuffer(GL_TEXTURE_BUFFER, m_internalFormat, m_bufferID);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	GpuMemory::Resize(this, (size_t)size);
+}
+
+void BufferTexture::AttachBuffer(uint32_t bufferID)
+{
+	// The other buffer's storage is already counted by whatever owns it
+	if (m_ownsBuffer)
+	{
+		glDeleteBuffers(1, &m_bufferID);
+		GpuMemory::Resize(this, 0);
+		m_ownsBuffer = false;
+	}
+
+	m_bufferID = bufferID;
+	glBindTexture(GL_TEXTURE_BUFFER, m_textureID);
+	glTexBuffer(GL_TEXTURE_BUFFER, m_internalFormat, m_bufferID);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void BufferTexture::BindBuffer(const std::string& samplerName, uint32_t samplerUnit) const
+{
+	ShaderManager::GetPtr()->GetBoundShader()->SetUniform(samplerName, (int)samplerUnit);
+
+	glActiveTexture(GL_TEXTURE0 + samplerUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, m_textureID);
+}
+
+void BufferTexture::UnbindBuffer() const
+{
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void BufferTexture::SetLabel(const std::string& label) const
+{
+	GpuMemory::SetLabel(this, label);
+	if (!GLDebug::IsEnabled())
+		return;
+
+	// The names only become objects once they're bound, which hasn't happened if no data has been given yet
+	glBindTexture(GL_TEXTURE_BUFFER, m_textureID);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	GLDebug::LabelObject(GLDebug::ObjectType::TEXTURE, m_textureID, label);
+
+	if (m_ownsBuffer)
+	{
+		glBindBuffer(GL_TEXTURE_BUFFER, m_bufferID);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		GLDebug::LabelObject(GLDebug::ObjectType::BUFFER, m_bufferID, label);
+	}
+}
+
+const uint32_t& BufferTexture::GetID() const
+{
+	return m_textureID;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
 FrameBuffer::FrameBuffer(bool noColorAttachments) :
 	m_noColorAttachments(noColorAttachments)
 {
@@ -250,8 +412,17 @@ void FrameBuffer::AttachTextureBuffer(const std::string& key, std::shared_ptr<Te
 		glDrawBuffer(GL_NONE);
 		glReadBuffer(GL_NONE);
 	}
+	else if (attachmentType >= GL_COLOR_ATTACHMENT0 && attachmentType <= GL_COLOR_ATTACHMENT15)
+	{
+		if (std::find(m_colorAttachments.begin(), m_colorAttachments.end(), attachmentType) == m_colorAttachments.end())
+			m_colorAttachments.push_back(attachmentType);
+
+		glDrawBuffers((GLsizei)m_colorAttachments.size(), m_colorAttachments.data());
+	}
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GpuMemory::SetCategory(colorAttachment.get(), GpuMemoryCategory::RENDER_TARGET);
+
 	m_TBOAttachments[key] = colorAttachment;
 }
 
@@ -278,6 +449,17 @@ void FrameBuffer::UnbindBuffer() const
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void FrameBuffer::SetLabel(const std::string& label) const
+{
+	if (!GLDebug::IsEnabled())
+		return;
+
+	// The name only becomes an object once it's bound, which hasn't happened if nothing has been attached yet
+	glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLDebug::LabelObject(GLDebug::ObjectType::FRAMEBUFFER, m_ID, label);
+}
+
 const uint32_t& FrameBuffer::GetID() const
 {
 	return m_ID;
@@ -297,9 +479,9 @@ std::shared_ptr<RenderBuffer> FrameBuffer::GetRenderBuffer() const
 
 namespace Buffer
 {
-	std::shared_ptr<VertexBuffer> GenerateVBO(const void* data, GLsizeiptr size, GLenum usage)
+	std::shared_ptr<VertexBuffer> GenerateVBO(const void* data, GLsizeiptr size, GLenum usage, GpuMemoryCategory category)
 	{
-		return std::make_shared<VertexBuffer>(data, size, usage);
+		return std::make_shared<VertexBuffer>(data, size, usage, category);
 	}
 
 	std::shared_ptr<IndexBuffer> GenerateIBO(const void* data, GLsizeiptr size, GLenum usage)
@@ -318,6 +500,11 @@ namespace Buffer
 		return std::make_shared<RenderBuffer>(width, height, format, multisample, samples);
 	}
 
+	std::shared_ptr<BufferTexture> GenerateBufferTexture(GLenum internalFormat)
+	{
+		return std::make_shared<BufferTexture>(internalFormat);
+	}
+
 	std::shared_ptr<FrameBuffer> GenerateFBO(bool noColorAttachments)
 	{
 		return std::make_shared<FrameBuffer>(noColorAttachments);
@@ -1,6 +1,9 @@
 #pragma once
+#include "Graphics/GpuMemory.h"
+
 #include <glad/glad.h>
 #include <unordered_map>
+#include <vector>
 #include <glm/glm.hpp>
 #include <memory>
 
@@ -11,13 +14,16 @@ class VertexBuffer
 private:
 	uint32_t m_ID;
 public:
-	VertexBuffer(const void* data, GLsizeiptr size, GLenum usage);
+	VertexBuffer(const void* data, GLsizeiptr size, GLenum usage, GpuMemoryCategory category);
 	~VertexBuffer();
 
 	void ModifySubData(const void* data, GLintptr offset, GLsizeiptr size);
+	void ReallocateData(const void* data, GLsizeiptr size, GLenum usage); // Also orphans the previous storage
 
 	void BindBuffer() const;
 	void UnbindBuffer() const;
+
+	void SetLabel(const std::string& label) const; // Names the object in the driver's debug messages and in GL debuggers
 public:
 	const uint32_t& GetID() const;
 };
@@ -31,9 +37,12 @@ public:
 	~IndexBuffer();
 
 	void ModifySubData(const void* data, GLintptr offset, GLsizeiptr size);
+	void ReallocateData(const void* data, GLsizeiptr size, GLenum usage); // Also orphans the previous storage
 
 	void BindBuffer() const;
 	void UnbindBuffer() const;
+
+	void SetLabel(const std::string& label) const;
 public:
 	const uint32_t& GetID() const;
 };
@@ -48,6 +57,8 @@ public:
 
 	void BindBuffer() const;
 	void UnbindBuffer() const;
+
+	void SetLabel(const std::string& label) const;
 public:
 	const uint32_t& GetID() const;
 };
@@ -57,6 +68,7 @@ class TextureBuffer
 private:
 	uint32_t m_ID;
 	GLenum m_target;
+	size_t m_bytes; // The base level's storage, with every face and sample
 public:
 	TextureBuffer(uint32_t width, uint32_t height, GLenum internalFormat, GLenum format, GLenum type, bool cubemap, 
 		bool multisample, int samples);
@@ -65,19 +77,49 @@ public:
 	void SetWrapping(GLenum wrapX, GLenum wrapY, GLenum wrapZ = GL_REPEAT) const;
 	void SetFiltering(GLenum min, GLenum mag) const;
 	void SetBorderColor(const glm::vec4& color) const;
+	void SetCompareMode(GLenum mode, GLenum func = GL_LEQUAL) const; // For depth textures sampled with sampler2DShadow
+
+	void GenerateMipmaps() const;
 
 	void BindBuffer(const std::string& samplerName, uint32_t samplerUnit) const;
 	void UnbindBuffer() const;
+
+	void SetLabel(const std::string& label) const;
 public:
 	const uint32_t& GetID() const;
 	const GLenum& GetTarget() const;
 };
 
+// A buffer object read in shaders through a samplerBuffer, used for per frame arrays too big for plain uniforms
+class BufferTexture
+{
+private:
+	uint32_t m_bufferID, m_textureID;
+	GLenum m_internalFormat;
+	bool m_ownsBuffer;
+public:
+	BufferTexture(GLenum internalFormat);
+	~BufferTexture();
+
+	void ReallocateData(const void* data, GLsizeiptr size); // Also orphans the previous storage
+
+	// Reads from another buffer's storage instead (e.g. a vertex buffer), which is never deleted by the buffer texture
+	void AttachBuffer(uint32_t bufferID);
+
+	void BindBuffer(const std::string& samplerName, uint32_t samplerUnit) const;
+	void UnbindBuffer() const;
+
+	void SetLabel(const std::string& label) const;
+public:
+	const uint32_t& GetID() const;
+};
+
 class FrameBuffer
 {
 private:
 	uint32_t m_ID;
 	bool m_noColorAttachments;
+	std::vector<GLenum> m_colorAttachments; // Every attached color target is drawn to, so MRT passes just work
 
 	mutable std::unordered_map<std::string, std::shared_ptr<TextureBuffer>> m_TBOAttachments;
 	mutable std::shared_ptr<RenderBuffer> m_RBOAttachment;
@@ -90,6 +132,8 @@ public:
 
 	void BindBuffer() const;
 	void UnbindBuffer() const;
+
+	void SetLabel(const std::string& label) const;
 public:
 	const uint32_t& GetID() const;
 
@@ -99,12 +143,14 @@ public:
 
 namespace Buffer
 {
-	std::shared_ptr<VertexBuffer> GenerateVBO(const void* data, GLsizeiptr size, GLenum usage);
+	std::shared_ptr<VertexBuffer> GenerateVBO(const void* data, GLsizeiptr size, GLenum usage, 
+		GpuMemoryCategory category = GpuMemoryCategory::GEOMETRY);
 	std::shared_ptr<IndexBuffer> GenerateIBO(const void* data, GLsizeiptr size, GLenum usage);
 
 	std::shared_ptr<TextureBuffer> GenerateTBO(uint32_t width, uint32_t height, GLenum internalFormat, GLenum format, 
 		GLenum type = GL_UNSIGNED_BYTE, bool cubemap = false, bool multisample = false, int samples = 2);
 	std::shared_ptr<RenderBuffer> GenerateRBO(uint32_t width, uint32_t height, GLenum format, bool multisample = false,
 		int samples = 2);
+	std::shared_ptr<BufferTexture> GenerateBufferTexture(GLenum internalFormat);
 	std::shared_ptr<FrameBuffer> GenerateFBO(bool noColorAttachments = false);
 }
\ No newline at end of file
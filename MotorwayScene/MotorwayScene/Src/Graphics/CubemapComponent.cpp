@@ -1,6 +1,8 @@
 #include "CubemapComponent.h"
 #include "Utils/ResourceManager.h"
 #include "Utils/LoggingManager.h"
+#include "Graphics/GLDebug.h"
+#include "Graphics/GpuMemory.h"
 
 #include <glad/glad.h>
 #include <stb_image.h>
@@ -10,18 +12,25 @@ CubemapComponent::CubemapComponent(const std::array<std::string, 6>& paths)
 	glGenTextures(1, &m_ID);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
 
+	const std::string label = paths[0].substr(0, paths[0].find_last_of("/\\"));
+	GLDebug::LabelObject(GLDebug::ObjectType::TEXTURE, m_ID, label);
+
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
+	size_t totalBytes = 0;
 	for (uint32_t index = 0; index < 6; index++)
 	{
 		int width = 0, height = 0, channels = 0;
 		GLubyte* textureData = stbi_load(paths[index].c_str(), &width, &height, &channels, 0);
 		if (textureData)
 		{
+			// Both formats take 4 bytes a texel once the driver has padded the 24 bit one
+			totalBytes += GpuMemory::GetTextureBytes(width, height, GL_SRGB8_ALPHA8);
+
 			if (channels > 3)
 				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + index, 0, GL_SRGB_ALPHA, width, height, 0, GL_RGBA,
 					GL_UNSIGNED_BYTE, textureData);
@@ -36,11 +45,15 @@ CubemapComponent::CubemapComponent(const std::array<std::string, 6>& paths)
 	}
 
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+	GpuMemory::Register(this, GpuMemoryCategory::TEXTURE, totalBytes);
+	GpuMemory::SetLabel(this, label);
 }
 
 CubemapComponent::~CubemapComponent()
 {
 	glDeleteTextures(1, &m_ID);
+	GpuMemory::Unregister(this);
 }
 
 void CubemapComponent::BindCubemap(const std::string& samplerName, uint32_t samplerUnit) const
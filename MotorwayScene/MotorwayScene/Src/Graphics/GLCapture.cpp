@@ -0,0 +1,795 @@
+#include "GLCapture.h"
+#include "GLTrace.h"
+#include "Utils/LoggingManager.h"
+
+#include <glad/glad.h>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// Every entry point the app calls that changes the GL state or sends it data. The ones that only read state back
+// (glGet*, glIsEnabled, glCheckFramebufferStatus and the info logs) aren't recorded, since the replay has no use for
+// what they return. glGetUniformLocation is the exception, as the replay needs it to map the locations.
+#define GL_CAPTURE_ENTRY_POINTS(X) \
+	X(GenBuffers) X(GenTextures) X(GenFramebuffers) X(GenRenderbuffers) X(GenVertexArrays) X(GenQueries) \
+	X(DeleteBuffers) X(DeleteTextures) X(DeleteFramebuffers) X(DeleteRenderbuffers) X(DeleteVertexArrays) \
+	X(DeleteQueries) X(CreateShader) X(CreateProgram) X(DeleteShader) X(DeleteProgram) \
+	X(ShaderSource) X(CompileShader) X(AttachShader) X(LinkProgram) X(UseProgram) X(GetUniformLocation) \
+	X(Uniform1i) X(Uniform1f) X(Uniform2fv) X(Uniform3fv) X(UniformMatrix4fv) \
+	X(BindBuffer) X(BufferData) X(BufferSubData) X(BindVertexArray) X(EnableVertexAttribArray) \
+	X(VertexAttribPointer) X(VertexAttribDivisor) \
+	X(ActiveTexture) X(BindTexture) X(TexImage2D) X(TexSubImage2D) X(TexImage2DMultisample) X(TexParameteri) \
+	X(TexParameterfv) X(TexBuffer) X(GenerateMipmap) \
+	X(BindFramebuffer) X(BindRenderbuffer) X(RenderbufferStorage) X(RenderbufferStorageMultisample) \
+	X(FramebufferTexture) X(FramebufferTexture2D) X(FramebufferRenderbuffer) X(DrawBuffer) X(DrawBuffers) \
+	X(ReadBuffer) X(BlitFramebuffer) \
+	X(Enable) X(Disable) X(BlendFunc) X(DepthFunc) X(DepthMask) X(ColorMask) X(Viewport) X(Scissor) \
+	X(ClearColor) X(Clear) X(ClearBufferuiv) \
+	X(BeginQuery) X(EndQuery) X(QueryCounter) X(BeginConditionalRender) X(EndConditionalRender) \
+	X(DrawArrays) X(DrawElements) X(DrawElementsInstanced) X(Flush)
+
+using GLTrace::Command;
+
+namespace
+{
+	// The records are gathered in memory and written out in large blocks, so the frames aren't held up by the file
+	constexpr size_t FLUSH_THRESHOLD = 16 * 1024 * 1024;
+
+	std::ofstream traceFile;
+	std::vector<uint8_t> pendingBytes;
+	std::string tracePath;
+	uint32_t numFramesLeft = 0;
+	bool capturing = false, framesStarted = false;
+
+#define DECLARE_REAL_ENTRY_POINT(name) decltype(glad_gl##name) real##name = nullptr;
+	GL_CAPTURE_ENTRY_POINTS(DECLARE_REAL_ENTRY_POINT)
+#undef DECLARE_REAL_ENTRY_POINT
+
+	template<typename T>
+	void Write(const T& value)
+	{
+		const uint8_t* bytes = (const uint8_t*)&value;
+		pendingBytes.insert(pendingBytes.end(), bytes, bytes + sizeof(T));
+	}
+
+	void WriteArguments() {}
+
+	template<typename T, typename... Rest>
+	void WriteArguments(const T& first, const Rest&... rest)
+	{
+		Write(first);
+		WriteArguments(rest...);
+	}
+
+	template<typename... Arguments>
+	void Record(Command command, const Arguments&... arguments)
+	{
+		Write(command);
+		WriteArguments(arguments...);
+	}
+
+	void WritePayload(const void* data, size_t size)
+	{
+		Write((uint32_t)size);
+		if (size > 0)
+			pendingBytes.insert(pendingBytes.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+	}
+
+	void FlushPending()
+	{
+		traceFile.write((const char*)pendingBytes.data(), pendingBytes.size());
+		pendingBytes.clear();
+	}
+
+	// The bytes glTexImage2D and glTexSubImage2D read, with the rows padded to the default unpack alignment of 4
+	size_t GetImageBytes(GLsizei width, GLsizei height, GLenum format, GLenum type)
+	{
+		size_t numComponents = 4, componentBytes = 1;
+		switch (format)
+		{
+		case GL_RED:
+		case GL_RED_INTEGER:
+		case GL_DEPTH_COMPONENT:
+		case GL_DEPTH_STENCIL:
+			numComponents = 1;
+			break;
+		case GL_RG:
+		case GL_RG_INTEGER:
+			numComponents = 2;
+			break;
+		case GL_RGB:
+		case GL_BGR:
+		case GL_RGB_INTEGER:
+			numComponents = 3;
+			break;
+		}
+
+		switch (type)
+		{
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+		case GL_HALF_FLOAT:
+			componentBytes = 2;
+			break;
+		case GL_INT:
+		case GL_UNSIGNED_INT:
+		case GL_FLOAT:
+			componentBytes = 4;
+			break;
+		case GL_UNSIGNED_INT_24_8: // Packed, so the whole pixel is the one component
+			numComponents = 1;
+			componentBytes = 4;
+			break;
+		case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+			numComponents = 1;
+			componentBytes = 8;
+			break;
+		}
+
+		const size_t rowBytes = ((size_t)width * numComponents * componentBytes + 3) & ~(size_t)3;
+		return rowBytes * height;
+	}
+
+	void RecordNames(Command command, GLsizei count, const GLuint* names)
+	{
+		Record(command, count);
+		WritePayload(names, sizeof(GLuint) * count);
+	}
+
+	void APIENTRY CaptureGenBuffers(GLsizei count, GLuint* names)
+	{
+		realGenBuffers(count, names);
+		if (capturing)
+			RecordNames(Command::GEN_BUFFERS, count, names);
+	}
+
+	void APIENTRY CaptureGenTextures(GLsizei count, GLuint* names)
+	{
+		realGenTextures(count, names);
+		if (capturing)
+			RecordNames(Command::GEN_TEXTURES, count, names);
+	}
+
+	void APIENTRY CaptureGenFramebuffers(GLsizei count, GLuint* names)
+	{
+		realGenFramebuffers(count, names);
+		if (capturing)
+			RecordNames(Command::GEN_FRAMEBUFFERS, count, names);
+	}
+
+	void APIENTRY CaptureGenRenderbuffers(GLsizei count, GLuint* names)
+	{
+		realGenRenderbuffers(count, names);
+		if (capturing)
+			RecordNames(Command::GEN_RENDERBUFFERS, count, names);
+	}
+
+	void APIENTRY CaptureGenVertexArrays(GLsizei count, GLuint* names)
+	{
+		realGenVertexArrays(count, names);
+		if (capturing)
+			RecordNames(Command::GEN_VERTEX_ARRAYS, count, names);
+	}
+
+	void APIENTRY CaptureGenQueries(GLsizei count, GLuint* names)
+	{
+		realGenQueries(count, names);
+		if (capturing)
+			RecordNames(Command::GEN_QUERIES, count, names);
+	}
+
+	void APIENTRY CaptureDeleteBuffers(GLsizei count, const GLuint* names)
+	{
+		if (capturing)
+			RecordNames(Command::DELETE_BUFFERS, count, names);
+		realDeleteBuffers(count, names);
+	}
+
+	void APIENTRY CaptureDeleteTextures(GLsizei count, const GLuint* names)
+	{
+		if (capturing)
+			RecordNames(Command::DELETE_TEXTURES, count, names);
+		realDeleteTextures(count, names);
+	}
+
+	void APIENTRY CaptureDeleteFramebuffers(GLsizei count, const GLuint* names)
+	{
+		if (capturing)
+			RecordNames(Command::DELETE_FRAMEBUFFERS, count, names);
+		realDeleteFramebuffers(count, names);
+	}
+
+	void APIENTRY CaptureDeleteRenderbuffers(GLsizei count, const GLuint* names)
+	{
+		if (capturing)
+			RecordNames(Command::DELETE_RENDERBUFFERS, count, names);
+		realDeleteRenderbuffers(count, names);
+	}
+
+	void APIENTRY CaptureDeleteVertexArrays(GLsizei count, const GLuint* names)
+	{
+		if (capturing)
+			RecordNames(Command::DELETE_VERTEX_ARRAYS, count, names);
+		realDeleteVertexArrays(count, names);
+	}
+
+	void APIENTRY CaptureDeleteQueries(GLsizei count, const GLuint* names)
+	{
+		if (capturing)
+			RecordNames(Command::DELETE_QUERIES, count, names);
+		realDeleteQueries(count, names);
+	}
+
+	GLuint APIENTRY CaptureCreateShader(GLenum type)
+	{
+		const GLuint shader = realCreateShader(type);
+		if (capturing)
+			Record(Command::CREATE_SHADER, type, shader);
+
+		return shader;
+	}
+
+	GLuint APIENTRY CaptureCreateProgram()
+	{
+		const GLuint program = realCreateProgram();
+		if (capturing)
+			Record(Command::CREATE_PROGRAM, program);
+
+		return program;
+	}
+
+	void APIENTRY CaptureDeleteShader(GLuint shader)
+	{
+		if (capturing)
+			Record(Command::DELETE_SHADER, shader);
+		realDeleteShader(shader);
+	}
+
+	void APIENTRY CaptureDeleteProgram(GLuint program)
+	{
+		if (capturing)
+			Record(Command::DELETE_PROGRAM, program);
+		realDeleteProgram(program);
+	}
+
+	void APIENTRY CaptureShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+	{
+		realShaderSource(shader, count, strings, lengths);
+		if (!capturing)
+			return;
+
+		// The strings are joined into one source, which is how the replay hands it back
+		std::string source;
+		for (GLsizei i = 0; i < count; i++)
+			source.append(strings[i], (lengths && lengths[i] >= 0) ? (size_t)lengths[i] : std::strlen(strings[i]));
+
+		Record(Command::SHADER_SOURCE, shader);
+		WritePayload(source.data(), source.size());
+	}
+
+	void APIENTRY CaptureCompileShader(GLuint shader)
+	{
+		if (capturing)
+			Record(Command::COMPILE_SHADER, shader);
+		realCompileShader(shader);
+	}
+
+	void APIENTRY CaptureAttachShader(GLuint program, GLuint shader)
+	{
+		if (capturing)
+			Record(Command::ATTACH_SHADER, program, shader);
+		realAttachShader(program, shader);
+	}
+
+	void APIENTRY CaptureLinkProgram(GLuint program)
+	{
+		if (capturing)
+			Record(Command::LINK_PROGRAM, program);
+		realLinkProgram(program);
+	}
+
+	void APIENTRY CaptureUseProgram(GLuint program)
+	{
+		if (capturing)
+			Record(Command::USE_PROGRAM, program);
+		realUseProgram(program);
+	}
+
+	GLint APIENTRY CaptureGetUniformLocation(GLuint program, const GLchar* name)
+	{
+		const GLint location = realGetUniformLocation(program, name);
+		if (capturing)
+		{
+			Record(Command::GET_UNIFORM_LOCATION, program, location);
+			WritePayload(name, std::strlen(name));
+		}
+
+		return location;
+	}
+
+	void APIENTRY CaptureUniform1i(GLint location, GLint value)
+	{
+		if (capturing)
+			Record(Command::UNIFORM_1I, location, value);
+		realUniform1i(location, value);
+	}
+
+	void APIENTRY CaptureUniform1f(GLint location, GLfloat value)
+	{
+		if (capturing)
+			Record(Command::UNIFORM_1F, location, value);
+		realUniform1f(location, value);
+	}
+
+	void APIENTRY CaptureUniform2fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		if (capturing)
+		{
+			Record(Command::UNIFORM_2FV, location, count);
+			WritePayload(value, sizeof(GLfloat) * 2 * count);
+		}
+
+		realUniform2fv(location, count, value);
+	}
+
+	void APIENTRY CaptureUniform3fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		if (capturing)
+		{
+			Record(Command::UNIFORM_3FV, location, count);
+			WritePayload(value, sizeof(GLfloat) * 3 * count);
+		}
+
+		realUniform3fv(location, count, value);
+	}
+
+	void APIENTRY CaptureUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+	{
+		if (capturing)
+		{
+			Record(Command::UNIFORM_MATRIX_4FV, location, count, transpose);
+			WritePayload(value, sizeof(GLfloat) * 16 * count);
+		}
+
+		realUniformMatrix4fv(location, count, transpose, value);
+	}
+
+	void APIENTRY CaptureBindBuffer(GLenum target, GLuint buffer)
+	{
+		if (capturing)
+			Record(Command::BIND_BUFFER, target, buffer);
+		realBindBuffer(target, buffer);
+	}
+
+	void APIENTRY CaptureBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+	{
+		if (capturing)
+		{
+			// An empty payload means the storage was allocated without any data
+			Record(Command::BUFFER_DATA, target, (uint64_t)size, usage);
+			WritePayload(data, data ? (size_t)size : 0);
+		}
+
+		realBufferData(target, size, data, usage);
+	}
+
+	void APIENTRY CaptureBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+	{
+		if (capturing)
+		{
+			Record(Command::BUFFER_SUB_DATA, target, (uint64_t)offset);
+			WritePayload(data, (size_t)size);
+		}
+
+		realBufferSubData(target, offset, size, data);
+	}
+
+	void APIENTRY CaptureBindVertexArray(GLuint vertexArray)
+	{
+		if (capturing)
+			Record(Command::BIND_VERTEX_ARRAY, vertexArray);
+		realBindVertexArray(vertexArray);
+	}
+
+	void APIENTRY CaptureEnableVertexAttribArray(GLuint index)
+	{
+		if (capturing)
+			Record(Command::ENABLE_VERTEX_ATTRIB_ARRAY, index);
+		realEnableVertexAttribArray(index);
+	}
+
+	void APIENTRY CaptureVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+		const void* offset)
+	{
+		// The vertices always come from a buffer, so the pointer is an offset into it
+		if (capturing)
+			Record(Command::VERTEX_ATTRIB_POINTER, index, size, type, normalized, stride, (uint64_t)offset);
+		realVertexAttribPointer(index, size, type, normalized, stride, offset);
+	}
+
+	void APIENTRY CaptureVertexAttribDivisor(GLuint index, GLuint divisor)
+	{
+		if (capturing)
+			Record(Command::VERTEX_ATTRIB_DIVISOR, index, divisor);
+		realVertexAttribDivisor(index, divisor);
+	}
+
+	void APIENTRY CaptureActiveTexture(GLenum unit)
+	{
+		if (capturing)
+			Record(Command::ACTIVE_TEXTURE, unit);
+		realActiveTexture(unit);
+	}
+
+	void APIENTRY CaptureBindTexture(GLenum target, GLuint texture)
+	{
+		if (capturing)
+			Record(Command::BIND_TEXTURE, target, texture);
+		realBindTexture(target, texture);
+	}
+
+	void APIENTRY CaptureTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+		GLint border, GLenum format, GLenum type, const void* pixels)
+	{
+		if (capturing)
+		{
+			Record(Command::TEX_IMAGE_2D, target, level, internalFormat, width, height, border, format, type);
+			WritePayload(pixels, pixels ? GetImageBytes(width, height, format, type) : 0);
+		}
+
+		realTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+	}
+
+	void APIENTRY CaptureTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+		GLenum format, GLenum type, const void* pixels)
+	{
+		if (capturing)
+		{
+			Record(Command::TEX_SUB_IMAGE_2D, target, level, x, y, width, height, format, type);
+			WritePayload(pixels, GetImageBytes(width, height, format, type));
+		}
+
+		realTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+	}
+
+	void APIENTRY CaptureTexImage2DMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width,
+		GLsizei height, GLboolean fixedSampleLocations)
+	{
+		if (capturing)
+			Record(Command::TEX_IMAGE_2D_MULTISAMPLE, target, samples, internalFormat, width, height, fixedSampleLocations);
+		realTexImage2DMultisample(target, samples, internalFormat, width, height, fixedSampleLocations);
+	}
+
+	void APIENTRY CaptureTexParameteri(GLenum target, GLenum name, GLint value)
+	{
+		if (capturing)
+			Record(Command::TEX_PARAMETER_I, target, name, value);
+		realTexParameteri(target, name, value);
+	}
+
+	void APIENTRY CaptureTexParameterfv(GLenum target, GLenum name, const GLfloat* values)
+	{
+		if (capturing)
+		{
+			Record(Command::TEX_PARAMETER_FV, target, name);
+			WritePayload(values, sizeof(GLfloat) * ((name == GL_TEXTURE_BORDER_COLOR) ? 4 : 1));
+		}
+
+		realTexParameterfv(target, name, values);
+	}
+
+	void APIENTRY CaptureTexBuffer(GLenum target, GLenum internalFormat, GLuint buffer)
+	{
+		if (capturing)
+			Record(Command::TEX_BUFFER, target, internalFormat, buffer);
+		realTexBuffer(target, internalFormat, buffer);
+	}
+
+	void APIENTRY CaptureGenerateMipmap(GLenum target)
+	{
+		if (capturing)
+			Record(Command::GENERATE_MIPMAP, target);
+		realGenerateMipmap(target);
+	}
+
+	void APIENTRY CaptureBindFramebuffer(GLenum target, GLuint framebuffer)
+	{
+		if (capturing)
+			Record(Command::BIND_FRAMEBUFFER, target, framebuffer);
+		realBindFramebuffer(target, framebuffer);
+	}
+
+	void APIENTRY CaptureBindRenderbuffer(GLenum target, GLuint renderbuffer)
+	{
+		if (capturing)
+			Record(Command::BIND_RENDERBUFFER, target, renderbuffer);
+		realBindRenderbuffer(target, renderbuffer);
+	}
+
+	void APIENTRY CaptureRenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height)
+	{
+		if (capturing)
+			Record(Command::RENDERBUFFER_STORAGE, target, internalFormat, width, height);
+		realRenderbufferStorage(target, internalFormat, width, height);
+	}
+
+	void APIENTRY CaptureRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat,
+		GLsizei width, GLsizei height)
+	{
+		if (capturing)
+			Record(Command::RENDERBUFFER_STORAGE_MULTISAMPLE, target, samples, internalFormat, width, height);
+		realRenderbufferStorageMultisample(target, samples, internalFormat, width, height);
+	}
+
+	void APIENTRY CaptureFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level)
+	{
+		if (capturing)
+			Record(Command::FRAMEBUFFER_TEXTURE, target, attachment, texture, level);
+		realFramebufferTexture(target, attachment, texture, level);
+	}
+
+	void APIENTRY CaptureFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture,
+		GLint level)
+	{
+		if (capturing)
+			Record(Command::FRAMEBUFFER_TEXTURE_2D, target, attachment, textureTarget, texture, level);
+		realFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+	}
+
+	void APIENTRY CaptureFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget,
+		GLuint renderbuffer)
+	{
+		if (capturing)
+			Record(Command::FRAMEBUFFER_RENDERBUFFER, target, attachment, renderbufferTarget, renderbuffer);
+		realFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+	}
+
+	void APIENTRY CaptureDrawBuffer(GLenum buffer)
+	{
+		if (capturing)
+			Record(Command::DRAW_BUFFER, buffer);
+		realDrawBuffer(buffer);
+	}
+
+	void APIENTRY CaptureDrawBuffers(GLsizei count, const GLenum* buffers)
+	{
+		if (capturing)
+		{
+			Record(Command::DRAW_BUFFERS, count);
+			WritePayload(buffers, sizeof(GLenum) * count);
+		}
+
+		realDrawBuffers(count, buffers);
+	}
+
+	void APIENTRY CaptureReadBuffer(GLenum buffer)
+	{
+		if (capturing)
+			Record(Command::READ_BUFFER, buffer);
+		realReadBuffer(buffer);
+	}
+
+	void APIENTRY CaptureBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0,
+		GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+	{
+		if (capturing)
+			Record(Command::BLIT_FRAMEBUFFER, srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+		realBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+	}
+
+	void APIENTRY CaptureEnable(GLenum capability)
+	{
+		if (capturing)
+			Record(Command::ENABLE, capability);
+		realEnable(capability);
+	}
+
+	void APIENTRY CaptureDisable(GLenum capability)
+	{
+		if (capturing)
+			Record(Command::DISABLE, capability);
+		realDisable(capability);
+	}
+
+	void APIENTRY CaptureBlendFunc(GLenum source, GLenum destination)
+	{
+		if (capturing)
+			Record(Command::BLEND_FUNC, source, destination);
+		realBlendFunc(source, destination);
+	}
+
+	void APIENTRY CaptureDepthFunc(GLenum func)
+	{
+		if (capturing)
+			Record(Command::DEPTH_FUNC, func);
+		realDepthFunc(func);
+	}
+
+	void APIENTRY CaptureDepthMask(GLboolean enabled)
+	{
+		if (capturing)
+			Record(Command::DEPTH_MASK, enabled);
+		realDepthMask(enabled);
+	}
+
+	void APIENTRY CaptureColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+	{
+		if (capturing)
+			Record(Command::COLOR_MASK, red, green, blue, alpha);
+		realColorMask(red, green, blue, alpha);
+	}
+
+	void APIENTRY CaptureViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+	{
+		if (capturing)
+			Record(Command::VIEWPORT, x, y, width, height);
+		realViewport(x, y, width, height);
+	}
+
+	void APIENTRY CaptureScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+	{
+		if (capturing)
+			Record(Command::SCISSOR, x, y, width, height);
+		realScissor(x, y, width, height);
+	}
+
+	void APIENTRY CaptureClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+	{
+		if (capturing)
+			Record(Command::CLEAR_COLOR, red, green, blue, alpha);
+		realClearColor(red, green, blue, alpha);
+	}
+
+	void APIENTRY CaptureClear(GLbitfield mask)
+	{
+		if (capturing)
+			Record(Command::CLEAR, mask);
+		realClear(mask);
+	}
+
+	void APIENTRY CaptureClearBufferuiv(GLenum buffer, GLint drawBuffer, const GLuint* value)
+	{
+		if (capturing)
+		{
+			Record(Command::CLEAR_BUFFER_UIV, buffer, drawBuffer);
+			WritePayload(value, sizeof(GLuint) * 4);
+		}
+
+		realClearBufferuiv(buffer, drawBuffer, value);
+	}
+
+	void APIENTRY CaptureBeginQuery(GLenum target, GLuint query)
+	{
+		if (capturing)
+			Record(Command::BEGIN_QUERY, target, query);
+		realBeginQuery(target, query);
+	}
+
+	void APIENTRY CaptureEndQuery(GLenum target)
+	{
+		if (capturing)
+			Record(Command::END_QUERY, target);
+		realEndQuery(target);
+	}
+
+	void APIENTRY CaptureQueryCounter(GLuint query, GLenum target)
+	{
+		if (capturing)
+			Record(Command::QUERY_COUNTER, query, target);
+		realQueryCounter(query, target);
+	}
+
+	void APIENTRY CaptureBeginConditionalRender(GLuint query, GLenum mode)
+	{
+		if (capturing)
+			Record(Command::BEGIN_CONDITIONAL_RENDER, query, mode);
+		realBeginConditionalRender(query, mode);
+	}
+
+	void APIENTRY CaptureEndConditionalRender()
+	{
+		if (capturing)
+			Record(Command::END_CONDITIONAL_RENDER);
+		realEndConditionalRender();
+	}
+
+	void APIENTRY CaptureDrawArrays(GLenum mode, GLint first, GLsizei count)
+	{
+		if (capturing)
+			Record(Command::DRAW_ARRAYS, mode, first, count);
+		realDrawArrays(mode, first, count);
+	}
+
+	void APIENTRY CaptureDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+	{
+		// The indices always come from a buffer, so the pointer is an offset into it
+		if (capturing)
+			Record(Command::DRAW_ELEMENTS, mode, count, type, (uint64_t)indices);
+		realDrawElements(mode, count, type, indices);
+	}
+
+	void APIENTRY CaptureDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices,
+		GLsizei instances)
+	{
+		if (capturing)
+			Record(Command::DRAW_ELEMENTS_INSTANCED, mode, count, type, (uint64_t)indices, instances);
+		realDrawElementsInstanced(mode, count, type, indices, instances);
+	}
+
+	void APIENTRY CaptureFlush()
+	{
+		if (capturing)
+			Record(Command::FLUSH);
+		realFlush();
+	}
+}
+
+namespace GLCapture
+{
+	bool BeginCapture(const std::string& filePath, uint32_t numFrames, uint32_t width, uint32_t height)
+	{
+		if (capturing || realFlush)
+		{
+			OutputLog("Only one GL capture can be made per run", Logging::Severity::WARNING);
+			return false;
+		}
+
+		traceFile.open(filePath, std::ios::binary);
+		if (!traceFile.is_open())
+		{
+			OutputLog("Failed to open the GL trace \"" + filePath + "\"", Logging::Severity::WARNING);
+			return false;
+		}
+
+		const GLTrace::Header header = { GLTrace::MAGIC, GLTrace::VERSION, width, height, numFrames };
+		traceFile.write((const char*)&header, sizeof(header));
+
+		pendingBytes.reserve(FLUSH_THRESHOLD * 2);
+		tracePath = filePath;
+		numFramesLeft = numFrames;
+		capturing = true;
+
+#define SWAP_ENTRY_POINT(name) real##name = glad_gl##name; glad_gl##name = Capture##name;
+		GL_CAPTURE_ENTRY_POINTS(SWAP_ENTRY_POINT)
+#undef SWAP_ENTRY_POINT
+
+		OutputLog("Capturing the GL calls of the loading and the next " + std::to_string(numFrames) + " frames to \"" + 
+			filePath + "\"", Logging::Severity::NOTIFICATION);
+		return true;
+	}
+
+	void EndLoad()
+	{
+		if (!capturing)
+			return;
+
+		Record(Command::LOAD_END);
+		framesStarted = true;
+	}
+
+	void EndFrame()
+	{
+		if (!capturing || !framesStarted)
+			return;
+
+		Record(Command::FRAME_END);
+		if (pendingBytes.size() >= FLUSH_THRESHOLD)
+			FlushPending();
+
+		if (--numFramesLeft > 0)
+			return;
+
+		FlushPending();
+		const std::streamoff traceBytes = traceFile.tellp();
+		traceFile.close();
+		capturing = false;
+
+		OutputLog("GL trace written to \"" + tracePath + "\" (" + std::to_string(traceBytes / 1024) + " KB)", 
+			Logging::Severity::NOTIFICATION);
+	}
+
+	bool IsCapturing()
+	{
+		return capturing;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+
+typedef unsigned int uint32_t;
+
+/*
+	GLCapture : Records every GL call the app makes, along with the data it hands over (buffer contents, texture pixels,
+	shader sources, uniform values), into a binary trace the replay tool can run on its own. Like RenderStats the glad
+	entry points are swapped for ones that write the call out before forwarding it, but a trace only replays if it has
+	every object the frames use, so recording starts before anything is loaded and takes in the loading as well as the
+	frames. The swap stays in place once the capture is done, as anything swapped in on top of it (e.g. RenderStats)
+	would otherwise be undone, but the entry points only forward the call from then on.
+*/
+namespace GLCapture
+{
+	/*
+		BeginCapture() : Swaps in the recording entry points, this must be called once glad has loaded them and before
+		anything else swaps them. Returns false if the trace couldn't be opened.
+		[filePath] - Where the trace is written
+		[numFrames] - How many frames are recorded after the loading
+		[width] - The width of the default framebuffer, which the replay sizes its own to
+		[height] - The height of the default framebuffer
+	*/
+	bool BeginCapture(const std::string& filePath, uint32_t numFrames, uint32_t width, uint32_t height);
+
+	// Marks where the loading ends and the frames start
+	void EndLoad();
+
+	// Marks the end of a frame, and finishes the trace once the last frame is in
+	void EndFrame();
+
+	bool IsCapturing();
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "GLDebug.h"
+#include "Core/WindowFrame.h"
+#include "Utils/LoggingManager.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+// glad was generated for plain 3.3 core, so KHR_debug's enums and entry points are declared here and loaded by hand
+#ifndef GL_KHR_debug
+#define GL_DEBUG_OUTPUT 0x92E0
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS 0x8242
+#define GL_CONTEXT_FLAG_DEBUG_BIT 0x00000002
+#define GL_MAX_LABEL_LENGTH 0x82E8
+#define GL_DEBUG_SOURCE_API 0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM 0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER 0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY 0x8249
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR 0x824E
+#define GL_DEBUG_TYPE_PORTABILITY 0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE 0x8250
+#define GL_DEBUG_SEVERITY_HIGH 0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM 0x9147
+#define GL_DEBUG_SEVERITY_LOW 0x9148
+#define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+#define GL_BUFFER 0x82E0
+#define GL_PROGRAM 0x82E2
+#define GL_VERTEX_ARRAY 0x8074
+#endif
+
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECALLBACKPROC_)(GLDEBUGPROC callback, const void* userParam);
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECONTROLPROC_)(GLenum source, GLenum type, GLenum severity, GLsizei count,
+	const GLuint* ids, GLboolean enabled);
+typedef void (APIENTRYP PFNGLOBJECTLABELPROC_)(GLenum identifier, GLuint name, GLsizei length, const GLchar* label);
+typedef void (APIENTRYP PFNGLPUSHDEBUGGROUPPROC_)(GLenum source, GLuint id, GLsizei length, const GLchar* message);
+typedef void (APIENTRYP PFNGLPOPDEBUGGROUPPROC_)();
+
+namespace
+{
+	// A message raised every frame would bury everything else, so after this many only its count is kept
+	constexpr uint32_t MAX_REPEATS_LOGGED = 3;
+
+	PFNGLDEBUGMESSAGECALLBACKPROC_ debugMessageCallback = nullptr;
+	PFNGLDEBUGMESSAGECONTROLPROC_ debugMessageControl = nullptr;
+	PFNGLOBJECTLABELPROC_ objectLabel = nullptr;
+	PFNGLPUSHDEBUGGROUPPROC_ pushDebugGroup = nullptr;
+	PFNGLPOPDEBUGGROUPPROC_ popDebugGroup = nullptr;
+
+	bool enabled = false;
+	GLsizei maxLabelLength = 256;
+
+	std::vector<const char*> openGroups;
+	std::unordered_map<uint64_t, uint32_t> messageCounts; // Keyed by the message's source, type and ID
+
+	bool HasExtension(const char* name)
+	{
+		GLint numExtensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+		for (GLint i = 0; i < numExtensions; i++)
+		{
+			if (std::strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	const char* GetTypeName(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_DEBUG_TYPE_ERROR:
+			return "error";
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+			return "deprecated behaviour";
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+			return "undefined behaviour";
+		case GL_DEBUG_TYPE_PORTABILITY:
+			return "portability warning";
+		case GL_DEBUG_TYPE_PERFORMANCE:
+			return "performance warning";
+		default:
+			return "message";
+		}
+	}
+
+	const char* GetSourceName(GLenum source)
+	{
+		switch (source)
+		{
+		case GL_DEBUG_SOURCE_API:
+			return "API";
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+			return "window system";
+		case GL_DEBUG_SOURCE_SHADER_COMPILER:
+			return "shader compiler";
+		case GL_DEBUG_SOURCE_THIRD_PARTY:
+			return "third party";
+		case GL_DEBUG_SOURCE_APPLICATION:
+			return "application";
+		default:
+			return "driver";
+		}
+	}
+
+	void APIENTRY HandleDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+		const GLchar* message, const void*)
+	{
+		const uint64_t key = ((uint64_t)source << 48) ^ ((uint64_t)type << 32) ^ id;
+		const uint32_t count = ++messageCounts[key];
+		if (count > MAX_REPEATS_LOGGED)
+			return;
+
+		// The groups open at the time are the passes the call was made in, which is what makes the message attributable
+		std::string location;
+		for (const char* group : openGroups)
+			location.append(location.empty() ? "" : "/").append(group);
+
+		std::string log = "GL " + std::string(GetTypeName(type)) + " from the " + GetSourceName(source) +
+			(location.empty() ? "" : " in \"" + location + "\"") + " (ID " + std::to_string(id) + "): " +
+			std::string(message, (length >= 0) ? (size_t)length : std::strlen(message));
+
+		if (count == MAX_REPEATS_LOGGED)
+			log += " (repeats of this message won't be logged)";
+
+		// Errors and performance warnings are what this is here for, anything of low severity is only a notification
+		const bool isWarning = (type == GL_DEBUG_TYPE_ERROR || type == GL_DEBUG_TYPE_PERFORMANCE ||
+			type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR || severity == GL_DEBUG_SEVERITY_HIGH ||
+			severity == GL_DEBUG_SEVERITY_MEDIUM);
+
+		OutputLog(log, isWarning ? Logging::Severity::WARNING : Logging::Severity::NOTIFICATION);
+	}
+
+	GLenum GetIdentifier(GLDebug::ObjectType type)
+	{
+		switch (type)
+		{
+		case GLDebug::ObjectType::BUFFER:
+			return GL_BUFFER;
+		case GLDebug::ObjectType::TEXTURE:
+			return GL_TEXTURE;
+		case GLDebug::ObjectType::RENDERBUFFER:
+			return GL_RENDERBUFFER;
+		case GLDebug::ObjectType::FRAMEBUFFER:
+			return GL_FRAMEBUFFER;
+		case GLDebug::ObjectType::VERTEX_ARRAY:
+			return GL_VERTEX_ARRAY;
+		default:
+			return GL_PROGRAM;
+		}
+	}
+}
+
+namespace GLDebug
+{
+	bool Initialize(const std::shared_ptr<WindowFrame>& window)
+	{
+		GLint contextFlags = 0;
+		glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
+		if (!(contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT))
+			return false;
+
+		GLint majorVersion = 0, minorVersion = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+		glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+		// It's core from 4.3, and the entry points have no suffix either way
+		if ((majorVersion < 4 || (majorVersion == 4 && minorVersion < 3)) && !HasExtension("GL_KHR_debug"))
+		{
+			OutputLog("The debug context doesn't support KHR_debug, so the driver's messages won't be logged",
+				Logging::Severity::WARNING);
+			return false;
+		}
+
+		debugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC_)window->GetProcAddress("glDebugMessageCallback");
+		debugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC_)window->GetProcAddress("glDebugMessageControl");
+		objectLabel = (PFNGLOBJECTLABELPROC_)window->GetProcAddress("glObjectLabel");
+		pushDebugGroup = (PFNGLPUSHDEBUGGROUPPROC_)window->GetProcAddress("glPushDebugGroup");
+		popDebugGroup = (PFNGLPOPDEBUGGROUPPROC_)window->GetProcAddress("glPopDebugGroup");
+
+		if (!debugMessageCallback || !debugMessageControl || !objectLabel || !pushDebugGroup || !popDebugGroup)
+		{
+			OutputLog("Failed to load the KHR_debug entry points!", Logging::Severity::WARNING);
+			return false;
+		}
+
+		glGetIntegerv(GL_MAX_LABEL_LENGTH, &maxLabelLength);
+
+		// Synchronous output raises each message inside the call that caused it, so the open groups are the right ones
+		glEnable(GL_DEBUG_OUTPUT);
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		debugMessageCallback(HandleDebugMessage, nullptr);
+
+		// Notifications include the group pushes and pops, as well as the drivers reporting where every buffer lives
+		debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+
+		enabled = true;
+		OutputLog("KHR_debug output enabled", Logging::Severity::NOTIFICATION);
+		return true;
+	}
+
+	bool IsEnabled()
+	{
+		return enabled;
+	}
+
+	void LabelObject(ObjectType type, uint32_t name, const std::string& label)
+	{
+		if (!enabled)
+			return;
+
+		objectLabel(GetIdentifier(type), name, std::min((GLsizei)label.size(), maxLabelLength - 1), label.c_str());
+	}
+
+	void PushGroup(const char* name)
+	{
+		if (!enabled)
+			return;
+
+		openGroups.emplace_back(name);
+		pushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, std::min((GLsizei)std::strlen(name), maxLabelLength - 1), name);
+	}
+
+	void PopGroup()
+	{
+		if (!enabled || openGroups.empty())
+			return;
+
+		popDebugGroup();
+		openGroups.pop_back();
+	}
+}
\ No newline at end of file
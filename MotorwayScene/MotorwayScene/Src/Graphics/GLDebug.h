@@ -0,0 +1,42 @@
+#pragma once
+#include <memory>
+#include <string>
+
+class WindowFrame;
+
+typedef unsigned int uint32_t;
+
+/*
+	GLDebug : Routes the driver's KHR_debug messages into the log, and names the GL objects and render passes so the
+	messages (and tools like RenderDoc) can say what they're about. Each message is logged with the debug groups open
+	when it was raised, which are the render graph's passes, so a performance warning such as a buffer upload stalling
+	on the GPU or a shader being recompiled for new state reads as coming from a pass rather than from a bare object ID.
+	Everything here does nothing unless it was initialized on a debug context, so it costs nothing otherwise.
+*/
+namespace GLDebug
+{
+	enum class ObjectType
+	{
+		BUFFER,
+		TEXTURE,
+		RENDERBUFFER,
+		FRAMEBUFFER,
+		VERTEX_ARRAY,
+		PROGRAM
+	};
+
+	/*
+		Initialize() : Loads the KHR_debug entry points and installs the message callback. Returns false if the context
+		isn't a debug context or the driver doesn't have KHR_debug, in which case the rest of the functions do nothing.
+		[window] - The window whose context was made, which is used to look up the entry points
+	*/
+	bool Initialize(const std::shared_ptr<WindowFrame>& window);
+
+	bool IsEnabled();
+
+	void LabelObject(ObjectType type, uint32_t name, const std::string& label);
+
+	// The name is kept until the group is popped rather than copied, so it has to stay valid until then
+	void PushGroup(const char* name);
+	void PopGroup();
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+
+/*
+	GLTrace : The layout of the binary traces written by GLCapture and read by the replay tool. A trace is a header
+	followed by one record per GL call, each being the command's byte then its arguments packed with no padding. The
+	sizes and offsets (GLsizeiptr, GLintptr and pointers into buffers) are always written as 64 bits, so a trace
+	recorded by a 32 bit build replays in a 64 bit one. Any data the call reads from memory follows the arguments as a
+	32 bit size then the bytes. Object names are written as the app saw them, the replay maps them to its own.
+*/
+namespace GLTrace
+{
+	constexpr uint32_t MAGIC = 0x5447574D; // "MWGT"
+	constexpr uint32_t VERSION = 1;
+
+	struct Header
+	{
+		uint32_t m_magic, m_version;
+		uint32_t m_width, m_height; // The size of the default framebuffer when it was recorded
+		uint32_t m_numFrames;
+	};
+
+	enum class Command : uint8_t
+	{
+		// Markers, the first is written once the scene has finished loading and the second at the end of every frame
+		LOAD_END,
+		FRAME_END,
+
+		// Object creation and deletion, the generated names follow as a payload
+		GEN_BUFFERS,
+		GEN_TEXTURES,
+		GEN_FRAMEBUFFERS,
+		GEN_RENDERBUFFERS,
+		GEN_VERTEX_ARRAYS,
+		GEN_QUERIES,
+		DELETE_BUFFERS,
+		DELETE_TEXTURES,
+		DELETE_FRAMEBUFFERS,
+		DELETE_RENDERBUFFERS,
+		DELETE_VERTEX_ARRAYS,
+		DELETE_QUERIES,
+		CREATE_SHADER,
+		CREATE_PROGRAM,
+		DELETE_SHADER,
+		DELETE_PROGRAM,
+
+		// Shaders and uniforms
+		SHADER_SOURCE,
+		COMPILE_SHADER,
+		ATTACH_SHADER,
+		LINK_PROGRAM,
+		USE_PROGRAM,
+		GET_UNIFORM_LOCATION, // Recorded along with the location returned, so the replay can map it to its own
+		UNIFORM_1I,
+		UNIFORM_1F,
+		UNIFORM_2FV,
+		UNIFORM_3FV,
+		UNIFORM_MATRIX_4FV,
+
+		// Buffers and vertex arrays
+		BIND_BUFFER,
+		BUFFER_DATA,
+		BUFFER_SUB_DATA,
+		BIND_VERTEX_ARRAY,
+		ENABLE_VERTEX_ATTRIB_ARRAY,
+		VERTEX_ATTRIB_POINTER,
+		VERTEX_ATTRIB_DIVISOR,
+
+		// Textures
+		ACTIVE_TEXTURE,
+		BIND_TEXTURE,
+		TEX_IMAGE_2D,
+		TEX_SUB_IMAGE_2D,
+		TEX_IMAGE_2D_MULTISAMPLE,
+		TEX_PARAMETER_I,
+		TEX_PARAMETER_FV,
+		TEX_BUFFER,
+		GENERATE_MIPMAP,
+
+		// Framebuffers
+		BIND_FRAMEBUFFER,
+		BIND_RENDERBUFFER,
+		RENDERBUFFER_STORAGE,
+		RENDERBUFFER_STORAGE_MULTISAMPLE,
+		FRAMEBUFFER_TEXTURE,
+		FRAMEBUFFER_TEXTURE_2D,
+		FRAMEBUFFER_RENDERBUFFER,
+		DRAW_BUFFER,
+		DRAW_BUFFERS,
+		READ_BUFFER,
+		BLIT_FRAMEBUFFER,
+
+		// Fixed function state
+		ENABLE,
+		DISABLE,
+		BLEND_FUNC,
+		DEPTH_FUNC,
+		DEPTH_MASK,
+		COLOR_MASK,
+		VIEWPORT,
+		SCISSOR,
+		CLEAR_COLOR,
+		CLEAR,
+		CLEAR_BUFFER_UIV,
+
+		// Queries
+		BEGIN_QUERY,
+		END_QUERY,
+		QUERY_COUNTER,
+		BEGIN_CONDITIONAL_RENDER,
+		END_CONDITIONAL_RENDER,
+
+		// Drawing
+		DRAW_ARRAYS,
+		DRAW_ELEMENTS,
+		DRAW_ELEMENTS_INSTANCED,
+		FLUSH,
+
+		NUM_COMMANDS
+	};
+}
\ No newline at end of file
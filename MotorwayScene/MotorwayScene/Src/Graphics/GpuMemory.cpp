@@ -0,0 +1,188 @@
+#include "GpuMemory.h"
+#include "Utils/LoggingManager.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	// How many of the biggest objects are listed when the budget is gone over
+	constexpr uint32_t NUM_CONSUMERS_LOGGED = 5;
+
+	std::unordered_map<const void*, GpuAllocation> allocations;
+	GpuMemoryUsage usage = {};
+
+	size_t budget = 0;
+	bool overBudget = false;
+
+	size_t GetBytesPerPixel(GLenum internalFormat)
+	{
+		switch (internalFormat)
+		{
+		case GL_R8:
+		case GL_RED:
+			return 1;
+		case GL_RG8:
+		case GL_RG:
+		case GL_R16F:
+			return 2;
+		case GL_RGBA16F:
+		case GL_RG32F:
+			return 8;
+		case GL_RGBA32F:
+			return 16;
+		default:
+			// RGBA8, SRGB8_ALPHA8, RG16F, R32F, R32UI and the depth formats, along with the 24 bit color formats which
+			// drivers pad out to 32
+			return 4;
+		}
+	}
+
+	void UpdateAllocation(GpuAllocation& allocation, GpuMemoryCategory category, size_t bytes)
+	{
+		usage.m_bytes[(size_t)allocation.m_category] -= allocation.m_bytes;
+		usage.m_totalBytes -= allocation.m_bytes;
+
+		allocation.m_category = category;
+		allocation.m_bytes = bytes;
+
+		size_t& categoryBytes = usage.m_bytes[(size_t)category];
+		categoryBytes += bytes;
+		usage.m_totalBytes += bytes;
+
+		usage.m_peakBytes[(size_t)category] = std::max(usage.m_peakBytes[(size_t)category], categoryBytes);
+		usage.m_peakTotalBytes = std::max(usage.m_peakTotalBytes, usage.m_totalBytes);
+	}
+}
+
+namespace GpuMemory
+{
+	void Register(const void* object, GpuMemoryCategory category, size_t bytes)
+	{
+		auto allocation = allocations.find(object);
+		if (allocation == allocations.end())
+		{
+			allocation = allocations.emplace(object, GpuAllocation({ std::string(), category, 0 })).first;
+			usage.m_numObjects++;
+		}
+
+		UpdateAllocation(allocation->second, category, bytes);
+	}
+
+	void Unregister(const void* object)
+	{
+		auto allocation = allocations.find(object);
+		if (allocation == allocations.end())
+			return;
+
+		UpdateAllocation(allocation->second, allocation->second.m_category, 0);
+
+		allocations.erase(allocation);
+		usage.m_numObjects--;
+	}
+
+	void Resize(const void* object, size_t bytes)
+	{
+		auto allocation = allocations.find(object);
+		if (allocation != allocations.end() && allocation->second.m_bytes != bytes)
+			UpdateAllocation(allocation->second, allocation->second.m_category, bytes);
+	}
+
+	void SetCategory(const void* object, GpuMemoryCategory category)
+	{
+		auto allocation = allocations.find(object);
+		if (allocation != allocations.end() && allocation->second.m_category != category)
+			UpdateAllocation(allocation->second, category, allocation->second.m_bytes);
+	}
+
+	void SetLabel(const void* object, const std::string& label)
+	{
+		// Pooled render targets are renamed every frame, and assigning over the old name reuses its storage
+		auto allocation = allocations.find(object);
+		if (allocation != allocations.end())
+			allocation->second.m_label = label;
+	}
+
+	void SetBudget(size_t bytes)
+	{
+		budget = bytes;
+		overBudget = false;
+
+		if (budget > 0)
+		{
+			OutputLog("GPU memory budget set to " + std::to_string(budget / (1024 * 1024)) + " MB",
+				Logging::Severity::NOTIFICATION);
+		}
+	}
+
+	void CheckBudget()
+	{
+		if (budget == 0 || usage.m_totalBytes <= budget)
+		{
+			overBudget = false;
+			return;
+		}
+
+		// Only once each time it goes over, rather than every frame it stays over
+		if (overBudget)
+			return;
+
+		overBudget = true;
+
+		std::string consumers;
+		for (const GpuAllocation* allocation : GetTopConsumers(NUM_CONSUMERS_LOGGED))
+		{
+			consumers += (consumers.empty() ? "" : ", ") + (allocation->m_label.empty() ? std::string("unnamed") : 
+				allocation->m_label) + " (" + std::to_string(allocation->m_bytes / 1024) + " KB)";
+		}
+
+		OutputLog("GPU memory has gone over the budget of " + std::to_string(budget / (1024 * 1024)) + " MB, " +
+			std::to_string(usage.m_totalBytes / (1024 * 1024)) + " MB is in use and the biggest objects are " + 
+			consumers, Logging::Severity::WARNING);
+	}
+
+	const size_t& GetBudget()
+	{
+		return budget;
+	}
+
+	const GpuMemoryUsage& GetUsage()
+	{
+		return usage;
+	}
+
+	FrameVector<const GpuAllocation*> GetTopConsumers(uint32_t count)
+	{
+		FrameVector<const GpuAllocation*> consumers;
+		consumers.reserve(allocations.size());
+		for (const auto& allocation : allocations)
+			consumers.emplace_back(&allocation.second);
+
+		const size_t numConsumers = std::min((size_t)count, consumers.size());
+		std::partial_sort(consumers.begin(), consumers.begin() + numConsumers, consumers.end(),
+			[](const GpuAllocation* first, const GpuAllocation* second) { return first->m_bytes > second->m_bytes; });
+
+		consumers.resize(numConsumers);
+		return consumers;
+	}
+
+	const char* GetCategoryName(GpuMemoryCategory category)
+	{
+		switch (category)
+		{
+		case GpuMemoryCategory::GEOMETRY:
+			return "Geometry";
+		case GpuMemoryCategory::INSTANCE:
+			return "Instance data";
+		case GpuMemoryCategory::TEXTURE:
+			return "Textures";
+		default:
+			return "Render targets";
+		}
+	}
+
+	size_t GetTextureBytes(uint32_t width, uint32_t height, GLenum internalFormat)
+	{
+		return (size_t)width * height * GetBytesPerPixel(internalFormat);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include "Utils/FrameArena.h"
+
+#include <glad/glad.h>
+#include <string>
+
+typedef unsigned int uint32_t;
+
+enum class GpuMemoryCategory
+{
+	GEOMETRY,		// Vertex and index data
+	INSTANCE,		// Per instance and per frame data from the CPU, like the instance transforms and light lists
+	TEXTURE,		// Textures sampled by the materials, the sky and the overlay
+	RENDER_TARGET,	// Anything drawn into, which are the textures attached to framebuffers and the renderbuffers
+	NUM_CATEGORIES
+};
+
+struct GpuAllocation
+{
+	std::string m_label;
+	GpuMemoryCategory m_category;
+	size_t m_bytes;
+};
+
+struct GpuMemoryUsage
+{
+	size_t m_bytes[(size_t)GpuMemoryCategory::NUM_CATEGORIES];
+	size_t m_peakBytes[(size_t)GpuMemoryCategory::NUM_CATEGORIES];
+	size_t m_totalBytes, m_peakTotalBytes;
+	uint32_t m_numObjects;
+};
+
+/*
+	GpuMemory : Keeps the size of every buffer, texture and renderbuffer the app makes, so it can be told how much video
+	memory the scene needs and what it's spent on. The GL objects register themselves when they're made and remove
+	themselves when they're deleted, keyed by their own address, so nothing is left to the call sites. The sizes are
+	worked out from the formats and dimensions asked for, which is what the driver has to find room for, rather than
+	read back from it, so they hold the same on every driver. Objects are only made on the main thread, so none of this
+	is locked.
+*/
+namespace GpuMemory
+{
+	/*
+		Register() : Starts counting an object's memory, or updates it if the object has already been registered.
+		[object] - The object the memory belongs to, which is only used as its key
+		[category] - What the memory is used for
+		[bytes] - How big the object's storage is, which can be zero until its data is given
+	*/
+	void Register(const void* object, GpuMemoryCategory category, size_t bytes);
+	void Unregister(const void* object);
+
+	// For an object whose storage was reallocated, or whose use only became clear later (e.g. an attached texture)
+	void Resize(const void* object, size_t bytes);
+	void SetCategory(const void* object, GpuMemoryCategory category);
+	void SetLabel(const void* object, const std::string& label);
+
+	/*
+		SetBudget() : A warning is logged, along with the biggest consumers, each time the total is found to have gone
+		over the budget.
+		[bytes] - The most the scene should use, nothing's checked if this is zero
+	*/
+	void SetBudget(size_t bytes);
+
+	// Done once the loading's finished and at the end of every frame, by which time the new objects have been named
+	void CheckBudget();
+	const size_t& GetBudget();
+
+	const GpuMemoryUsage& GetUsage();
+
+	// The biggest objects first, the pointers are only good until an object is next registered or removed
+	FrameVector<const GpuAllocation*> GetTopConsumers(uint32_t count);
+
+	const char* GetCategoryName(GpuMemoryCategory category);
+
+	// The storage a texture needs, one face and mip level of it only
+	size_t GetTextureBytes(uint32_t width, uint32_t height, GLenum internalFormat);
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "GpuProfiler.h"
+#include "Utils/LoggingManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+	// How many frames can be waiting on the GPU before the oldest is dropped
+	constexpr uint32_t NUM_FRAME_SLOTS = 5;
+
+	// How many resolved frames are averaged into each line of the frame log
+	constexpr uint32_t LOG_INTERVAL = 120;
+
+	constexpr uint32_t UNSET_QUERY = 0xFFFFFFFF;
+}
+
+GpuProfiler::GpuProfiler() :
+	m_frameSlots(NUM_FRAME_SLOTS), m_frameIndex(0), m_resolvedFrameIndex(0), m_numDroppedFrames(0), m_enabled(true),
+	m_recording(false), m_logEnabled(false), m_numLoggedFrames(0)
+{
+	for (auto& slot : m_frameSlots)
+	{
+		slot.m_numQueriesUsed = 0;
+		slot.m_frameIndex = 0;
+		slot.m_pending = false;
+	}
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (auto& slot : m_frameSlots)
+	{
+		if (!slot.m_queries.empty())
+			glDeleteQueries((GLsizei)slot.m_queries.size(), &slot.m_queries[0]);
+	}
+}
+
+GpuProfiler* GpuProfiler::GetPtr()
+{
+	static GpuProfiler singleton;
+	return &singleton;
+}
+
+void GpuProfiler::BeginFrame()
+{
+	if (!m_enabled)
+		return;
+
+	this->ResolveFrames();
+
+	// Whatever is left in this slot is from a full ring ago and still isn't done, so it's thrown away rather than waited on
+	FrameSlot& slot = m_frameSlots[m_frameIndex % NUM_FRAME_SLOTS];
+	if (slot.m_pending)
+		m_numDroppedFrames++;
+
+	slot.m_timers.clear();
+	slot.m_numQueriesUsed = 0;
+	slot.m_frameIndex = m_frameIndex;
+	slot.m_pending = true;
+
+	m_frameIndex++;
+	m_recording = true;
+}
+
+void GpuProfiler::ResolveFrames()
+{
+	// Oldest first, stopping at the first frame that isn't done as the ones after it can't be either
+	for (uint32_t i = 0; i < NUM_FRAME_SLOTS; i++)
+	{
+		FrameSlot& slot = m_frameSlots[(m_frameIndex + i) % NUM_FRAME_SLOTS];
+		if (!slot.m_pending)
+			continue;
+
+		if (slot.m_numQueriesUsed == 0)
+		{
+			slot.m_pending = false;
+			continue;
+		}
+
+		// The timestamps finish in the order they were issued, so the slot is done once its last one is
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(slot.m_queries[slot.m_numQueriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE)
+			break;
+
+		this->ResolveSlot(slot);
+	}
+}
+
+void GpuProfiler::ResolveSlot(FrameSlot& slot)
+{
+	m_timings.clear();
+
+	for (const auto& timer : slot.m_timers)
+	{
+		if (timer.m_endQuery == UNSET_QUERY)
+			continue;
+
+		GLuint64 beginTime = 0, endTime = 0;
+		glGetQueryObjectui64v(slot.m_queries[timer.m_beginQuery], GL_QUERY_RESULT, &beginTime);
+		glGetQueryObjectui64v(slot.m_queries[timer.m_endQuery], GL_QUERY_RESULT, &endTime);
+
+		m_timings.push_back({ timer.m_name, (float)(endTime - beginTime) / 1000000.0f });
+	}
+
+	m_resolvedFrameIndex = slot.m_frameIndex;
+	slot.m_pending = false;
+
+	if (m_logEnabled)
+		this->AccumulateLog();
+}
+
+void GpuProfiler::AccumulateLog()
+{
+	for (const auto& timing : m_timings)
+	{
+		auto accumulator = std::find_if(m_logAccumulators.begin(), m_logAccumulators.end(),
+			[&timing](const LogAccumulator& entry) { return std::strcmp(entry.m_name, timing.m_name) == 0; });
+
+		if (accumulator == m_logAccumulators.end())
+		{
+			m_logAccumulators.push_back({ timing.m_name, 0.0, 0 });
+			accumulator = m_logAccumulators.end() - 1;
+		}
+
+		accumulator->m_totalTime += timing.m_time;
+		accumulator->m_numFrames++;
+	}
+
+	if (++m_numLoggedFrames < LOG_INTERVAL)
+		return;
+
+	std::ostringstream message;
+	message << std::fixed << std::setprecision(3) << "GPU times over the last " << LOG_INTERVAL << " frames:";
+	for (const auto& accumulator : m_logAccumulators)
+		message << " " << accumulator.m_name << " " << accumulator.m_totalTime / accumulator.m_numFrames << "ms";
+
+	if (m_numDroppedFrames > 0)
+		message << " (" << m_numDroppedFrames << " frames dropped so far)";
+
+	OutputLog(message.str(), Logging::Severity::NOTIFICATION);
+
+	m_logAccumulators.clear();
+	m_numLoggedFrames = 0;
+}
+
+uint32_t GpuProfiler::AcquireQuery(FrameSlot& slot)
+{
+	if (slot.m_numQueriesUsed == (uint32_t)slot.m_queries.size())
+	{
+		slot.m_queries.emplace_back(0);
+		glGenQueries(1, &slot.m_queries.back());
+	}
+
+	return slot.m_numQueriesUsed++;
+}
+
+void GpuProfiler::BeginTimer(const char* name)
+{
+	if (!m_enabled || !m_recording)
+		return;
+
+	FrameSlot& slot = m_frameSlots[(m_frameIndex - 1) % NUM_FRAME_SLOTS];
+	const uint32_t query = this->AcquireQuery(slot);
+	glQueryCounter(slot.m_queries[query], GL_TIMESTAMP);
+
+	slot.m_timers.push_back({ name, query, UNSET_QUERY });
+}
+
+void GpuProfiler::EndTimer(const char* name)
+{
+	if (!m_enabled || !m_recording)
+		return;
+
+	FrameSlot& slot = m_frameSlots[(m_frameIndex - 1) % NUM_FRAME_SLOTS];
+	auto timer = std::find_if(slot.m_timers.rbegin(), slot.m_timers.rend(),
+		[name](const Timer& entry) { return entry.m_endQuery == UNSET_QUERY && std::strcmp(entry.m_name, name) == 0; });
+
+	if (timer == slot.m_timers.rend())
+		return;
+
+	timer->m_endQuery = this->AcquireQuery(slot);
+	glQueryCounter(slot.m_queries[timer->m_endQuery], GL_TIMESTAMP);
+}
+
+void GpuProfiler::SetEnabled(bool enabled)
+{
+	m_enabled = enabled;
+	if (enabled)
+		return;
+
+	// Anything still waiting on the GPU is dropped, so switching back on doesn't report timings from before
+	m_recording = false;
+	m_timings.clear();
+	for (auto& slot : m_frameSlots)
+		slot.m_pending = false;
+}
+
+void GpuProfiler::SetLogEnabled(bool enabled)
+{
+	m_logEnabled = enabled;
+	m_logAccumulators.clear();
+	m_numLoggedFrames = 0;
+}
+
+const bool& GpuProfiler::IsEnabled() const
+{
+	return m_enabled;
+}
+
+const bool& GpuProfiler::IsLogEnabled() const
+{
+	return m_logEnabled;
+}
+
+const std::vector<GpuTiming>& GpuProfiler::GetTimings() const
+{
+	return m_timings;
+}
+
+float GpuProfiler::GetTime(const char* name) const
+{
+	for (const auto& timing : m_timings)
+	{
+		if (std::strcmp(timing.m_name, name) == 0)
+			return timing.m_time;
+	}
+
+	return -1.0f;
+}
+
+uint32_t GpuProfiler::GetLatency() const
+{
+	return (m_frameIndex > 0) ? m_frameIndex - 1 - m_resolvedFrameIndex : 0;
+}
+
+const uint32_t& GpuProfiler::GetResolvedFrameIndex() const
+{
+	return m_resolvedFrameIndex;
+}
+
+const uint32_t& GpuProfiler::GetNumDroppedFrames() const
+{
+	return m_numDroppedFrames;
+}
\ No newline at end of file
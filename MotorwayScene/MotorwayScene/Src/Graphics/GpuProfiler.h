@@ -0,0 +1,95 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+
+typedef unsigned int uint32_t;
+
+struct GpuTiming
+{
+	const char* m_name;
+	float m_time; // In milliseconds
+};
+
+/*
+	GpuProfiler : Times named stretches of GPU work with pairs of timestamp queries. Each frame's queries go into one slot
+	of a small ring, and a slot is only read back once the driver says its last query is done, so the CPU never waits on
+	the GPU for a result. Timestamps are used over GL_TIME_ELAPSED as only one of those can be running at a time, which
+	would stop the timers overlapping (e.g. a render pass inside the stage it belongs to). If the GPU falls so far behind
+	that the ring wraps around onto a slot that still isn't done, that frame's timings are dropped. The timer names are
+	kept rather than copied, as they're read back frames later, so they have to be string literals or last as long.
+*/
+class GpuProfiler
+{
+private:
+	struct Timer
+	{
+		const char* m_name;
+		uint32_t m_beginQuery, m_endQuery; // Indices into the slot's queries, the end is unset until the timer stops
+	};
+
+	struct FrameSlot
+	{
+		std::vector<GLuint> m_queries; // Kept between uses of the slot, so they're only generated once
+		std::vector<Timer> m_timers;
+		uint32_t m_numQueriesUsed;
+		uint32_t m_frameIndex;
+		bool m_pending;
+	};
+
+	struct LogAccumulator
+	{
+		const char* m_name;
+		double m_totalTime;
+		uint32_t m_numFrames;
+	};
+
+	std::vector<FrameSlot> m_frameSlots;
+	uint32_t m_frameIndex, m_resolvedFrameIndex;
+	uint32_t m_numDroppedFrames;
+	bool m_enabled, m_recording;
+
+	std::vector<GpuTiming> m_timings;
+
+	// Averages of the resolved timings, which are written to the log every so many frames while logging is on
+	bool m_logEnabled;
+	std::vector<LogAccumulator> m_logAccumulators;
+	uint32_t m_numLoggedFrames;
+private:
+	GpuProfiler();
+	~GpuProfiler();
+
+	void ResolveFrames();
+	void ResolveSlot(FrameSlot& slot);
+	void AccumulateLog();
+	uint32_t AcquireQuery(FrameSlot& slot); // Returns the index of a query in the slot, generating one if it has run out
+public:
+	static GpuProfiler* GetPtr();
+
+	// Reads back any earlier frames that have finished, then starts recording this one's timers
+	void BeginFrame();
+
+	/*
+		BeginTimer() : Starts timing the GPU work issued after this call. Timers can overlap or nest, and each is matched
+		to the most recent unstopped timer of the same name.
+		[name] - The name the timing is reported under
+	*/
+	void BeginTimer(const char* name);
+	void EndTimer(const char* name);
+
+	void SetEnabled(bool enabled);
+	void SetLogEnabled(bool enabled);
+public:
+	const bool& IsEnabled() const;
+	const bool& IsLogEnabled() const;
+
+	// The timings of the latest frame the GPU has finished, in the order the timers were started
+	const std::vector<GpuTiming>& GetTimings() const;
+
+	// The latest resolved time of the named timer in milliseconds, or a negative value if it didn't run that frame
+	float GetTime(const char* name) const;
+
+	// How many frames behind the one being recorded the timings are
+	uint32_t GetLatency() const;
+	const uint32_t& GetResolvedFrameIndex() const; // Changes whenever a newer frame has been read back
+	const uint32_t& GetNumDroppedFrames() const;
+};
\ No newline at end of file
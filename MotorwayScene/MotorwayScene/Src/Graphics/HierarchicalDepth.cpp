@@ -0,0 +1,226 @@
+#include "HierarchicalDepth.h"
+#include "Utils/JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Clip-space w is the view depth, so anything closer than the camera's near plane is rejected
+	constexpr float NEAR_CLIP_W = 0.1f;
+	constexpr uint32_t ROWS_PER_JOB = 16;
+
+	float EdgeFunction(const glm::vec3& a, const glm::vec3& b, const glm::vec2& point)
+	{
+		return (b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x);
+	}
+}
+
+HierarchicalDepthBuffer::HierarchicalDepthBuffer(uint32_t width, uint32_t height) :
+	m_width(width), m_height(height)
+{
+	glm::uvec2 levelSize = { width, height };
+	while (true)
+	{
+		m_levelSizes.emplace_back(levelSize);
+		m_levels.emplace_back(levelSize.x * levelSize.y, 1.0f);
+
+		if (levelSize.x == 1 && levelSize.y == 1)
+			break;
+
+		levelSize = glm::max(levelSize / 2u, glm::uvec2(1));
+	}
+}
+
+HierarchicalDepthBuffer::~HierarchicalDepthBuffer() {}
+
+void HierarchicalDepthBuffer::Clear()
+{
+	for (auto& level : m_levels)
+		std::fill(level.begin(), level.end(), 1.0f);
+}
+
+void HierarchicalDepthBuffer::RasterizeOccluders(const glm::vec3* vertices, size_t numVertices, const glm::mat4& vpMatrix)
+{
+	// Project all the triangles into screen space first
+	m_triangles.clear();
+	for (size_t i = 0; i + 2 < numVertices; i += 3)
+	{
+		ScreenTriangle triangle;
+		bool crossesNearPlane = false;
+
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			const glm::vec4 clipPos = vpMatrix * glm::vec4(vertices[i + j], 1.0f);
+			if (clipPos.w < NEAR_CLIP_W)
+			{
+				crossesNearPlane = true;
+				break;
+			}
+
+			const glm::vec3 ndcPos = glm::vec3(clipPos) / clipPos.w;
+			triangle.m_vertices[j] = { (ndcPos.x * 0.5f + 0.5f) * m_width, (ndcPos.y * 0.5f + 0.5f) * m_height,
+				ndcPos.z * 0.5f + 0.5f };
+		}
+
+		if (crossesNearPlane)
+			continue;
+
+		const float minY = std::min({ triangle.m_vertices[0].y, triangle.m_vertices[1].y, triangle.m_vertices[2].y });
+		const float maxY = std::max({ triangle.m_vertices[0].y, triangle.m_vertices[1].y, triangle.m_vertices[2].y });
+		triangle.m_minY = std::max((int)std::floor(minY), 0);
+		triangle.m_maxY = std::min((int)std::ceil(maxY), (int)m_height - 1);
+
+		if (triangle.m_minY <= triangle.m_maxY)
+			m_triangles.emplace_back(triangle);
+	}
+
+	// Each job owns a band of rows, so no two threads ever write to the same texel and the result is deterministic
+	const uint32_t numBands = (m_height + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+	Jobs::ParallelFor(numBands, [this](uint32_t band)
+	{
+		this->RasterizeRows(band * ROWS_PER_JOB, std::min((band + 1) * ROWS_PER_JOB, m_height) - 1);
+	});
+
+	this->BuildHierarchy();
+}
+
+void HierarchicalDepthBuffer::RasterizeRows(uint32_t firstRow, uint32_t lastRow)
+{
+	auto& depthBuffer = m_levels[0];
+
+	for (const auto& triangle : m_triangles)
+	{
+		if (triangle.m_maxY < (int)firstRow || triangle.m_minY > (int)lastRow)
+			continue;
+
+		const glm::vec3& v0 = triangle.m_vertices[0];
+		const glm::vec3& v1 = triangle.m_vertices[1];
+		const glm::vec3& v2 = triangle.m_vertices[2];
+
+		const float area = EdgeFunction(v0, v1, glm::vec2(v2));
+		if (area == 0.0f)
+			continue;
+
+		// Occluders are rasterized double sided, so flip the edges of clockwise triangles
+		const float areaSign = area > 0.0f ? 1.0f : -1.0f;
+		const float invArea = 1.0f / std::abs(area);
+
+		const int minX = std::max((int)std::floor(std::min({ v0.x, v1.x, v2.x })), 0);
+		const int maxX = std::min((int)std::ceil(std::max({ v0.x, v1.x, v2.x })), (int)m_width - 1);
+		const int minY = std::max(triangle.m_minY, (int)firstRow);
+		const int maxY = std::min(triangle.m_maxY, (int)lastRow);
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			for (int x = minX; x <= maxX; x++)
+			{
+				const glm::vec2 pixelCenter = { x + 0.5f, y + 0.5f };
+				const float w0 = EdgeFunction(v1, v2, pixelCenter) * areaSign;
+				const float w1 = EdgeFunction(v2, v0, pixelCenter) * areaSign;
+				const float w2 = EdgeFunction(v0, v1, pixelCenter) * areaSign;
+
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+					continue;
+
+				const float depth = (w0 * v0.z + w1 * v1.z + w2 * v2.z) * invArea;
+				float& storedDepth = depthBuffer[y * m_width + x];
+				storedDepth = std::min(storedDepth, depth);
+			}
+		}
+	}
+}
+
+void HierarchicalDepthBuffer::BuildHierarchy()
+{
+	for (size_t level = 1; level < m_levels.size(); level++)
+	{
+		const auto& prevLevel = m_levels[level - 1];
+		const glm::uvec2& prevSize = m_levelSizes[level - 1];
+		const glm::uvec2& size = m_levelSizes[level];
+
+		for (uint32_t y = 0; y < size.y; y++)
+		{
+			const uint32_t y0 = std::min(y * 2, prevSize.y - 1), y1 = std::min(y * 2 + 1, prevSize.y - 1);
+			for (uint32_t x = 0; x < size.x; x++)
+			{
+				const uint32_t x0 = std::min(x * 2, prevSize.x - 1), x1 = std::min(x * 2 + 1, prevSize.x - 1);
+
+				m_levels[level][y * size.x + x] = std::max({ prevLevel[y0 * prevSize.x + x0], 
+					prevLevel[y0 * prevSize.x + x1], prevLevel[y1 * prevSize.x + x0], prevLevel[y1 * prevSize.x + x1] });
+			}
+		}
+	}
+}
+
+bool HierarchicalDepthBuffer::IsVisible(const BoundingBox& worldBounds, const glm::mat4& vpMatrix) const
+{
+	glm::vec2 minScreen(std::numeric_limits<float>::max()), maxScreen(std::numeric_limits<float>::lowest());
+	float minDepth = 1.0f;
+
+	for (const auto& corner : Bounds::GetCorners(worldBounds, glm::mat4(1.0f)))
+	{
+		const glm::vec4 clipPos = vpMatrix * glm::vec4(corner, 1.0f);
+		if (clipPos.w < NEAR_CLIP_W)
+			return true; // The box is touching the camera so it can't be hidden
+
+		const glm::vec3 ndcPos = glm::vec3(clipPos) / clipPos.w;
+		const glm::vec2 screenPos = { (ndcPos.x * 0.5f + 0.5f) * m_width, (ndcPos.y * 0.5f + 0.5f) * m_height };
+
+		minScreen = glm::min(minScreen, screenPos);
+		maxScreen = glm::max(maxScreen, screenPos);
+		minDepth = std::min(minDepth, ndcPos.z * 0.5f + 0.5f);
+	}
+
+	if (maxScreen.x < 0.0f || maxScreen.y < 0.0f || minScreen.x >= m_width || minScreen.y >= m_height)
+		return false;
+
+	if (minDepth <= 0.0f)
+		return true;
+
+	minScreen = glm::clamp(minScreen, glm::vec2(0.0f), glm::vec2(m_width - 1, m_height - 1));
+	maxScreen = glm::clamp(maxScreen, glm::vec2(0.0f), glm::vec2(m_width - 1, m_height - 1));
+
+	// Pick the level where the box covers roughly 2x2 texels, so only a handful of texels need checking
+	const float largestExtent = std::max(maxScreen.x - minScreen.x, maxScreen.y - minScreen.y);
+	const uint32_t level = std::min((uint32_t)std::max(std::ceil(std::log2(std::max(largestExtent, 1.0f))) - 1.0f, 0.0f),
+		this->GetNumLevels() - 1);
+
+	const glm::uvec2& levelSize = m_levelSizes[level];
+	const uint32_t minX = std::min((uint32_t)minScreen.x >> level, levelSize.x - 1);
+	const uint32_t maxX = std::min((uint32_t)maxScreen.x >> level, levelSize.x - 1);
+	const uint32_t minY = std::min((uint32_t)minScreen.y >> level, levelSize.y - 1);
+	const uint32_t maxY = std::min((uint32_t)maxScreen.y >> level, levelSize.y - 1);
+
+	for (uint32_t y = minY; y <= maxY; y++)
+	{
+		for (uint32_t x = minX; x <= maxX; x++)
+		{
+			if (minDepth <= m_levels[level][y * levelSize.x + x])
+				return true;
+		}
+	}
+
+	return false;
+}
+
+const uint32_t& HierarchicalDepthBuffer::GetWidth() const
+{
+	return m_width;
+}
+
+const uint32_t& HierarchicalDepthBuffer::GetHeight() const
+{
+	return m_height;
+}
+
+uint32_t HierarchicalDepthBuffer::GetNumLevels() const
+{
+	return (uint32_t)m_levels.size();
+}
+
+float HierarchicalDepthBuffer::GetDepth(uint32_t x, uint32_t y, uint32_t level) const
+{
+	return m_levels[level][y * m_levelSizes[level].x + x];
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "Graphics/BoundingBox.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+typedef unsigned int uint32_t;
+
+/*
+	HierarchicalDepthBuffer : A small CPU depth buffer which occluder geometry is rasterized into, so that bounding boxes
+	can be tested against it without touching the GPU. Depth values are stored in the [0, 1] range where 1 is the far
+	plane, and every level after the first stores the farthest depth of the 2x2 texels beneath it.
+*/
+class HierarchicalDepthBuffer
+{
+private:
+	struct ScreenTriangle
+	{
+		glm::vec3 m_vertices[3]; // The x and y components are in pixels, the z component is the depth
+		int m_minY, m_maxY;
+	};
+
+	uint32_t m_width, m_height;
+	std::vector<std::vector<float>> m_levels;
+	std::vector<glm::uvec2> m_levelSizes;
+
+	std::vector<ScreenTriangle> m_triangles;
+private:
+	void RasterizeRows(uint32_t firstRow, uint32_t lastRow);
+	void BuildHierarchy();
+public:
+	HierarchicalDepthBuffer(uint32_t width, uint32_t height);
+	~HierarchicalDepthBuffer();
+
+	void Clear();
+
+	// Every 3 vertices given make up an occluder triangle, triangles which cross the near plane are skipped
+	void RasterizeOccluders(const glm::vec3* vertices, size_t numVertices, const glm::mat4& vpMatrix);
+	
+	// Returns false only when the whole box is behind the rasterized occluders
+	bool IsVisible(const BoundingBox& worldBounds, const glm::mat4& vpMatrix) const;
+public:
+	const uint32_t& GetWidth() const;
+	const uint32_t& GetHeight() const;
+	uint32_t GetNumLevels() const;
+
+	float GetDepth(uint32_t x, uint32_t y, uint32_t level = 0) const;
+};
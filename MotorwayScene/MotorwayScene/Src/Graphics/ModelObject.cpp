@@ -3,9 +3,11 @@
 #include "Graphics/TextureComponent.h"
 #include "Utils/ResourceManager.h"
 #include "Utils/LoggingManager.h"
+#include "Utils/Profiler.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <algorithm>
 
 namespace Instancing
 {
@@ -16,9 +18,17 @@ namespace Instancing
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Mesh::Mesh(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices, Material material,
-	const glm::mat4* instancedData, size_t numInstances) :
-	m_material(material), m_numIndices(indices.size()), m_numInstances(numInstances)
+	const glm::mat4* instancedData, size_t numInstances, bool positionStream) :
+	m_material(material), m_numIndices(indices.size()), m_numInstances(numInstances), m_numVisible(0),
+	m_meshBinding({ nullptr, 0 }), m_depthBinding({ nullptr, 0 })
 {
+	m_bounds = { vertices[0].m_position, vertices[0].m_position };
+	for (const auto& vertex : vertices)
+	{
+		m_bounds.m_min = glm::min(m_bounds.m_min, vertex.m_position);
+		m_bounds.m_max = glm::max(m_bounds.m_max, vertex.m_position);
+	}
+
 	m_meshVBO = Buffer::GenerateVBO(&vertices[0], sizeof(VertexData) * vertices.size(), GL_STATIC_DRAW);
 	m_meshIBO = Buffer::GenerateIBO(&indices[0], sizeof(uint32_t) * indices.size(), GL_STATIC_DRAW);
 
@@ -29,90 +39,297 @@ Mesh::Mesh(const std::vector<VertexData>& vertices, const std::vector<uint32_t>&
 
 	m_meshVAO->AttachBufferObjects(m_meshVBO, m_meshIBO);
 
+	if (positionStream)
+	{
+		std::vector<glm::vec3> positions;
+		positions.reserve(vertices.size());
+		for (const auto& vertex : vertices)
+			positions.emplace_back(vertex.m_position);
+
+		// The index buffer is shared, only the vertex fetch differs
+		m_positionVBO = Buffer::GenerateVBO(&positions[0], sizeof(glm::vec3) * positions.size(), GL_STATIC_DRAW);
+		m_depthVAO = Buffer::GenerateVAO();
+		m_depthVAO->PushAttribLayout<float>(0, 3, sizeof(glm::vec3));
+		m_depthVAO->AttachBufferObjects(m_positionVBO, m_meshIBO);
+	}
+
 	if (instancedData)
 	{
-		m_instancedVBO = Buffer::GenerateVBO(instancedData, numInstances * sizeof(glm::mat4), GL_STATIC_DRAW);
+		m_instancedVBO = Buffer::GenerateVBO(instancedData, numInstances * sizeof(glm::mat4), GL_STATIC_DRAW,
+			GpuMemoryCategory::INSTANCE);
+		this->BindInstanceBuffer(m_instancedVBO, 0, false);
+	}
+}
 
-		m_meshVAO->PushAttribLayout<float>(3, 4, sizeof(glm::mat4), 0, 1);
-		m_meshVAO->PushAttribLayout<float>(4, 4, sizeof(glm::mat4), sizeof(glm::vec4), 1);
-		m_meshVAO->PushAttribLayout<float>(5, 4, sizeof(glm::mat4), 2 * sizeof(glm::vec4), 1);
-		m_meshVAO->PushAttribLayout<float>(6, 4, sizeof(glm::mat4), 3 * sizeof(glm::vec4), 1);
+Mesh::~Mesh() {}
+
+void Mesh::SetLabel(const std::string& label)
+{
+	m_label = label;
+
+	m_meshVBO->SetLabel(label + " vertices");
+	m_meshIBO->SetLabel(label + " indices");
+	m_meshVAO->SetLabel(label);
 
-		m_meshVAO->AttachBufferObjects(m_instancedVBO);
+	if (m_positionVBO)
+	{
+		m_positionVBO->SetLabel(label + " positions");
+		m_depthVAO->SetLabel(label + " depth");
 	}
+
+	if (m_instancedVBO)
+		m_instancedVBO->SetLabel(label + " instances");
 }
 
-Mesh::~Mesh() {}
+void Mesh::BindInstanceBuffer(std::shared_ptr<VertexBuffer> instanceVBO, size_t firstInstance, bool depthOnly) const
+{
+	const bool useDepthVAO = (depthOnly && m_depthVAO);
+	const auto& vertexArray = useDepthVAO ? m_depthVAO : m_meshVAO;
+	InstanceBinding& binding = useDepthVAO ? m_depthBinding : m_meshBinding;
+
+	if (binding.m_buffer == instanceVBO.get() && binding.m_firstInstance == firstInstance)
+		return;
+
+	// GL 3.3 has no base instance draws, so a range of instances is drawn by offsetting the attributes instead
+	const GLsizei baseOffset = (GLsizei)(firstInstance * sizeof(glm::mat4));
+	vertexArray->PushAttribLayout<float>(3, 4, sizeof(glm::mat4), baseOffset, 1);
+	vertexArray->PushAttribLayout<float>(4, 4, sizeof(glm::mat4), baseOffset + sizeof(glm::vec4), 1);
+	vertexArray->PushAttribLayout<float>(5, 4, sizeof(glm::mat4), baseOffset + 2 * sizeof(glm::vec4), 1);
+	vertexArray->PushAttribLayout<float>(6, 4, sizeof(glm::mat4), baseOffset + 3 * sizeof(glm::vec4), 1);
+
+	vertexArray->AttachBufferObjects(instanceVBO);
+	binding.m_buffer = instanceVBO.get();
+	binding.m_firstInstance = firstInstance;
+}
+
+void Mesh::SetInstances(const glm::mat4* instancedData, size_t numInstances) const
+{
+	if (!m_instancedVBO)
+		return;
+
+	// The buffer keeps its name, so the vertex arrays and the instance fetch still point at it
+	m_numInstances = numInstances;
+	m_instancedVBO->ReallocateData(instancedData, numInstances * sizeof(glm::mat4), GL_STATIC_DRAW);
 
-void Mesh::DrawMesh(const std::string& structUniform) const
+	// The visible set is sized from the instance count the next time it's filled
+	m_numVisible = 0;
+}
+
+void Mesh::SetVisibleInstances(const glm::mat4* instancedData, size_t numInstances) const
 {
+	if (!m_instancedVBO)
+		return;
+
+	if (!m_visibleVBO)
+	{
+		m_visibleVBO = Buffer::GenerateVBO(nullptr, m_numInstances * sizeof(glm::mat4), GL_STREAM_DRAW, 
+			GpuMemoryCategory::INSTANCE);
+		m_visibleVBO->SetLabel(m_label + " visible instances");
+	}
+
+	// Orphan the old storage first so the upload doesn't have to wait on last frame's draws
+	m_numVisible = std::min(numInstances, m_numInstances);
+	m_visibleVBO->ReallocateData(nullptr, m_numInstances * sizeof(glm::mat4), GL_STREAM_DRAW);
+	if (m_numVisible > 0)
+		m_visibleVBO->ModifySubData(instancedData, 0, m_numVisible * sizeof(glm::mat4));
+}
+
+void Mesh::DrawMesh(const std::string& structUniform, InstanceSource source) const
+{
+	if (source == InstanceSource::VISIBLE && m_visibleVBO && m_numVisible == 0)
+		return;
+
+	this->BindMaterial(structUniform);
+	this->DrawElements(source, false);
+}
+
+void Mesh::DrawDepth(InstanceSource source) const
+{
+	this->DrawElements(source, true);
+}
+
+void Mesh::DrawElements(InstanceSource source, bool depthOnly) const
+{
+	const bool drawVisibleSet = (source == InstanceSource::VISIBLE && m_visibleVBO);
+	if (drawVisibleSet && m_numVisible == 0)
+		return;
+
+	auto currentShader = ShaderManager::GetPtr()->GetBoundShader();
+	const auto& vertexArray = (depthOnly && m_depthVAO) ? m_depthVAO : m_meshVAO;
+
+	if (m_numInstances > 0)
+	{
+		this->BindInstanceBuffer(drawVisibleSet ? m_visibleVBO : m_instancedVBO, 0, depthOnly);
+		vertexArray->BindVertexArray();
+
+		currentShader->SetUniform("usingInstancing", true);
+		glDrawElementsInstanced(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr, 
+			drawVisibleSet ? m_numVisible : m_numInstances);
+	}
+	else
+	{
+		vertexArray->BindVertexArray();
+		glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr);
+	}
+
+	currentShader->SetUniform("usingInstancing", false);
+}
+
+const Mesh::MaterialUniforms& Mesh::GetMaterialUniforms(const std::string& structUniform) const
+{
+	for (const auto& uniforms : m_materialUniforms)
+	{
+		if (uniforms.m_structUniform == structUniform)
+			return uniforms;
+	}
+
 	const std::string UNIFORM_PREFIX = structUniform + ".";
+
+	MaterialUniforms uniforms;
+	uniforms.m_structUniform = structUniform;
+	uniforms.m_useTextures = UNIFORM_PREFIX + "useTextures";
+	uniforms.m_renderingModel = UNIFORM_PREFIX + "renderingModel";
+	uniforms.m_shininess = UNIFORM_PREFIX + "shininess";
+	uniforms.m_ambient = UNIFORM_PREFIX + "ambient";
+	uniforms.m_diffuse = UNIFORM_PREFIX + "diffuse";
+	uniforms.m_specular = UNIFORM_PREFIX + "specular";
+	uniforms.m_useSpecularMap = UNIFORM_PREFIX + "useSpecularMap";
+
+	int numDiffuse = 0, numSpecular = 0;
+	for (const auto& texture : m_material.m_textures)
+	{
+		if (texture.m_type == TextureType::DIFFUSE)
+			uniforms.m_samplers.emplace_back(UNIFORM_PREFIX + "diffuseTexture" + std::to_string(numDiffuse++));
+		else
+			uniforms.m_samplers.emplace_back(UNIFORM_PREFIX + "specularTexture" + std::to_string(numSpecular++));
+	}
+
+	m_materialUniforms.emplace_back(std::move(uniforms));
+	return m_materialUniforms.back();
+}
+
+void Mesh::BindMaterial(const std::string& structUniform, uint32_t firstUnit) const
+{
+	const MaterialUniforms& uniforms = this->GetMaterialUniforms(structUniform);
 	const auto& MESH_TEXTURES = m_material.m_textures;
 	auto currentShader = ShaderManager::GetPtr()->GetBoundShader();
 
-	currentShader->SetUniform(UNIFORM_PREFIX + "useTextures", !MESH_TEXTURES.empty());
-	currentShader->SetUniform(UNIFORM_PREFIX + "renderingModel", true);
-	currentShader->SetUniform(UNIFORM_PREFIX + "shininess", m_material.m_shininess);
+	currentShader->SetUniform(uniforms.m_useTextures, !MESH_TEXTURES.empty());
+	currentShader->SetUniform(uniforms.m_renderingModel, true);
+	currentShader->SetUniform(uniforms.m_shininess, m_material.m_shininess);
 
 	if (MESH_TEXTURES.empty())
 	{
-		currentShader->SetUniform(UNIFORM_PREFIX + "ambient", m_material.m_ambient);
-		currentShader->SetUniform(UNIFORM_PREFIX + "diffuse", m_material.m_diffuse);
-		currentShader->SetUniform(UNIFORM_PREFIX + "specular", m_material.m_specular);
+		currentShader->SetUniform(uniforms.m_ambient, m_material.m_ambient);
+		currentShader->SetUniform(uniforms.m_diffuse, m_material.m_diffuse);
+		currentShader->SetUniform(uniforms.m_specular, m_material.m_specular);
 	}
 	else
 	{
 		bool usingSpecularMap = false;
-		int numDiffuse = 0, numSpecular = 0;
-
 		for (size_t i = 0; i < MESH_TEXTURES.size(); i++)
 		{
-			if (MESH_TEXTURES[i].m_type == TextureType::DIFFUSE)
-				MESH_TEXTURES[i].m_component->BindTexture(UNIFORM_PREFIX + "diffuseTexture" + std::to_string(numDiffuse++), i);
-			else if (MESH_TEXTURES[i].m_type == TextureType::SPECULAR)
-			{
-				usingSpecularMap = true;
-				MESH_TEXTURES[i].m_component->BindTexture(UNIFORM_PREFIX + "specularTexture" + std::to_string(numSpecular++), i);
-			}
+			usingSpecularMap |= (MESH_TEXTURES[i].m_type == TextureType::SPECULAR);
+			MESH_TEXTURES[i].m_component->BindTexture(uniforms.m_samplers[i], firstUnit + (uint32_t)i);
 		}
 
 		if (!usingSpecularMap)
-			currentShader->SetUniform(UNIFORM_PREFIX + "specular", m_material.m_specular);
+			currentShader->SetUniform(uniforms.m_specular, m_material.m_specular);
 
-		currentShader->SetUniform(UNIFORM_PREFIX + "useSpecularMap", usingSpecularMap);
+		currentShader->SetUniform(uniforms.m_useSpecularMap, usingSpecularMap);
 	}
+}
 
-	m_meshVAO->BindVertexArray();
-	if (m_numInstances > 0)
+void Mesh::DrawInstances(size_t firstInstance, size_t numInstances, bool depthOnly) const
+{
+	if (!m_instancedVBO || numInstances == 0 || firstInstance >= m_numInstances)
+		return;
+
+	this->BindInstanceBuffer(m_instancedVBO, firstInstance, depthOnly);
+	((depthOnly && m_depthVAO) ? m_depthVAO : m_meshVAO)->BindVertexArray();
+	glDrawElementsInstanced(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr, 
+		std::min(numInstances, m_numInstances - firstInstance));
+}
+
+void Mesh::BindVertexFetch(InstanceSource source, uint32_t firstUnit) const
+{
+	if (!m_vertexFetch)
 	{
-		currentShader->SetUniform("usingInstancing", true);
-		glDrawElementsInstanced(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr, m_numInstances);
+		m_vertexFetch = Buffer::GenerateBufferTexture(GL_RGBA32F);
+		m_vertexFetch->AttachBuffer(m_meshVBO->GetID());
+
+		m_indexFetch = Buffer::GenerateBufferTexture(GL_R32UI);
+		m_indexFetch->AttachBuffer(m_meshIBO->GetID());
+
+		m_instanceFetch = Buffer::GenerateBufferTexture(GL_RGBA32F);
+
+		m_vertexFetch->SetLabel(m_label + " vertex fetch");
+		m_indexFetch->SetLabel(m_label + " index fetch");
+		m_instanceFetch->SetLabel(m_label + " instance fetch");
 	}
-	else
-		glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr);
 
-	currentShader->SetUniform("usingInstancing", false);
+	m_vertexFetch->BindBuffer("meshVertices", firstUnit);
+	m_indexFetch->BindBuffer("meshIndices", firstUnit + 1);
+
+	if (m_instancedVBO)
+	{
+		const bool drawVisibleSet = (source == InstanceSource::VISIBLE && m_visibleVBO);
+		m_instanceFetch->AttachBuffer(drawVisibleSet ? m_visibleVBO->GetID() : m_instancedVBO->GetID());
+		m_instanceFetch->BindBuffer("meshInstances", firstUnit + 2);
+	}
+}
+
+const BoundingBox& Mesh::GetBounds() const
+{
+	return m_bounds;
+}
+
+uint32_t Mesh::GetNumTriangles() const
+{
+	return m_numIndices / 3;
+}
+
+size_t Mesh::GetNumInstances() const
+{
+	return m_numInstances;
+}
+
+const size_t& Mesh::GetNumVisible() const
+{
+	return m_numVisible;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Model::Model() :
-	m_path(""), m_textureDir(""), m_shininess(64.0f)
+	m_path(""), m_textureDir(""), m_shininess(64.0f), m_positionStream(false), 
+	m_bounds({ glm::vec3(0.0f), glm::vec3(0.0f) })
 {}
 
 Model::Model(const std::string& path, const std::string& textureDir, float shininess, const glm::mat4* instancedData, 
-	size_t numInstances) :
-	m_path(path), m_textureDir(textureDir), m_shininess(shininess)
+	size_t numInstances, bool positionStream) :
+	m_path(path), m_textureDir(textureDir), m_shininess(shininess), m_positionStream(positionStream), 
+	m_bounds({ glm::vec3(0.0f), glm::vec3(0.0f) })
 {
+	PROFILE_ZONE("Model::Import");
+
 	Instancing::instancedData = instancedData;
 	Instancing::numInstances = numInstances;
 
 	Assimp::Importer modelImporter;
-	const aiScene* modelScene = modelImporter.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+	const aiScene* modelScene = nullptr;
+	{
+		PROFILE_ZONE("Assimp::ReadFile");
+		modelScene = modelImporter.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+	}
+
 	if (!modelScene || modelScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !modelScene->mRootNode)
 		OutputLog("Failed to load model: " + path, Logging::Severity::FATAL);
 	else
+	{
+		PROFILE_ZONE("Model::ProcessNode");
 		this->ProcessNode(modelScene->mRootNode, modelScene);
+	}
 }
 
 Model::~Model() {}
@@ -120,7 +337,11 @@ Model::~Model() {}
 void Model::ProcessNode(aiNode* node, const aiScene* modelScene)
 {
 	for (size_t i = 0; i < node->mNumMeshes; i++)
+	{
 		m_meshes.emplace_back(this->GenerateMesh(modelScene->mMeshes[node->mMeshes[i]], modelScene));
+		m_meshes.back().SetLabel(m_path + " mesh " + std::to_string(m_meshes.size() - 1));
+		m_bounds = (m_meshes.size() == 1) ? m_meshes.back().GetBounds() : Bounds::Merge(m_bounds, m_meshes.back().GetBounds());
+	}
 
 	for (size_t i = 0; i < node->mNumChildren; i++)
 		this->ProcessNode(node->mChildren[i], modelScene);
@@ -195,7 +416,7 @@ Mesh Model::GenerateMesh(aiMesh* mesh, const aiScene* modelScene) const
 		material.m_shininess = m_shininess;
 	}
 
-	return Mesh(vertices, indices, material, Instancing::instancedData, Instancing::numInstances);
+	return Mesh(vertices, indices, material, Instancing::instancedData, Instancing::numInstances, m_positionStream);
 }
 
 std::vector<Texture> Model::GetMaterialTextures(aiMaterial* mat, aiTextureType textureType) const
@@ -245,10 +466,38 @@ Material Model::GetGenericMaterial(aiMaterial* mat) const
 	return material;
 }
 
-void Model::DrawModel(const std::string& structUniform) const
+void Model::SetInstances(const glm::mat4* instancedData, size_t numInstances) const
+{
+	for (auto& mesh : m_meshes)
+		mesh.SetInstances(instancedData, numInstances);
+}
+
+void Model::SetVisibleInstances(const glm::mat4* instancedData, size_t numInstances) const
+{
+	for (auto& mesh : m_meshes)
+		mesh.SetVisibleInstances(instancedData, numInstances);
+}
+
+void Model::DrawModel(const std::string& structUniform, InstanceSource source) const
 {
 	for (auto& mesh : m_meshes)
-		mesh.DrawMesh(structUniform);
+		mesh.DrawMesh(structUniform, source);
+}
+
+void Model::DrawModelDepth(InstanceSource source) const
+{
+	for (auto& mesh : m_meshes)
+		mesh.DrawDepth(source);
+}
+
+const std::vector<Mesh>& Model::GetMeshes() const
+{
+	return m_meshes;
+}
+
+const BoundingBox& Model::GetBounds() const
+{
+	return m_bounds;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
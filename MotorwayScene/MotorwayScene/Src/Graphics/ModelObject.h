@@ -4,10 +4,12 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include <assimp/scene.h>
+#include "Graphics/BoundingBox.h"
 
 class VertexBuffer;
 class IndexBuffer;
 class VertexArray;
+class BufferTexture;
 class TextureComponent;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -18,6 +20,12 @@ enum class TextureType
 	SPECULAR
 };
 
+enum class InstanceSource
+{
+	ALL,	// Every instance the mesh was loaded with
+	VISIBLE	// Only the instances which survived the last culling pass
+};
+
 struct Texture
 {
 	TextureType m_type;
@@ -48,17 +56,85 @@ private:
 	std::shared_ptr<IndexBuffer> m_meshIBO;
 	std::shared_ptr<VertexArray> m_meshVAO;
 
+	// Optional tightly packed copy of the positions, so depth only passes don't fetch the normals and texture coords
+	std::shared_ptr<VertexBuffer> m_positionVBO;
+	std::shared_ptr<VertexArray> m_depthVAO;
+
 	std::shared_ptr<VertexBuffer> m_instancedVBO;
-	size_t m_numInstances;
+	mutable size_t m_numInstances;
+
+	mutable std::shared_ptr<VertexBuffer> m_visibleVBO;
+	mutable size_t m_numVisible;
+
+	struct InstanceBinding
+	{
+		const VertexBuffer* m_buffer; // The buffer the instance attributes currently point to
+		size_t m_firstInstance;
+	};
+
+	mutable InstanceBinding m_meshBinding, m_depthBinding;
+
+	// Views of the vertex, index and instance buffers for shaders which fetch the attributes themselves
+	mutable std::shared_ptr<BufferTexture> m_vertexFetch, m_indexFetch, m_instanceFetch;
 	
 	Material m_material;
+
+	// The full names of the material's uniforms, built the first time the material is bound to a given struct so the
+	// draws don't put them together again every frame
+	struct MaterialUniforms
+	{
+		std::string m_structUniform;
+		std::string m_useTextures, m_renderingModel, m_shininess, m_ambient, m_diffuse, m_specular, m_useSpecularMap;
+		std::vector<std::string> m_samplers; // One for each of the material's textures, in the same order
+	};
+
+	mutable std::vector<MaterialUniforms> m_materialUniforms;
+
 	uint32_t m_numIndices;
+	std::string m_label;
+	BoundingBox m_bounds;
+private:
+	void BindInstanceBuffer(std::shared_ptr<VertexBuffer> instanceVBO, size_t firstInstance, bool depthOnly) const;
+	void DrawElements(InstanceSource source, bool depthOnly) const;
+	const MaterialUniforms& GetMaterialUniforms(const std::string& structUniform) const;
 public:
 	Mesh(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices, Material material,
-		const glm::mat4* instancedData = nullptr, size_t numInstances = 0); // The instancedData is supposed to be an array of model matrices
+		const glm::mat4* instancedData = nullptr, size_t numInstances = 0, // The instancedData is supposed to be an array of model matrices
+		bool positionStream = false);
 	~Mesh();
 
-	void DrawMesh(const std::string& structUniform) const;
+	// Names the mesh's buffers in the driver's debug messages, including the ones made later on
+	void SetLabel(const std::string& label);
+
+	// Replaces every instance in place, the mesh must have been loaded with instances for there to be a buffer to refill
+	void SetInstances(const glm::mat4* instancedData, size_t numInstances) const;
+
+	// Replaces the instances drawn when using InstanceSource::VISIBLE, numInstances can't exceed the loaded instance count
+	void SetVisibleInstances(const glm::mat4* instancedData, size_t numInstances) const;
+	void DrawMesh(const std::string& structUniform, InstanceSource source = InstanceSource::ALL) const;
+
+	// Draws without binding the material, using the position stream if the mesh was loaded with one
+	void DrawDepth(InstanceSource source = InstanceSource::ALL) const;
+
+	// Lower level drawing, used when the same material is drawn many times with different ranges of instances.
+	// The "usingInstancing" uniform must be set by the caller before calling DrawInstances().
+	// The material's textures are bound to consecutive units starting from firstUnit.
+	void BindMaterial(const std::string& structUniform, uint32_t firstUnit = 0) const;
+	void DrawInstances(size_t firstInstance, size_t numInstances, bool depthOnly = false) const;
+
+	/*
+		BindVertexFetch() : Binds the mesh's buffers as buffer textures to the bound shader, for shaders that rebuild the
+		attributes of a triangle themselves. The vertices are 2 RGBA32F texels each (position and normal x, then normal yz
+		and texture coord), the indices are R32UI and the instances are 4 RGBA32F texels each.
+		[source] - Which instance buffer to bind, matching the one the instance IDs were drawn with
+		[firstUnit] - "meshVertices", "meshIndices" and "meshInstances" are bound to this unit and the two after it
+	*/
+	void BindVertexFetch(InstanceSource source, uint32_t firstUnit) const;
+public:
+	const BoundingBox& GetBounds() const; // The bounds are in model space
+	uint32_t GetNumTriangles() const;
+	size_t GetNumInstances() const;
+	const size_t& GetNumVisible() const; // The instances drawn with InstanceSource::VISIBLE
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -68,8 +144,10 @@ class Model
 private:
 	std::vector<Mesh> m_meshes;
 	const std::string m_path, m_textureDir;
+	BoundingBox m_bounds;
 
 	const float m_shininess;
+	const bool m_positionStream;
 private:
 	void ProcessNode(aiNode* node, const aiScene* modelScene);
 
@@ -78,12 +156,19 @@ private:
 	Material GetGenericMaterial(aiMaterial* mat) const; // Returns material that doesn't include texture maps
 public:
 	// The texture directory string must end with a back/forward slash
+	// The position stream is an extra position only copy of the vertices which speeds up the depth only passes
 	Model();
 	Model(const std::string& path, const std::string& textureDir, float shininess = 64.0f,
-		const glm::mat4* instancedData = nullptr, size_t numInstances = 0);
+		const glm::mat4* instancedData = nullptr, size_t numInstances = 0, bool positionStream = false);
 	~Model();
 
-	void DrawModel(const std::string& structUniform) const;
+	void SetInstances(const glm::mat4* instancedData, size_t numInstances) const;
+	void SetVisibleInstances(const glm::mat4* instancedData, size_t numInstances) const;
+	void DrawModel(const std::string& structUniform, InstanceSource source = InstanceSource::ALL) const;
+	void DrawModelDepth(InstanceSource source = InstanceSource::ALL) const;
+public:
+	const std::vector<Mesh>& GetMeshes() const;
+	const BoundingBox& GetBounds() const; // The bounds enclosing every mesh, in model space
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -42,6 +42,9 @@ void ObjectRenderer::InitQuadObject()
 	m_quadVAO->PushAttribLayout<float>(2, 2, 2 * sizeof(float), m_quadBufferSize - TEXTURE_COORD_SIZE);
 
 	m_quadVAO->AttachBufferObjects(m_quadVBO);
+
+	m_quadVBO->SetLabel("Quad vertices");
+	m_quadVAO->SetLabel("Quad");
 }
 
 void ObjectRenderer::InitCubeObject()
@@ -161,6 +164,9 @@ void ObjectRenderer::InitCubeObject()
 	m_cubeVAO->PushAttribLayout<float>(2, 2, 2 * sizeof(float), m_cubeBufferSize - TEXTURE_COORD_SIZE);
 
 	m_cubeVAO->AttachBufferObjects(m_cubeVBO);
+
+	m_cubeVBO->SetLabel("Cube vertices");
+	m_cubeVAO->SetLabel("Cube");
 }
 
 ObjectRenderer* ObjectRenderer::GetPtr()
@@ -170,9 +176,9 @@ ObjectRenderer* ObjectRenderer::GetPtr()
 }
 
 void ObjectRenderer::LoadModel(const std::string& key, const std::string& modelPath, const std::string& textureDir,
-	float shininess, const glm::mat4* instancedData, size_t numInstances)
+	float shininess, const glm::mat4* instancedData, size_t numInstances, bool positionStream)
 {
-	Resource::LoadModel(key, modelPath, textureDir, shininess, instancedData, numInstances);
+	Resource::LoadModel(key, modelPath, textureDir, shininess, instancedData, numInstances, positionStream);
 }
 
 void ObjectRenderer::RenderQuad(int textureRepeatX, int textureRepeatY) const
@@ -325,7 +331,12 @@ void ObjectRenderer::RenderCube(int textureRepeatX, int textureRepeatY, int text
 	glDrawArrays(GL_TRIANGLES, 0, 36);
 }
 
-void ObjectRenderer::RenderModel(const std::string& key, const std::string& structUniform) const
+void ObjectRenderer::RenderModel(const std::string& key, const std::string& structUniform, InstanceSource source) const
+{
+	Resource::GetModel(key)->DrawModel(structUniform, source);
+}
+
+void ObjectRenderer::RenderModelDepth(const std::string& key, InstanceSource source) const
 {
-	Resource::GetModel(key)->DrawModel(structUniform);
+	Resource::GetModel(key)->DrawModelDepth(source);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <memory>
 #include <string>
 #include <glm/glm.hpp>
+#include "Graphics/ModelObject.h"
 
 class VertexBuffer;
 class VertexArray;
@@ -26,9 +27,12 @@ public:
 	static ObjectRenderer* GetPtr();
 
 	void LoadModel(const std::string& key, const std::string& modelPath, const std::string& textureDir = "", 
-		float shininess = 64.0f, const glm::mat4 * instancedData = nullptr, size_t numInstances = 0);
+		float shininess = 64.0f, const glm::mat4 * instancedData = nullptr, size_t numInstances = 0, 
+		bool positionStream = false);
 
 	void RenderQuad(int textureRepeatX = 1, int textureRepeatY = 1) const;
 	void RenderCube(int textureRepeatX = 1, int textureRepeatY = 1, int textureRepeatZ = 1) const;
-	void RenderModel(const std::string& key, const std::string& structUniform) const;
+	void RenderModel(const std::string& key, const std::string& structUniform, 
+		InstanceSource source = InstanceSource::ALL) const;
+	void RenderModelDepth(const std::string& key, InstanceSource source = InstanceSource::ALL) const; // For depth only programs
 };
\ No newline at end of file
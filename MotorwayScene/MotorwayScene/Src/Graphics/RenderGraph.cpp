@@ -0,0 +1,453 @@
+#include "RenderGraph.h"
+#include "Graphics/BufferObjects.h"
+#include "Graphics/GLDebug.h"
+#include "Graphics/GpuMemory.h"
+#include "Graphics/GpuProfiler.h"
+#include "Utils/LoggingManager.h"
+#include "Utils/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	// How many frames a pooled texture can go unused before it's freed
+	constexpr uint32_t EVICT_AFTER_FRAMES = 120;
+
+	size_t GetTextureBytes(const TransientTextureDesc& desc)
+	{
+		return GpuMemory::GetTextureBytes(desc.m_width, desc.m_height, desc.m_internalFormat) *
+			std::max(desc.m_samples, 1u);
+	}
+}
+
+bool TransientTextureDesc::operator==(const TransientTextureDesc& other) const
+{
+	return m_width == other.m_width && m_height == other.m_height && m_internalFormat == other.m_internalFormat &&
+		m_format == other.m_format && m_type == other.m_type && m_samples == other.m_samples;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+RenderPassBuilder::RenderPassBuilder(RenderGraph* graph, uint32_t passIndex) :
+	m_graph(graph), m_passIndex(passIndex)
+{}
+
+RenderResource RenderPassBuilder::CreateTexture(const char* name, const TransientTextureDesc& desc)
+{
+	RenderGraph::ResourceNode resource;
+	resource.m_name = name;
+	resource.m_desc = desc;
+	resource.m_imported = resource.m_isRenderbuffer = false;
+	resource.m_version = 0;
+	resource.m_firstPass = resource.m_lastPass = -1;
+
+	m_graph->m_resources.emplace_back(resource);
+	return (RenderResource)(m_graph->m_resources.size() - 1);
+}
+
+RenderResource RenderPassBuilder::CreateRenderbuffer(const char* name, const TransientTextureDesc& desc)
+{
+	const RenderResource resource = this->CreateTexture(name, desc);
+	m_graph->m_resources[resource].m_isRenderbuffer = true;
+
+	return resource;
+}
+
+void RenderPassBuilder::Read(RenderResource resource)
+{
+	m_graph->m_passes[m_passIndex].m_reads.emplace_back(resource, m_graph->m_resources[resource].m_version);
+}
+
+void RenderPassBuilder::Write(RenderResource resource, GLenum attachment)
+{
+	auto& node = m_graph->m_resources[resource];
+	auto& pass = m_graph->m_passes[m_passIndex];
+
+	pass.m_writes.emplace_back(resource, ++node.m_version);
+	if (attachment != GL_NONE)
+		pass.m_attachments.emplace_back(resource, attachment);
+}
+
+void RenderPassBuilder::KeepAlive()
+{
+	m_graph->m_passes[m_passIndex].m_keepAlive = true;
+}
+
+void RenderPassBuilder::SetExecute(void* execute, void(*invoke)(void*, const RenderPassContext&), void(*destroy)(void*))
+{
+	auto& pass = m_graph->m_passes[m_passIndex];
+	if (pass.m_execute)
+		pass.m_destroy(pass.m_execute);
+
+	pass.m_execute = execute;
+	pass.m_invoke = invoke;
+	pass.m_destroy = destroy;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+RenderPassContext::RenderPassContext(RenderGraph* graph, uint32_t passIndex) :
+	m_graph(graph), m_passIndex(passIndex)
+{}
+
+std::shared_ptr<TextureBuffer> RenderPassContext::GetTexture(RenderResource resource) const
+{
+	return m_graph->m_resources[resource].m_texture;
+}
+
+std::shared_ptr<FrameBuffer> RenderPassContext::GetFramebuffer() const
+{
+	return m_graph->m_passes[m_passIndex].m_FBO;
+}
+
+std::shared_ptr<FrameBuffer> RenderPassContext::GetFramebuffer(RenderResource resource, GLenum attachment) const
+{
+	FrameVector<std::pair<RenderResource, GLenum>> attachments;
+	attachments.emplace_back(resource, attachment);
+
+	return m_graph->AcquireFramebuffer(attachments, m_graph->m_resources[resource].m_name);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+RenderGraph::RenderGraph() :
+	m_frameIndex(0), m_numExecutedPasses(0), m_numCulledPasses(0), m_transientBytes(0), m_pooledBytes(0),
+	m_timingEnabled(false)
+{}
+
+RenderGraph::~RenderGraph() {}
+
+RenderPassBuilder RenderGraph::AddPass(const char* name)
+{
+	PassNode pass;
+	pass.m_name = name;
+	pass.m_execute = nullptr;
+	pass.m_invoke = nullptr;
+	pass.m_destroy = nullptr;
+	pass.m_keepAlive = false;
+	pass.m_culled = false;
+
+	m_passes.emplace_back(pass);
+	return RenderPassBuilder(this, (uint32_t)(m_passes.size() - 1));
+}
+
+RenderResource RenderGraph::ImportResource(const char* name, std::shared_ptr<TextureBuffer> texture)
+{
+	ResourceNode resource;
+	resource.m_name = name;
+	resource.m_desc = {};
+	resource.m_imported = true;
+	resource.m_isRenderbuffer = false;
+	resource.m_texture = texture;
+	resource.m_version = 0;
+	resource.m_firstPass = resource.m_lastPass = -1;
+
+	m_resources.emplace_back(resource);
+	return (RenderResource)(m_resources.size() - 1);
+}
+
+void RenderGraph::CullPasses()
+{
+	// Walking backwards, a pass is needed if it's kept alive or it wrote a version of a resource that a needed pass reads
+	// A graph is a few dozen passes, so a flat search of an arena vector beats a node based set's allocations
+	FrameVector<std::pair<RenderResource, uint32_t>> neededVersions;
+	neededVersions.reserve(m_resources.size() * 2);
+
+	for (auto pass = m_passes.rbegin(); pass != m_passes.rend(); ++pass)
+	{
+		bool needed = pass->m_keepAlive;
+		for (size_t i = 0; i < pass->m_writes.size() && !needed; i++)
+		{
+			needed = (std::find(neededVersions.begin(), neededVersions.end(), pass->m_writes[i]) !=
+				neededVersions.end());
+		}
+
+		pass->m_culled = !needed || !pass->m_execute;
+		if (pass->m_culled)
+			continue;
+
+		neededVersions.insert(neededVersions.end(), pass->m_reads.begin(), pass->m_reads.end());
+	}
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+	for (int i = 0; i < (int)m_passes.size(); i++)
+	{
+		if (m_passes[i].m_culled)
+			continue;
+
+		for (const auto* accesses : { &m_passes[i].m_reads, &m_passes[i].m_writes })
+		{
+			for (const auto& access : *accesses)
+			{
+				auto& resource = m_resources[access.first];
+				if (resource.m_firstPass < 0)
+					resource.m_firstPass = i;
+
+				resource.m_lastPass = i;
+			}
+		}
+	}
+}
+
+void RenderGraph::AcquireTexture(ResourceNode& resource)
+{
+	const TransientTextureDesc& desc = resource.m_desc;
+	for (auto& pooled : m_texturePool)
+	{
+		if (!pooled.m_inUse && pooled.m_isRenderbuffer == resource.m_isRenderbuffer && pooled.m_desc == desc)
+		{
+			pooled.m_inUse = true;
+			pooled.m_lastUsedFrame = m_frameIndex;
+
+			// Pooled textures are shared between resources, but the passes ask for them in the same order each frame,
+			// so a texture usually goes to the same resource and only needs renaming when it doesn't. The sampler
+			// state the last resource's passes set is put back to the defaults then too.
+			if (pooled.m_label != resource.m_name)
+			{
+				if (pooled.m_isRenderbuffer)
+					pooled.m_renderbuffer->SetLabel(resource.m_name);
+				else
+				{
+					pooled.m_texture->SetLabel(resource.m_name);
+					if (desc.m_samples <= 1)
+					{
+						pooled.m_texture->SetFiltering(GL_NEAREST, GL_NEAREST);
+						pooled.m_texture->SetWrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+						pooled.m_texture->SetCompareMode(GL_NONE);
+					}
+				}
+
+				pooled.m_label = resource.m_name;
+			}
+
+			resource.m_texture = pooled.m_texture;
+			resource.m_renderbuffer = pooled.m_renderbuffer;
+			return;
+		}
+	}
+
+	const bool multisample = (desc.m_samples > 1);
+	PooledTexture pooled = { desc, resource.m_isRenderbuffer, nullptr, nullptr, resource.m_name, m_frameIndex, true };
+
+	if (resource.m_isRenderbuffer)
+	{
+		pooled.m_renderbuffer = Buffer::GenerateRBO(desc.m_width, desc.m_height, desc.m_internalFormat, multisample,
+			(int)desc.m_samples);
+		pooled.m_renderbuffer->SetLabel(resource.m_name);
+	}
+	else
+	{
+		pooled.m_texture = Buffer::GenerateTBO(desc.m_width, desc.m_height, desc.m_internalFormat, desc.m_format,
+			desc.m_type, false, multisample, (int)desc.m_samples);
+
+		// Multisampled textures can only be fetched from, so they have no sampler state
+		if (!multisample)
+		{
+			pooled.m_texture->SetFiltering(GL_NEAREST, GL_NEAREST);
+			pooled.m_texture->SetWrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+		}
+
+		pooled.m_texture->SetLabel(resource.m_name);
+	}
+
+	m_texturePool.push_back(pooled);
+	m_pooledBytes += GetTextureBytes(desc);
+
+	resource.m_texture = pooled.m_texture;
+	resource.m_renderbuffer = pooled.m_renderbuffer;
+}
+
+void RenderGraph::ReleaseTexture(const ResourceNode& resource)
+{
+	for (auto& pooled : m_texturePool)
+	{
+		if (pooled.m_texture == resource.m_texture && pooled.m_renderbuffer == resource.m_renderbuffer)
+		{
+			pooled.m_inUse = false;
+			return;
+		}
+	}
+}
+
+std::shared_ptr<FrameBuffer> RenderGraph::AcquireFramebuffer(
+	const FrameVector<std::pair<RenderResource, GLenum>>& attachments, const char* label)
+{
+	FrameVector<std::tuple<GLenum, bool, uint32_t>> key;
+	key.reserve(attachments.size());
+	bool hasColorAttachment = false;
+
+	for (const auto& attachment : attachments)
+	{
+		const auto& resource = m_resources[attachment.first];
+		key.emplace_back(attachment.second, resource.m_isRenderbuffer, resource.m_isRenderbuffer ?
+			resource.m_renderbuffer->GetID() : resource.m_texture->GetID());
+		hasColorAttachment |= (attachment.second >= GL_COLOR_ATTACHMENT0 && attachment.second <= GL_COLOR_ATTACHMENT15);
+	}
+
+	std::sort(key.begin(), key.end());
+
+	for (auto& cached : m_framebufferCache)
+	{
+		if (cached.m_attachments.size() == key.size() &&
+			std::equal(key.begin(), key.end(), cached.m_attachments.begin()))
+		{
+			cached.m_lastUsedFrame = m_frameIndex;
+			return cached.m_FBO;
+		}
+	}
+
+	auto FBO = Buffer::GenerateFBO(!hasColorAttachment);
+	for (const auto& attachment : attachments)
+	{
+		const auto& resource = m_resources[attachment.first];
+		if (resource.m_isRenderbuffer)
+			FBO->AttachRenderBuffer(resource.m_renderbuffer, attachment.second);
+		else
+			FBO->AttachTextureBuffer(resource.m_name, resource.m_texture, attachment.second);
+	}
+
+	FBO->SetLabel(label);
+
+	// The cache outlives the frame, so it keeps a heap copy of the key
+	m_framebufferCache.push_back({ { key.begin(), key.end() }, FBO, m_frameIndex });
+	return FBO;
+}
+
+void RenderGraph::EvictUnusedResources()
+{
+	// The framebuffers go first, as they keep their attached textures alive
+	m_framebufferCache.erase(std::remove_if(m_framebufferCache.begin(), m_framebufferCache.end(),
+		[this](const CachedFramebuffer& cached) { return m_frameIndex - cached.m_lastUsedFrame > EVICT_AFTER_FRAMES; }),
+		m_framebufferCache.end());
+
+	for (const auto& pooled : m_texturePool)
+	{
+		if (m_frameIndex - pooled.m_lastUsedFrame > EVICT_AFTER_FRAMES)
+			m_pooledBytes -= GetTextureBytes(pooled.m_desc);
+	}
+
+	m_texturePool.erase(std::remove_if(m_texturePool.begin(), m_texturePool.end(),
+		[this](const PooledTexture& pooled) { return m_frameIndex - pooled.m_lastUsedFrame > EVICT_AFTER_FRAMES; }),
+		m_texturePool.end());
+}
+
+void RenderGraph::Execute()
+{
+	PROFILE_ZONE("RenderGraph::Execute");
+
+	this->CullPasses();
+	this->ComputeLifetimes();
+
+	m_numExecutedPasses = m_numCulledPasses = 0;
+	m_transientBytes = 0;
+
+	m_passTimings.clear();
+
+	for (uint32_t i = 0; i < (uint32_t)m_passes.size(); i++)
+	{
+		auto& pass = m_passes[i];
+		if (pass.m_culled)
+		{
+			m_numCulledPasses++;
+			continue;
+		}
+
+		// The transient resources first used by this pass are given textures, which may have been used earlier this frame
+		for (auto& resource : m_resources)
+		{
+			if (resource.m_imported || resource.m_firstPass != (int)i)
+				continue;
+
+			this->AcquireTexture(resource);
+			m_transientBytes += GetTextureBytes(resource.m_desc);
+		}
+
+		for (const auto& read : pass.m_reads)
+		{
+			if (read.second == 0 && !m_resources[read.first].m_imported)
+			{
+				OutputLog("The render pass \"" + std::string(pass.m_name) + "\" reads \"" +
+					m_resources[read.first].m_name + "\" before anything has written it", Logging::Severity::WARNING);
+			}
+		}
+
+		if (!pass.m_attachments.empty())
+			pass.m_FBO = this->AcquireFramebuffer(pass.m_attachments, pass.m_name);
+
+		GLDebug::PushGroup(pass.m_name);
+
+		if (m_timingEnabled)
+		{
+			const auto startTime = std::chrono::steady_clock::now();
+			GpuProfiler::GetPtr()->BeginTimer(pass.m_name);
+
+			pass.m_invoke(pass.m_execute, RenderPassContext(this, i));
+
+			GpuProfiler::GetPtr()->EndTimer(pass.m_name);
+			const std::chrono::duration<float, std::milli> cpuTime = std::chrono::steady_clock::now() - startTime;
+
+			m_passTimings.push_back({ pass.m_name, cpuTime.count(), GpuProfiler::GetPtr()->GetTime(pass.m_name) });
+		}
+		else
+		{
+			pass.m_invoke(pass.m_execute, RenderPassContext(this, i));
+		}
+
+		GLDebug::PopGroup();
+		m_numExecutedPasses++;
+
+		for (auto& resource : m_resources)
+		{
+			if (!resource.m_imported && resource.m_lastPass == (int)i)
+				this->ReleaseTexture(resource);
+		}
+	}
+
+	// The functions' memory is reclaimed with the rest of the frame arena, but what they captured still has to go
+	for (const auto& pass : m_passes)
+	{
+		if (pass.m_execute)
+			pass.m_destroy(pass.m_execute);
+	}
+
+	m_passes.clear();
+	m_resources.clear();
+
+	m_frameIndex++;
+	this->EvictUnusedResources();
+}
+
+void RenderGraph::SetTimingEnabled(bool enabled)
+{
+	m_timingEnabled = enabled;
+	if (!enabled)
+		m_passTimings.clear();
+}
+
+const uint32_t& RenderGraph::GetNumExecutedPasses() const
+{
+	return m_numExecutedPasses;
+}
+
+const uint32_t& RenderGraph::GetNumCulledPasses() const
+{
+	return m_numCulledPasses;
+}
+
+const size_t& RenderGraph::GetTransientBytes() const
+{
+	return m_transientBytes;
+}
+
+const size_t& RenderGraph::GetPooledBytes() const
+{
+	return m_pooledBytes;
+}
+
+const std::vector<PassTiming>& RenderGraph::GetPassTimings() const
+{
+	return m_passTimings;
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#pragma once
+#include "Utils/FrameArena.h"
+
+#include <glad/glad.h>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <utility>
+
+class TextureBuffer;
+class RenderBuffer;
+class FrameBuffer;
+class RenderGraph;
+class RenderPassContext;
+
+typedef unsigned int uint32_t;
+
+// A handle to one of the graph's resources, which is only valid for the frame it was declared in
+typedef uint32_t RenderResource;
+const RenderResource NULL_RENDER_RESOURCE = 0xFFFFFFFF;
+
+struct TransientTextureDesc
+{
+	uint32_t m_width, m_height;
+	GLenum m_internalFormat, m_format, m_type;
+	uint32_t m_samples; // Multisampled above 1, it can be left out for single sampled targets
+
+	bool operator==(const TransientTextureDesc& other) const;
+};
+
+struct PassTiming
+{
+	const char* m_name;
+	float m_cpuTime, m_gpuTime; // In milliseconds, the GPU time is negative until the profiler has a result for the pass
+};
+
+class RenderPassBuilder
+{
+	friend class RenderGraph;
+private:
+	RenderGraph* m_graph;
+	uint32_t m_passIndex;
+private:
+	RenderPassBuilder(RenderGraph* graph, uint32_t passIndex);
+
+	void SetExecute(void* execute, void(*invoke)(void*, const RenderPassContext&), void(*destroy)(void*));
+public:
+	// Declares a texture that only lives for this frame, it isn't allocated unless a pass that isn't culled uses it
+	RenderResource CreateTexture(const char* name, const TransientTextureDesc& desc);
+
+	// The same as a texture, but for attachments that are never sampled (e.g. a depth buffer only used for testing), so
+	// the description's format and type are ignored
+	RenderResource CreateRenderbuffer(const char* name, const TransientTextureDesc& desc);
+
+	void Read(RenderResource resource);
+
+	/*
+		Write() : Declares that the pass writes the resource. A pass that only adds to what's already there (e.g. blending)
+		has to read the resource too, otherwise the passes before it may be culled.
+		[resource] - The resource written
+		[attachment] - Where the resource is attached in the framebuffer the graph builds for the pass, this is left as
+		GL_NONE for imported resources since the pass binds those itself
+	*/
+	void Write(RenderResource resource, GLenum attachment = GL_NONE);
+
+	// The pass is never culled, which the pass drawing the final image needs as nothing in the graph reads it
+	void KeepAlive();
+
+	// The function is moved into the frame arena rather than a std::function, which would put larger captures (e.g. a
+	// matrix) on the heap every frame
+	template<typename Function>
+	void SetExecute(Function execute)
+	{
+		static_assert(alignof(Function) <= alignof(std::max_align_t), "The frame arena can't align the function");
+
+		void* memory = FrameArena::GetPtr()->Allocate(sizeof(Function), alignof(Function));
+		this->SetExecute(new (memory) Function(std::move(execute)),
+			[](void* function, const RenderPassContext& context) { (*(Function*)function)(context); },
+			[](void* function) { ((Function*)function)->~Function(); });
+	}
+};
+
+class RenderPassContext
+{
+	friend class RenderGraph;
+private:
+	RenderGraph* m_graph;
+	uint32_t m_passIndex;
+private:
+	RenderPassContext(RenderGraph* graph, uint32_t passIndex);
+public:
+	std::shared_ptr<TextureBuffer> GetTexture(RenderResource resource) const; // Null for renderbuffers
+
+	// The framebuffer made from the pass's attached resources, which is null if it has none
+	std::shared_ptr<FrameBuffer> GetFramebuffer() const;
+
+	// A framebuffer with only the given resource attached, for blits and for passes that draw into several targets in
+	// turn. The resource has to be one the pass reads or writes.
+	std::shared_ptr<FrameBuffer> GetFramebuffer(RenderResource resource, GLenum attachment) const;
+};
+
+/*
+	RenderGraph : Records the passes of a frame along with the resources they read and write, then culls the passes
+	that nothing kept alive depends on and runs the rest in the order they were added (a resource has to be declared
+	before it's read, so that order already respects the dependencies). Transient textures are taken from a pool when
+	they're first used and handed back after their last use, so resources that aren't alive at the same time share
+	the same texture whenever their descriptions match (renderbuffers are pooled the same way). The pool is kept between
+	frames, and anything in it that goes unused for a while is freed, so switching between render paths doesn't leave
+	their targets allocated. A pooled texture starts out with nearest filtering and clamped edges each time it goes to a
+	different resource, so a pass that needs other sampler state sets it on the texture every frame. The pass and
+	resource names are kept rather than copied, so they have to outlive the frame's timings, which string literals do.
+*/
+class RenderGraph
+{
+	friend class RenderPassBuilder;
+	friend class RenderPassContext;
+private:
+	struct ResourceNode
+	{
+		const char* m_name;
+		TransientTextureDesc m_desc;
+		bool m_imported, m_isRenderbuffer;
+
+		std::shared_ptr<TextureBuffer> m_texture; // Imported resources have it from the start, transient ones when executed
+		std::shared_ptr<RenderBuffer> m_renderbuffer; // Used instead of the texture by renderbuffer resources
+		uint32_t m_version; // Each write makes a new version, so a read only depends on the writes declared before it
+		int m_firstPass, m_lastPass;
+	};
+
+	struct PassNode
+	{
+		const char* m_name;
+		FrameVector<std::pair<RenderResource, uint32_t>> m_reads, m_writes; // Rebuilt every frame, so taken from the arena
+		FrameVector<std::pair<RenderResource, GLenum>> m_attachments;
+
+		void* m_execute; // The function given to the builder, which is null until it's set
+		void(*m_invoke)(void*, const RenderPassContext&);
+		void(*m_destroy)(void*);
+
+		bool m_keepAlive, m_culled;
+		std::shared_ptr<FrameBuffer> m_FBO;
+	};
+
+	struct PooledTexture
+	{
+		TransientTextureDesc m_desc;
+		bool m_isRenderbuffer;
+		std::shared_ptr<TextureBuffer> m_texture;
+		std::shared_ptr<RenderBuffer> m_renderbuffer;
+		const char* m_label; // The resource it was last handed out for, it's only relabelled when that changes
+		uint32_t m_lastUsedFrame;
+		bool m_inUse;
+	};
+
+	struct CachedFramebuffer
+	{
+		// The attachment points and the IDs bound to them, which are flagged as renderbuffers as their IDs overlap
+		std::vector<std::tuple<GLenum, bool, uint32_t>> m_attachments;
+		std::shared_ptr<FrameBuffer> m_FBO;
+		uint32_t m_lastUsedFrame;
+	};
+
+	std::vector<ResourceNode> m_resources;
+	std::vector<PassNode> m_passes;
+
+	std::vector<PooledTexture> m_texturePool;
+	std::vector<CachedFramebuffer> m_framebufferCache;
+	uint32_t m_frameIndex;
+
+	// Stats from the last executed frame
+	uint32_t m_numExecutedPasses, m_numCulledPasses;
+	size_t m_transientBytes, m_pooledBytes;
+
+	bool m_timingEnabled;
+	std::vector<PassTiming> m_passTimings;
+private:
+	void CullPasses();
+	void ComputeLifetimes();
+
+	void AcquireTexture(ResourceNode& resource);
+	void ReleaseTexture(const ResourceNode& resource);
+	std::shared_ptr<FrameBuffer> AcquireFramebuffer(const FrameVector<std::pair<RenderResource, GLenum>>& attachments,
+		const char* label);
+	void EvictUnusedResources();
+public:
+	RenderGraph();
+	~RenderGraph();
+
+	RenderPassBuilder AddPass(const char* name);
+
+	// A resource the graph doesn't own (e.g. the scene target), which is used to order the passes that draw to it
+	RenderResource ImportResource(const char* name, std::shared_ptr<TextureBuffer> texture = nullptr);
+
+	// Culls and runs the passes added this frame, then clears them so the next frame can be recorded
+	void Execute();
+
+	// Times every executed pass on the CPU, and on the GPU through the GPU profiler, which is off by default
+	void SetTimingEnabled(bool enabled);
+public:
+	const uint32_t& GetNumExecutedPasses() const;
+	const uint32_t& GetNumCulledPasses() const;
+
+	// The bytes the transient textures would take up on their own, and the bytes the pool actually holds for them
+	const size_t& GetTransientBytes() const;
+	const size_t& GetPooledBytes() const;
+
+	// The CPU times of the last frame's passes alongside the latest GPU times the profiler has read back for them, which
+	// lag a few frames behind. This is empty if timing is switched off.
+	const std::vector<PassTiming>& GetPassTimings() const;
+};
\ No newline at end of file
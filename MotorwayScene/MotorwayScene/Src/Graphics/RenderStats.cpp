@@ -0,0 +1,243 @@
+#include "RenderStats.h"
+#include <glad/glad.h>
+#include <algorithm>
+
+// Every entry point the layer counts, swapped and restored together
+#define RENDER_STATS_ENTRY_POINTS(X) \
+	X(DrawArrays) X(DrawElements) X(DrawArraysInstanced) X(DrawElementsInstanced) \
+	X(BufferData) X(BufferSubData) \
+	X(Uniform1i) X(Uniform1f) X(Uniform2fv) X(Uniform3fv) X(UniformMatrix4fv) \
+	X(UseProgram) X(BindVertexArray) X(BindFramebuffer) X(BindTexture) \
+	X(Enable) X(Disable) X(BlendFunc) X(DepthFunc) X(DepthMask) X(ColorMask) X(CullFace)
+
+namespace
+{
+	RenderCounters currentFrame = {}, lastFrame = {};
+	uint32_t numHookUsers = 0;
+
+	// The real entry points, which the counting ones forward to
+#define DECLARE_REAL_ENTRY_POINT(name) decltype(glad_gl##name) real##name = nullptr;
+	RENDER_STATS_ENTRY_POINTS(DECLARE_REAL_ENTRY_POINT)
+#undef DECLARE_REAL_ENTRY_POINT
+
+	uint64_t CountTriangles(GLenum mode, GLsizei count, GLsizei instances)
+	{
+		uint64_t triangles = 0;
+		if (mode == GL_TRIANGLES)
+			triangles = count / 3;
+		else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+			triangles = count - 2;
+
+		return triangles * instances;
+	}
+
+	void CountDraw(GLenum mode, GLsizei count, GLsizei instances)
+	{
+		currentFrame.m_drawCalls++;
+		currentFrame.m_instances += instances;
+		currentFrame.m_triangles += CountTriangles(mode, count, instances);
+	}
+
+	void APIENTRY CountDrawArrays(GLenum mode, GLint first, GLsizei count)
+	{
+		CountDraw(mode, count, 1);
+		realDrawArrays(mode, first, count);
+	}
+
+	void APIENTRY CountDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+	{
+		CountDraw(mode, count, 1);
+		realDrawElements(mode, count, type, indices);
+	}
+
+	void APIENTRY CountDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+	{
+		CountDraw(mode, count, instances);
+		realDrawArraysInstanced(mode, first, count, instances);
+	}
+
+	void APIENTRY CountDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances)
+	{
+		CountDraw(mode, count, instances);
+		realDrawElementsInstanced(mode, count, type, indices, instances);
+	}
+
+	void APIENTRY CountBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+	{
+		// Allocating without any data (e.g. orphaning the storage) doesn't send anything to the GPU
+		if (data)
+			currentFrame.m_uploadBytes += size;
+
+		realBufferData(target, size, data, usage);
+	}
+
+	void APIENTRY CountBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+	{
+		currentFrame.m_uploadBytes += size;
+		realBufferSubData(target, offset, size, data);
+	}
+
+	void APIENTRY CountUniform1i(GLint location, GLint value)
+	{
+		currentFrame.m_uniformUpdates++;
+		realUniform1i(location, value);
+	}
+
+	void APIENTRY CountUniform1f(GLint location, GLfloat value)
+	{
+		currentFrame.m_uniformUpdates++;
+		realUniform1f(location, value);
+	}
+
+	void APIENTRY CountUniform2fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		currentFrame.m_uniformUpdates++;
+		realUniform2fv(location, count, value);
+	}
+
+	void APIENTRY CountUniform3fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		currentFrame.m_uniformUpdates++;
+		realUniform3fv(location, count, value);
+	}
+
+	void APIENTRY CountUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+	{
+		currentFrame.m_uniformUpdates++;
+		realUniformMatrix4fv(location, count, transpose, value);
+	}
+
+	void APIENTRY CountUseProgram(GLuint program)
+	{
+		currentFrame.m_programSwitches++;
+		currentFrame.m_stateChanges++;
+		realUseProgram(program);
+	}
+
+	void APIENTRY CountBindVertexArray(GLuint vertexArray)
+	{
+		currentFrame.m_stateChanges++;
+		realBindVertexArray(vertexArray);
+	}
+
+	void APIENTRY CountBindFramebuffer(GLenum target, GLuint framebuffer)
+	{
+		currentFrame.m_stateChanges++;
+		realBindFramebuffer(target, framebuffer);
+	}
+
+	void APIENTRY CountBindTexture(GLenum target, GLuint texture)
+	{
+		currentFrame.m_textureBinds++;
+		currentFrame.m_stateChanges++;
+		realBindTexture(target, texture);
+	}
+
+	void APIENTRY CountEnable(GLenum capability)
+	{
+		currentFrame.m_stateChanges++;
+		realEnable(capability);
+	}
+
+	void APIENTRY CountDisable(GLenum capability)
+	{
+		currentFrame.m_stateChanges++;
+		realDisable(capability);
+	}
+
+	void APIENTRY CountBlendFunc(GLenum source, GLenum destination)
+	{
+		currentFrame.m_stateChanges++;
+		realBlendFunc(source, destination);
+	}
+
+	void APIENTRY CountDepthFunc(GLenum func)
+	{
+		currentFrame.m_stateChanges++;
+		realDepthFunc(func);
+	}
+
+	void APIENTRY CountDepthMask(GLboolean enabled)
+	{
+		currentFrame.m_stateChanges++;
+		realDepthMask(enabled);
+	}
+
+	void APIENTRY CountColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+	{
+		currentFrame.m_stateChanges++;
+		realColorMask(red, green, blue, alpha);
+	}
+
+	void APIENTRY CountCullFace(GLenum face)
+	{
+		currentFrame.m_stateChanges++;
+		realCullFace(face);
+	}
+
+	template<typename T>
+	T ClampedDifference(T later, T earlier)
+	{
+		return later - std::min(later, earlier);
+	}
+}
+
+namespace RenderStats
+{
+	void InstallHooks()
+	{
+		// Only the first user swaps the entry points, swapping twice would make the counting ones forward to themselves
+		if (numHookUsers++ > 0)
+			return;
+
+#define SWAP_ENTRY_POINT(name) real##name = glad_gl##name; glad_gl##name = Count##name;
+		RENDER_STATS_ENTRY_POINTS(SWAP_ENTRY_POINT)
+#undef SWAP_ENTRY_POINT
+	}
+
+	void RemoveHooks()
+	{
+		if (numHookUsers == 0 || --numHookUsers > 0)
+			return;
+
+#define RESTORE_ENTRY_POINT(name) glad_gl##name = real##name;
+		RENDER_STATS_ENTRY_POINTS(RESTORE_ENTRY_POINT)
+#undef RESTORE_ENTRY_POINT
+	}
+
+	void EndFrame()
+	{
+		lastFrame = currentFrame;
+		currentFrame = {};
+	}
+
+	bool IsCounting()
+	{
+		return numHookUsers > 0;
+	}
+
+	const RenderCounters& GetCurrentFrame()
+	{
+		return currentFrame;
+	}
+
+	const RenderCounters& GetLastFrame()
+	{
+		return lastFrame;
+	}
+
+	RenderCounters GetDifference(const RenderCounters& later, const RenderCounters& earlier)
+	{
+		RenderCounters difference;
+		difference.m_drawCalls = ClampedDifference(later.m_drawCalls, earlier.m_drawCalls);
+		difference.m_instances = ClampedDifference(later.m_instances, earlier.m_instances);
+		difference.m_triangles = ClampedDifference(later.m_triangles, earlier.m_triangles);
+		difference.m_uploadBytes = ClampedDifference(later.m_uploadBytes, earlier.m_uploadBytes);
+		difference.m_textureBinds = ClampedDifference(later.m_textureBinds, earlier.m_textureBinds);
+		difference.m_programSwitches = ClampedDifference(later.m_programSwitches, earlier.m_programSwitches);
+		difference.m_uniformUpdates = ClampedDifference(later.m_uniformUpdates, earlier.m_uniformUpdates);
+		difference.m_stateChanges = ClampedDifference(later.m_stateChanges, earlier.m_stateChanges);
+
+		return difference;
+	}
+}
\ No newline at end of file
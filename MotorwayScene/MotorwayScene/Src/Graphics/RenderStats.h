@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+typedef unsigned int uint32_t;
+
+struct RenderCounters
+{
+	uint32_t m_drawCalls;
+	uint64_t m_instances; // Draws that aren't instanced count as one
+	uint64_t m_triangles; // Every instance's triangles are counted
+	uint64_t m_uploadBytes; // Written to buffers through glBufferData and glBufferSubData
+
+	uint32_t m_textureBinds, m_programSwitches, m_uniformUpdates;
+	uint32_t m_stateChanges; // Program, vertex array, framebuffer and texture binds, along with the fixed function state
+};
+
+/*
+	RenderStats : Counts the draws, uploads and state changes made each frame. Rather than every call site counting its
+	own, the glad entry points are swapped for ones that count the call then forward it, so nothing can be missed. The
+	swap is only made while something asks for the counters (the overlay or the benchmark), the rest of the time the
+	real entry points are called directly and the layer costs nothing. Everything is drawn from the main thread, so the
+	counters aren't atomic.
+*/
+namespace RenderStats
+{
+	/*
+		InstallHooks() : Starts counting, which must be done once glad has loaded the entry points. Every call is matched
+		by a call to RemoveHooks(), and the real entry points are only put back once the last user has removed its hooks.
+	*/
+	void InstallHooks();
+	void RemoveHooks();
+
+	// Keeps this frame's counters as the last frame's, then starts counting the next
+	void EndFrame();
+
+	bool IsCounting();
+	const RenderCounters& GetCurrentFrame(); // What has been counted so far this frame
+	const RenderCounters& GetLastFrame();
+
+	// The counts made between two readings, where the later one is clamped so nothing wraps around
+	RenderCounters GetDifference(const RenderCounters& later, const RenderCounters& earlier);
+}
\ No newline at end of file
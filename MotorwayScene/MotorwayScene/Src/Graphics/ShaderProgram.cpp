@@ -110,10 +110,29 @@ std::string ShaderProgram::LoadShaderFile(const std::string& filePath) const
 	if (shaderFile.fail())
 		OutputLog("Failed to open shader file: " + filePath, Logging::Severity::FATAL);
 
+	// Shared code is pulled in with #include "File.glsl", the path being relative to the including file.
+	// There are no include guards, so a file must only be included once per shader.
+	const std::string directory = filePath.substr(0, filePath.find_last_of("/\\") + 1);
+
 	std::stringstream ss;
-	ss << shaderFile.rdbuf();
-	shaderFile.close();
+	std::string line;
+	while (std::getline(shaderFile, line))
+	{
+		if (line.compare(0, 8, "#include") == 0)
+		{
+			const size_t pathStart = line.find('"') + 1;
+			const size_t pathEnd = line.find('"', pathStart);
+
+			if (pathStart == 0 || pathEnd == std::string::npos)
+				OutputLog("Invalid include in shader file: " + filePath, Logging::Severity::FATAL);
+			else
+				ss << this->LoadShaderFile(directory + line.substr(pathStart, pathEnd - pathStart)) << '\n';
+		}
+		else
+			ss << line << '\n';
+	}
 
+	shaderFile.close();
 	return ss.str();
 }
 
@@ -160,6 +179,12 @@ void ShaderProgram::SetUniform(const std::string& uniform, const float& value) c
 	glUniform1f(location, value);
 }
 
+void ShaderProgram::SetUniform(const std::string& uniform, const glm::vec2& vector) const
+{
+	const uint32_t location = this->GetUniformLocation(uniform);
+	glUniform2fv(location, 1, &vector[0]);
+}
+
 void ShaderProgram::SetUniform(const std::string& uniform, const glm::vec3& vector) const
 {
 	const uint32_t location = this->GetUniformLocation(uniform);
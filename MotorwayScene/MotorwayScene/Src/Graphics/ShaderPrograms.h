@@ -38,6 +38,7 @@ public:
 	void SetUniform(const std::string& uniform, const bool& value) const;
 	void SetUniform(const std::string& uniform, const float& value) const;
 
+	void SetUniform(const std::string& uniform, const glm::vec2& vector) const;
 	void SetUniform(const std::string& uniform, const glm::vec3& vector) const;
 	void SetUniform(const std::string& uniform, const glm::mat4& matrix) const;
 };
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "TextureComponent.h"
 #include "Utils/ResourceManager.h"
 #include "Utils/LoggingManager.h"
+#include "Graphics/GLDebug.h"
+#include "Graphics/GpuMemory.h"
 
 #include <glad/glad.h>
 #include <stb_image.h>
@@ -10,6 +12,7 @@ TextureComponent::TextureComponent(const std::string& path, bool srgb, bool flip
 {
 	glGenTextures(1, &m_ID);
 	glBindTexture(GL_TEXTURE_2D, m_ID);
+	GLDebug::LabelObject(GLDebug::ObjectType::TEXTURE, m_ID, path);
 
 	this->SetupTextureConfig();
 
@@ -38,6 +41,11 @@ TextureComponent::TextureComponent(const std::string& path, bool srgb, bool flip
 		}
 
 		glGenerateMipmap(GL_TEXTURE_2D);
+
+		// The mip chain adds up to a third of the base level
+		const size_t bytes = GpuMemory::GetTextureBytes(m_width, m_height, (m_numChannels < 3) ? GL_RED : GL_RGBA);
+		GpuMemory::Register(this, GpuMemoryCategory::TEXTURE, bytes + (bytes / 3));
+		GpuMemory::SetLabel(this, path);
 	}
 	else
 		OutputLog("Failed to load texture: " + path, Logging::Severity::FATAL);
@@ -49,6 +57,7 @@ TextureComponent::TextureComponent(const std::string& path, bool srgb, bool flip
 TextureComponent::~TextureComponent()
 {
 	glDeleteTextures(1, &m_ID);
+	GpuMemory::Unregister(this);
 }
 
 void TextureComponent::SetupTextureConfig() const
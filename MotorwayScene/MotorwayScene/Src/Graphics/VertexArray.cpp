@@ -1,4 +1,5 @@
 #include "VertexArray.h"
+#include "GLDebug.h"
 #include <cassert>
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -49,6 +50,17 @@ void VertexArray::UnbindVertexArray() const
 	glBindVertexArray(0);
 }
 
+void VertexArray::SetLabel(const std::string& label) const
+{
+	if (!GLDebug::IsEnabled())
+		return;
+
+	// The name only becomes an object once it's bound, which hasn't happened if no buffers have been attached yet
+	glBindVertexArray(m_ID);
+	glBindVertexArray(0);
+	GLDebug::LabelObject(GLDebug::ObjectType::VERTEX_ARRAY, m_ID, label);
+}
+
 const uint32_t& VertexArray::GetID() const
 {
 	return m_ID;
@@ -29,6 +29,8 @@ public:
 
 	void BindVertexArray() const;
 	void UnbindVertexArray() const;
+
+	void SetLabel(const std::string& label) const;
 public:
 	template<typename T>
 	void PushAttribLayout(GLuint index, GLint size, GLsizei stride, GLsizei offset = 0, GLuint divisor = 0,
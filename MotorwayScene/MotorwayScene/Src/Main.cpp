@@ -1,7 +1,56 @@
 #include "Core/AppCore.h"
+#include "Scripts/Scalability.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
 
 int main(int argc, char** argv)
 {
-	AppCore app;
+	// The settings decide the window size, so they're loaded before anything else
+	Scalability::GetPtr()->LoadSettings(argc, argv);
+
+	// "--headless" renders offscreen through EGL instead of opening a window, for machines without a display, and
+	// "--benchmark[=<path>]" runs the benchmark path and writes the results to the path given. "--capture[=<frames>]"
+	// profiles the loading and first frames into a Chrome trace, and "--gl-capture[=<frames>]" records the GL calls of the
+	// loading and first frames for the replay tool. "--gl-debug" logs the driver's debug messages, which debug builds
+	// always do, and "--zero-alloc[=<frames>]" reports every frame that allocates once that many have gone by.
+	// "--gpu-budget=<megabytes>" warns whenever the scene's buffers and textures add up to more than that.
+	LaunchOptions options = { false, false, "benchmark.json", 0, 0, false, 0, 0 };
+#ifdef _DEBUG
+	options.m_glDebug = true;
+#endif
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+		if (argument == "--headless")
+			options.m_headless = true;
+		else if (argument == "--benchmark")
+			options.m_benchmark = true;
+		else if (argument.compare(0, 12, "--benchmark=") == 0)
+		{
+			options.m_benchmark = true;
+			options.m_benchmarkOutput = argument.substr(12);
+		}
+		else if (argument == "--capture")
+			options.m_captureFrames = 60;
+		else if (argument.compare(0, 10, "--capture=") == 0)
+			options.m_captureFrames = (uint32_t)std::max(std::atoi(argument.substr(10).c_str()), 1);
+		else if (argument == "--gl-capture")
+			options.m_glCaptureFrames = 60;
+		else if (argument.compare(0, 13, "--gl-capture=") == 0)
+			options.m_glCaptureFrames = (uint32_t)std::max(std::atoi(argument.substr(13).c_str()), 1);
+		else if (argument == "--gl-debug")
+			options.m_glDebug = true;
+		else if (argument == "--zero-alloc")
+			options.m_zeroAllocWarmupFrames = 300;
+		else if (argument.compare(0, 13, "--zero-alloc=") == 0)
+			options.m_zeroAllocWarmupFrames = (uint32_t)std::max(std::atoi(argument.substr(13).c_str()), 1);
+		else if (argument.compare(0, 13, "--gpu-budget=") == 0)
+			options.m_gpuBudgetMegabytes = (uint32_t)std::max(std::atoi(argument.substr(13).c_str()), 0);
+	}
+
+	AppCore app(options);
 	return 0;
 }
\ No newline at end of file
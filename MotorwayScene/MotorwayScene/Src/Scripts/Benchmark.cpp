@@ -0,0 +1,358 @@
+#include "Benchmark.h"
+#include "Player.h"
+#include "WorldScene.h"
+#include "Scalability.h"
+
+#include "Core/WindowFrame.h"
+#include "Graphics/GpuMemory.h"
+#include "Graphics/GpuProfiler.h"
+#include "Utils/LoggingManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+
+namespace Config
+{
+	const uint32_t WARMUP_FRAMES = 300;
+	const uint32_t MEASURED_FRAMES = 3000; // Fifty seconds at sixty frames a second
+	const uint32_t NUM_MEMORY_CONSUMERS = 10; // How many of the biggest GPU objects are written out
+}
+
+namespace
+{
+	struct TimeStats
+	{
+		float m_average, m_p50, m_p95, m_p99, m_min, m_max;
+	};
+
+	// The camera passes through each position looking at its target, the road runs down the Z axis from the start
+	const glm::vec3 CAMERA_PATH[][2] =
+	{
+		// Driving down the motorway
+		{ { 2.0f, 1.25f, 0.0f }, { 2.0f, 1.25f, -20.0f } },
+		{ { 2.0f, 1.25f, -60.0f }, { 2.0f, 1.25f, -80.0f } },
+		{ { 2.0f, 1.25f, -120.0f }, { 2.0f, 1.25f, -140.0f } },
+
+		// Climbing up and flying over the forest
+		{ { 10.0f, 20.0f, -160.0f }, { 60.0f, 0.0f, -200.0f } },
+		{ { 80.0f, 45.0f, -200.0f }, { 140.0f, 0.0f, -240.0f } },
+		{ { 160.0f, 45.0f, -120.0f }, { 220.0f, 0.0f, -80.0f } },
+
+		// Dropping back down by the road and looking into the trees, where the most is hidden behind the trunks
+		{ { 60.0f, 15.0f, -60.0f }, { 12.0f, 2.0f, -40.0f } },
+		{ { 12.0f, 2.0f, -30.0f }, { 60.0f, 2.0f, -30.0f } },
+		{ { 30.0f, 2.0f, -30.0f }, { 60.0f, 2.0f, -20.0f } }
+	};
+
+	const int NUM_CAMERA_KEYFRAMES = sizeof(CAMERA_PATH) / sizeof(CAMERA_PATH[0]);
+
+	glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t)
+	{
+		const float t2 = t * t, t3 = t2 * t;
+		return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+			(3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+	}
+
+	TimeStats ComputeStats(std::vector<float> samples)
+	{
+		std::sort(samples.begin(), samples.end());
+
+		// Nearest rank, so each percentile is a frame time that actually happened
+		auto percentile = [&samples](float p)
+		{
+			const size_t rank = (size_t)std::ceil(p / 100.0f * (float)samples.size());
+			return samples[std::min(std::max(rank, (size_t)1), samples.size()) - 1];
+		};
+
+		float total = 0.0f;
+		for (const float sample : samples)
+			total += sample;
+
+		return { total / (float)samples.size(), percentile(50.0f), percentile(95.0f), percentile(99.0f), samples.front(),
+			samples.back() };
+	}
+
+	void WriteStats(std::ofstream& file, const std::vector<float>& samples)
+	{
+		if (samples.empty())
+		{
+			file << "null";
+			return;
+		}
+
+		const TimeStats stats = ComputeStats(samples);
+		file << "{ \"average\": " << stats.m_average << ", \"p50\": " << stats.m_p50 << ", \"p95\": " << stats.m_p95 <<
+			", \"p99\": " << stats.m_p99 << ", \"min\": " << stats.m_min << ", \"max\": " << stats.m_max << " }";
+	}
+
+	// The GPU objects are named after file paths among other things, which can have backslashes in them on Windows
+	void WriteString(std::ofstream& file, const std::string& text)
+	{
+		file << "\"";
+		for (const char character : text)
+		{
+			if (character == '"' || character == '\\')
+				file << '\\';
+
+			file << character;
+		}
+		file << "\"";
+	}
+}
+
+Benchmark::Benchmark() :
+	m_player(nullptr), m_worldScene(nullptr), m_frameIndex(0), m_lastGpuFrameIndex(0xFFFFFFFF),
+	m_finished(false)
+{}
+
+Benchmark::~Benchmark() {}
+
+void Benchmark::InitScript(std::shared_ptr<WindowFrame> window, Player& player, WorldScene& worldScene,
+	const std::string& outputPath)
+{
+	m_window = window;
+	m_player = &player;
+	m_worldScene = &worldScene;
+	m_outputPath = outputPath;
+
+	m_frameTimes.reserve(Config::MEASURED_FRAMES);
+	m_frameCounters.reserve(Config::MEASURED_FRAMES);
+	m_frameAllocations.reserve(Config::MEASURED_FRAMES);
+
+	// Waiting on the display would cap every frame at the refresh rate and hide the differences between runs
+	m_window->SetVSync(false);
+	m_worldScene->GetRenderGraph().SetTimingEnabled(true);
+	RenderStats::InstallHooks();
+
+	OutputLog("Benchmarking " + std::to_string(Config::WARMUP_FRAMES) + " warm-up and " +
+		std::to_string(Config::MEASURED_FRAMES) + " measured frames", Logging::Severity::NOTIFICATION);
+}
+
+void Benchmark::UpdateTick(const float& deltaTime)
+{
+	if (m_finished)
+		return;
+
+	// The frame before this one is recorded if it came after the warm-up
+	if (m_frameIndex > Config::WARMUP_FRAMES)
+		this->RecordFrame(deltaTime);
+
+	if (m_frameIndex == Config::WARMUP_FRAMES + Config::MEASURED_FRAMES)
+	{
+		this->WriteResults();
+
+		m_worldScene->GetRenderGraph().SetTimingEnabled(false);
+		RenderStats::RemoveHooks();
+		m_window->RequestClose();
+		m_finished = true;
+		return;
+	}
+
+	const uint32_t measuredFrame = (m_frameIndex > Config::WARMUP_FRAMES) ? m_frameIndex - Config::WARMUP_FRAMES : 0;
+	this->MoveCamera((float)measuredFrame / (float)(Config::MEASURED_FRAMES - 1));
+
+	m_frameIndex++;
+}
+
+void Benchmark::MoveCamera(float pathProgress)
+{
+	// Each keyframe takes up an equal share of the path, with the end ones repeated so the spline reaches them
+	const float segmentPosition = pathProgress * (float)(NUM_CAMERA_KEYFRAMES - 1);
+	const int segment = std::min((int)segmentPosition, NUM_CAMERA_KEYFRAMES - 2);
+	const float t = segmentPosition - (float)segment;
+
+	const int i0 = std::max(segment - 1, 0), i1 = segment, i2 = segment + 1;
+	const int i3 = std::min(segment + 2, NUM_CAMERA_KEYFRAMES - 1);
+
+	const glm::vec3 position = CatmullRom(CAMERA_PATH[i0][0], CAMERA_PATH[i1][0], CAMERA_PATH[i2][0], CAMERA_PATH[i3][0], t);
+	const glm::vec3 target = CatmullRom(CAMERA_PATH[i0][1], CAMERA_PATH[i1][1], CAMERA_PATH[i2][1], CAMERA_PATH[i3][1], t);
+
+	PerspectiveCamera& camera = m_player->GetCamera();
+	camera.SetPosition(position);
+	camera.SetFrontDir(target - position);
+	camera.UpdateTick();
+}
+
+void Benchmark::RecordFrame(float deltaTime)
+{
+	m_frameTimes.emplace_back(deltaTime * 1000.0f);
+	m_frameCounters.emplace_back(RenderStats::GetLastFrame());
+	m_frameAllocations.emplace_back(AllocationTracker::GetLastFrame());
+
+	// The GPU times lag a few frames behind the CPU ones, as that's when the profiler can read them without stalling, and
+	// they're only taken when the profiler has read back a new frame so none are counted twice
+	const bool newGpuFrame = (GpuProfiler::GetPtr()->GetResolvedFrameIndex() != m_lastGpuFrameIndex);
+	m_lastGpuFrameIndex = GpuProfiler::GetPtr()->GetResolvedFrameIndex();
+
+	for (const auto& timing : m_worldScene->GetRenderGraph().GetPassTimings())
+	{
+		PassSamples& samples = this->GetSamples(m_passSamples, timing.m_name);
+
+		samples.m_cpuTimes.emplace_back(timing.m_cpuTime);
+		if (newGpuFrame && timing.m_gpuTime >= 0.0f)
+			samples.m_gpuTimes.emplace_back(timing.m_gpuTime);
+	}
+
+	if (!newGpuFrame)
+		return;
+
+	for (const auto& timing : GpuProfiler::GetPtr()->GetTimings())
+		this->GetSamples(m_gpuTimerSamples, timing.m_name).m_gpuTimes.emplace_back(timing.m_time);
+}
+
+Benchmark::PassSamples& Benchmark::GetSamples(std::vector<PassSamples>& samples, const char* name) const
+{
+	auto entry = std::find_if(samples.begin(), samples.end(),
+		[name](const PassSamples& pass) { return pass.m_name == name; });
+	if (entry != samples.end())
+		return *entry;
+
+	// Reserved for every measured frame, so recording the times doesn't allocate mid run
+	samples.push_back({ name, {}, {} });
+	samples.back().m_cpuTimes.reserve(Config::MEASURED_FRAMES);
+	samples.back().m_gpuTimes.reserve(Config::MEASURED_FRAMES);
+	return samples.back();
+}
+
+void Benchmark::WriteResults() const
+{
+	const TimeStats frameStats = ComputeStats(m_frameTimes);
+	OutputLog("Benchmark finished, frame time average " + std::to_string(frameStats.m_average) + "ms, p50 " +
+		std::to_string(frameStats.m_p50) + "ms, p95 " + std::to_string(frameStats.m_p95) + "ms, p99 " +
+		std::to_string(frameStats.m_p99) + "ms", Logging::Severity::NOTIFICATION);
+
+	std::ofstream file(m_outputPath);
+	if (!file.is_open())
+	{
+		OutputLog("Failed to write the benchmark results to \"" + m_outputPath + "\"", Logging::Severity::WARNING);
+		return;
+	}
+
+	const QualitySettings& settings = Scalability::GetPtr()->GetSettings();
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\n";
+	file << "\t\"preset\": \"" << Scalability::GetPtr()->GetPresetName() << "\",\n";
+	file << "\t\"render_width\": " << settings.m_renderWidth << ",\n";
+	file << "\t\"render_height\": " << settings.m_renderHeight << ",\n";
+	file << "\t\"tree_count\": " << settings.m_treeCount << ",\n";
+	file << "\t\"headless\": " << (m_window->IsHeadless() ? "true" : "false") << ",\n";
+	file << "\t\"warmup_frames\": " << Config::WARMUP_FRAMES << ",\n";
+	file << "\t\"measured_frames\": " << m_frameTimes.size() << ",\n";
+
+	file << "\t\"frame_time_ms\": ";
+	WriteStats(file, m_frameTimes);
+	file << ",\n";
+
+	file << "\t\"passes\": [\n";
+	for (size_t i = 0; i < m_passSamples.size(); i++)
+	{
+		const PassSamples& pass = m_passSamples[i];
+
+		// Passes that only run some of the time (e.g. when the culling is switched) are averaged over the frames they ran
+		file << "\t\t{ \"name\": \"" << pass.m_name << "\", \"frames\": " << pass.m_cpuTimes.size() << ",\n";
+		file << "\t\t\t\"cpu_ms\": ";
+		WriteStats(file, pass.m_cpuTimes);
+		file << ",\n\t\t\t\"gpu_ms\": ";
+		WriteStats(file, pass.m_gpuTimes);
+		file << " }" << ((i + 1 < m_passSamples.size()) ? "," : "") << "\n";
+	}
+	file << "\t],\n";
+
+	// The shadow map, scene and post process stages, along with the passes inside them
+	file << "\t\"gpu_timers\": [\n";
+	for (size_t i = 0; i < m_gpuTimerSamples.size(); i++)
+	{
+		file << "\t\t{ \"name\": \"" << m_gpuTimerSamples[i].m_name << "\", \"gpu_ms\": ";
+		WriteStats(file, m_gpuTimerSamples[i].m_gpuTimes);
+		file << " }" << ((i + 1 < m_gpuTimerSamples.size()) ? "," : "") << "\n";
+	}
+	file << "\t],\n";
+
+	// Per frame counts of the GL calls, which show whether a change really cut down on the work handed to the driver
+	const std::pair<const char*, std::function<float(const RenderCounters&)>> counters[] =
+	{
+		{ "draw_calls", [](const RenderCounters& frame) { return (float)frame.m_drawCalls; } },
+		{ "instances", [](const RenderCounters& frame) { return (float)frame.m_instances; } },
+		{ "triangles", [](const RenderCounters& frame) { return (float)frame.m_triangles; } },
+		{ "upload_bytes", [](const RenderCounters& frame) { return (float)frame.m_uploadBytes; } },
+		{ "texture_binds", [](const RenderCounters& frame) { return (float)frame.m_textureBinds; } },
+		{ "program_switches", [](const RenderCounters& frame) { return (float)frame.m_programSwitches; } },
+		{ "uniform_updates", [](const RenderCounters& frame) { return (float)frame.m_uniformUpdates; } },
+		{ "state_changes", [](const RenderCounters& frame) { return (float)frame.m_stateChanges; } }
+	};
+
+	file << "\t\"gl_counters\": {\n";
+	for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+	{
+		std::vector<float> samples;
+		samples.reserve(m_frameCounters.size());
+		for (const auto& frame : m_frameCounters)
+			samples.emplace_back(counters[i].second(frame));
+
+		file << "\t\t\"" << counters[i].first << "\": ";
+		WriteStats(file, samples);
+		file << ((i + 1 < sizeof(counters) / sizeof(counters[0])) ? "," : "") << "\n";
+	}
+	file << "\t},\n";
+
+	// The heap allocations made each frame on every thread, which a settled frame shouldn't make at all
+	std::vector<float> allocations, allocatedBytes;
+	allocations.reserve(m_frameAllocations.size());
+	allocatedBytes.reserve(m_frameAllocations.size());
+	for (const auto& frame : m_frameAllocations)
+	{
+		allocations.emplace_back((float)frame.m_allocations);
+		allocatedBytes.emplace_back((float)frame.m_bytes);
+	}
+
+	file << "\t\"heap_allocations\": {\n";
+	file << "\t\t\"allocations\": ";
+	WriteStats(file, allocations);
+	file << ",\n\t\t\"bytes\": ";
+	WriteStats(file, allocatedBytes);
+	file << "\n\t},\n";
+
+	// What the scene's GPU objects take up by the end of the run and at most, to check it fits on a smaller card
+	const char* categoryKeys[] = { "geometry", "instance", "texture", "render_target" };
+	static_assert(sizeof(categoryKeys) / sizeof(categoryKeys[0]) == (size_t)GpuMemoryCategory::NUM_CATEGORIES, 
+		"Every GPU memory category needs a key");
+
+	const GpuMemoryUsage& memory = GpuMemory::GetUsage();
+	file << "\t\"gpu_memory\": {\n";
+	file << "\t\t\"total_bytes\": " << memory.m_totalBytes << ",\n";
+	file << "\t\t\"peak_bytes\": " << memory.m_peakTotalBytes << ",\n";
+	file << "\t\t\"budget_bytes\": " << GpuMemory::GetBudget() << ",\n";
+	file << "\t\t\"objects\": " << memory.m_numObjects << ",\n";
+
+	file << "\t\t\"categories\": {\n";
+	for (size_t i = 0; i < (size_t)GpuMemoryCategory::NUM_CATEGORIES; i++)
+	{
+		file << "\t\t\t\"" << categoryKeys[i] << "\": { \"bytes\": " << memory.m_bytes[i] << ", \"peak_bytes\": " <<
+			memory.m_peakBytes[i] << " }" << ((i + 1 < (size_t)GpuMemoryCategory::NUM_CATEGORIES) ? "," : "") << "\n";
+	}
+	file << "\t\t},\n";
+
+	const auto consumers = GpuMemory::GetTopConsumers(Config::NUM_MEMORY_CONSUMERS);
+	file << "\t\t\"top_consumers\": [\n";
+	for (size_t i = 0; i < consumers.size(); i++)
+	{
+		file << "\t\t\t{ \"label\": ";
+		WriteString(file, consumers[i]->m_label);
+		file << ", \"category\": \"" << categoryKeys[(size_t)consumers[i]->m_category] << "\", \"bytes\": " << 
+			consumers[i]->m_bytes << " }" << ((i + 1 < consumers.size()) ? "," : "") << "\n";
+	}
+	file << "\t\t]\n";
+	file << "\t}\n";
+	file << "}\n";
+
+	OutputLog("Benchmark results written to \"" + m_outputPath + "\"", Logging::Severity::NOTIFICATION);
+}
+
+const bool& Benchmark::IsFinished() const
+{
+	return m_finished;
+}
\ No newline at end of file
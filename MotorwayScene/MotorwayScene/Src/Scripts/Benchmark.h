@@ -0,0 +1,67 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Graphics/RenderStats.h"
+#include "Utils/AllocationTracker.h"
+
+class WindowFrame;
+class Player;
+class WorldScene;
+
+/*
+	Benchmark : Takes over the player's camera and flies it along a fixed spline (down the motorway, over the forest,
+	then into the trees) for a set number of frames. The first frames are held at the start of the path to warm up
+	the caches and drivers, the rest are measured and written out as JSON once the path is done, after which the app is
+	asked to close. The path is sampled by frame rather than by time, so every run draws the same frames.
+*/
+class Benchmark
+{
+private:
+	struct PassSamples
+	{
+		std::string m_name;
+		std::vector<float> m_cpuTimes, m_gpuTimes;
+	};
+
+	std::shared_ptr<WindowFrame> m_window;
+	Player* m_player;
+	WorldScene* m_worldScene;
+
+	std::string m_outputPath;
+	uint32_t m_frameIndex, m_lastGpuFrameIndex;
+	bool m_finished;
+
+	std::vector<float> m_frameTimes;
+	std::vector<PassSamples> m_passSamples; // In the order the passes first ran
+	std::vector<PassSamples> m_gpuTimerSamples; // Every timer the GPU profiler read back, which only has GPU times
+	std::vector<RenderCounters> m_frameCounters; // The draws, uploads and state changes of each measured frame
+	std::vector<AllocationCounts> m_frameAllocations;
+private:
+	PassSamples& GetSamples(std::vector<PassSamples>& samples, const char* name) const;
+
+	void MoveCamera(float pathProgress);
+	void RecordFrame(float deltaTime);
+	void WriteResults() const;
+public:
+	Benchmark();
+	~Benchmark();
+
+	/*
+		InitScript() : Switches off vsync and turns on the render graph's pass timings and the GL call counters for the
+		length of the run.
+		[window] - The window the benchmark closes when it's done
+		[player] - The player whose camera is moved along the path
+		[worldScene] - The scene whose render passes are timed
+		[outputPath] - Where the results are written
+	*/
+	void InitScript(std::shared_ptr<WindowFrame> window, Player& player, WorldScene& worldScene,
+		const std::string& outputPath);
+
+	// Moves the camera for the frame about to be drawn, the delta time is how long the last frame took
+	void UpdateTick(const float& deltaTime);
+public:
+	const bool& IsFinished() const;
+};
\ No newline at end of file
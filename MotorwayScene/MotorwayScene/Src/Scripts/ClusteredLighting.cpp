@@ -0,0 +1,292 @@
+#include "ClusteredLighting.h"
+#include "Graphics/BufferObjects.h"
+#include "Utils/ResourceManager.h"
+#include "Utils/LoggingManager.h"
+#include "Utils/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cfloat>
+
+namespace
+{
+	// The grid must match the one in PointLighting.glsl
+	constexpr int CLUSTER_GRID_X = 16;
+	constexpr int CLUSTER_GRID_Y = 9;
+	constexpr int CLUSTER_GRID_Z = 24;
+	constexpr int NUM_CLUSTERS = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+
+	// Past this the fog hides everything, so the depth slices aren't spent on it
+	constexpr float CLUSTER_FAR_LIMIT = 100.0f;
+
+	// Bounds the per fragment cost no matter how many lights overlap
+	constexpr uint32_t MAX_CLUSTER_LIGHTS = 64;
+}
+
+ClusteredLighting::ClusteredLighting() :
+	m_clusterProjection(0.0f), m_nearPlane(0.1f), m_farPlane(CLUSTER_FAR_LIMIT), m_screenSize(1.0f), m_stats(), 
+	m_enabled(false), m_loggedLimit(false)
+{
+	this->InitScript();
+}
+
+ClusteredLighting::~ClusteredLighting() {}
+
+ClusteredLighting* ClusteredLighting::GetPtr()
+{
+	static ClusteredLighting singleton;
+	return &singleton;
+}
+
+void ClusteredLighting::InitScript()
+{
+	m_lightDataBuffer = Buffer::GenerateBufferTexture(GL_RGBA32F);
+	m_clusterGridBuffer = Buffer::GenerateBufferTexture(GL_RG32UI);
+	m_lightIndexBuffer = Buffer::GenerateBufferTexture(GL_R32UI);
+
+	m_lightDataBuffer->SetLabel("Cluster light data");
+	m_clusterGridBuffer->SetLabel("Cluster grid");
+	m_lightIndexBuffer->SetLabel("Cluster light indices");
+
+	m_clusterMin.resize(NUM_CLUSTERS);
+	m_clusterMax.resize(NUM_CLUSTERS);
+	m_clusterLights.resize(NUM_CLUSTERS);
+	m_clusterGrid.resize(NUM_CLUSTERS);
+	m_sliceDropped.resize(CLUSTER_GRID_Z);
+}
+
+uint32_t ClusteredLighting::AddPointLight(const glm::vec3& position, const glm::vec3& color, float radius)
+{
+	m_lights.push_back({ position, color, radius });
+	return (uint32_t)m_lights.size() - 1;
+}
+
+void ClusteredLighting::ClearLights()
+{
+	m_lights.clear();
+}
+
+void ClusteredLighting::BuildClusterBounds(const glm::mat4& projection)
+{
+	// Pull the planes and field of view back out of the perspective matrix
+	m_nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+	m_farPlane = std::min(projection[3][2] / (projection[2][2] + 1.0f), CLUSTER_FAR_LIMIT);
+	const float tanHalfFovX = 1.0f / projection[0][0], tanHalfFovY = 1.0f / projection[1][1];
+
+	for (int z = 0; z < CLUSTER_GRID_Z; z++)
+	{
+		const float sliceNear = m_nearPlane * std::pow(m_farPlane / m_nearPlane, (float)z / CLUSTER_GRID_Z);
+		const float sliceFar = m_nearPlane * std::pow(m_farPlane / m_nearPlane, (float)(z + 1) / CLUSTER_GRID_Z);
+
+		for (int y = 0; y < CLUSTER_GRID_Y; y++)
+		{
+			const float minNdcY = -1.0f + 2.0f * y / CLUSTER_GRID_Y, maxNdcY = -1.0f + 2.0f * (y + 1) / CLUSTER_GRID_Y;
+			for (int x = 0; x < CLUSTER_GRID_X; x++)
+			{
+				const float minNdcX = -1.0f + 2.0f * x / CLUSTER_GRID_X, maxNdcX = -1.0f + 2.0f * (x + 1) / CLUSTER_GRID_X;
+				glm::vec3 clusterMin(FLT_MAX), clusterMax(-FLT_MAX);
+
+				// The froxel widens with depth, so its bounds come from the corners of both its ends
+				for (const float depth : { sliceNear, sliceFar })
+				{
+					for (const glm::vec2 ndc : { glm::vec2(minNdcX, minNdcY), glm::vec2(maxNdcX, maxNdcY) })
+					{
+						const glm::vec3 corner(ndc.x * depth * tanHalfFovX, ndc.y * depth * tanHalfFovY, -depth);
+						clusterMin = glm::min(clusterMin, corner);
+						clusterMax = glm::max(clusterMax, corner);
+					}
+				}
+
+				const int index = (z * CLUSTER_GRID_Y + y) * CLUSTER_GRID_X + x;
+				m_clusterMin[index] = clusterMin;
+				m_clusterMax[index] = clusterMax;
+			}
+		}
+	}
+
+	m_clusterProjection = projection;
+}
+
+int ClusteredLighting::GetDepthSlice(float viewDepth) const
+{
+	const int slice = (int)std::floor(std::log(viewDepth / m_nearPlane) / std::log(m_farPlane / m_nearPlane) * 
+		CLUSTER_GRID_Z);
+	return std::min(std::max(slice, 0), CLUSTER_GRID_Z - 1);
+}
+
+bool ClusteredLighting::CullLight(const PointLight& light, uint32_t index, const glm::mat4& view, 
+	ViewLight& viewLight) const
+{
+	const glm::vec3 viewPos = glm::vec3(view * glm::vec4(light.m_position, 1.0f));
+	const float radius = light.m_radius;
+
+	// The depth range the sphere covers, as a positive distance in front of the camera
+	const float nearDepth = std::max(-(viewPos.z + radius), m_nearPlane);
+	const float farDepth = -(viewPos.z - radius);
+	if (farDepth < m_nearPlane || nearDepth > m_farPlane)
+		return false;
+
+	viewLight.m_viewPos = viewPos;
+	viewLight.m_radius = radius;
+	viewLight.m_index = index;
+	viewLight.m_minSlice = this->GetDepthSlice(nearDepth);
+	viewLight.m_maxSlice = this->GetDepthSlice(farDepth);
+
+	// Project the sphere's bounds onto the screen, if it touches the near plane it could cover any tile
+	viewLight.m_minTile = glm::ivec2(0);
+	viewLight.m_maxTile = glm::ivec2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1);
+
+	if (-(viewPos.z + radius) > m_nearPlane)
+	{
+		const float tanHalfFovX = 1.0f / m_clusterProjection[0][0], tanHalfFovY = 1.0f / m_clusterProjection[1][1];
+		glm::vec2 minNdc(FLT_MAX), maxNdc(-FLT_MAX);
+
+		for (const float depth : { -(viewPos.z + radius), -(viewPos.z - radius) })
+		{
+			const glm::vec2 lowNdc((viewPos.x - radius) / (depth * tanHalfFovX), (viewPos.y - radius) / (depth * tanHalfFovY));
+			const glm::vec2 highNdc((viewPos.x + radius) / (depth * tanHalfFovX), (viewPos.y + radius) / (depth * tanHalfFovY));
+			minNdc = glm::min(minNdc, lowNdc);
+			maxNdc = glm::max(maxNdc, highNdc);
+		}
+
+		if (maxNdc.x < -1.0f || maxNdc.y < -1.0f || minNdc.x > 1.0f || minNdc.y > 1.0f)
+			return false;
+
+		const glm::vec2 gridSize((float)CLUSTER_GRID_X, (float)CLUSTER_GRID_Y);
+		viewLight.m_minTile = glm::clamp(glm::ivec2(glm::floor((minNdc * 0.5f + 0.5f) * gridSize)), glm::ivec2(0), 
+			viewLight.m_maxTile);
+		viewLight.m_maxTile = glm::clamp(glm::ivec2(glm::floor((maxNdc * 0.5f + 0.5f) * gridSize)), glm::ivec2(0), 
+			viewLight.m_maxTile);
+	}
+
+	return true;
+}
+
+void ClusteredLighting::AssignLights(const glm::mat4& view, const glm::mat4& projection, const glm::vec2& screenSize)
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	m_screenSize = screenSize;
+	if (projection != m_clusterProjection)
+		this->BuildClusterBounds(projection);
+
+	// Move the lights that could be on screen into view space, along with the range of clusters they could touch
+	m_viewLights.clear();
+	for (uint32_t i = 0; i < (uint32_t)m_lights.size(); i++)
+	{
+		ViewLight viewLight;
+		if (this->CullLight(m_lights[i], i, view, viewLight))
+			m_viewLights.emplace_back(viewLight);
+	}
+
+	// Each depth slice is binned on its own thread, as no two slices share a cluster
+	Jobs::ParallelFor(CLUSTER_GRID_Z, [&](uint32_t slice)
+	{
+		for (int i = slice * CLUSTER_GRID_X * CLUSTER_GRID_Y; i < (int)(slice + 1) * CLUSTER_GRID_X * CLUSTER_GRID_Y; i++)
+			m_clusterLights[i].clear();
+		m_sliceDropped[slice] = 0;
+
+		for (const auto& light : m_viewLights)
+		{
+			if ((int)slice < light.m_minSlice || (int)slice > light.m_maxSlice)
+				continue;
+
+			for (int y = light.m_minTile.y; y <= light.m_maxTile.y; y++)
+			{
+				for (int x = light.m_minTile.x; x <= light.m_maxTile.x; x++)
+				{
+					const int index = (slice * CLUSTER_GRID_Y + y) * CLUSTER_GRID_X + x;
+					auto& clusterLights = m_clusterLights[index];
+
+					// Sphere against the froxel's bounds
+					const glm::vec3 closestPoint = glm::clamp(light.m_viewPos, m_clusterMin[index], m_clusterMax[index]);
+					const glm::vec3 offset = closestPoint - light.m_viewPos;
+					if (glm::dot(offset, offset) > light.m_radius * light.m_radius)
+						continue;
+
+					if (clusterLights.size() < MAX_CLUSTER_LIGHTS)
+						clusterLights.emplace_back(light.m_index);
+					else
+						m_sliceDropped[slice]++;
+				}
+			}
+		}
+	});
+
+	// Flatten the cluster lists into the offset/count grid and a single index list
+	m_lightIndices.clear();
+	m_stats.m_maxClusterLights = 0;
+	for (int i = 0; i < NUM_CLUSTERS; i++)
+	{
+		m_clusterGrid[i] = glm::uvec2((uint32_t)m_lightIndices.size(), (uint32_t)m_clusterLights[i].size());
+		m_lightIndices.insert(m_lightIndices.end(), m_clusterLights[i].begin(), m_clusterLights[i].end());
+		m_stats.m_maxClusterLights = std::max(m_stats.m_maxClusterLights, (uint32_t)m_clusterLights[i].size());
+	}
+
+	m_lightData.clear();
+	for (const auto& light : m_lights)
+	{
+		m_lightData.emplace_back(light.m_position, light.m_radius);
+		m_lightData.emplace_back(light.m_color, 0.0f);
+	}
+
+	// The buffers are never left empty, so the buffer textures always have storage
+	if (m_lightIndices.empty())
+		m_lightIndices.emplace_back(0);
+	if (m_lightData.empty())
+		m_lightData.resize(2, glm::vec4(0.0f));
+
+	m_lightDataBuffer->ReallocateData(&m_lightData[0], m_lightData.size() * sizeof(glm::vec4));
+	m_clusterGridBuffer->ReallocateData(&m_clusterGrid[0], m_clusterGrid.size() * sizeof(glm::uvec2));
+	m_lightIndexBuffer->ReallocateData(&m_lightIndices[0], m_lightIndices.size() * sizeof(uint32_t));
+
+	m_stats.m_numLights = (uint32_t)m_lights.size();
+	m_stats.m_numVisibleLights = (uint32_t)m_viewLights.size();
+	m_stats.m_numAssignments = m_clusterGrid.back().x + m_clusterGrid.back().y;
+
+	m_stats.m_numDropped = 0;
+	for (const uint32_t numDropped : m_sliceDropped)
+		m_stats.m_numDropped += numDropped;
+
+	// The lights past the limit go missing from parts of the screen, which is only worth pointing out the first time
+	if (m_stats.m_numDropped > 0 && !m_loggedLimit)
+	{
+		OutputLog("A light cluster went over the " + std::to_string(MAX_CLUSTER_LIGHTS) + " light limit, " +
+			std::to_string(m_stats.m_numDropped) + " light assignments were dropped", Logging::Severity::WARNING);
+		m_loggedLimit = true;
+	}
+	m_stats.m_assignTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - 
+		startTime).count();
+}
+
+void ClusteredLighting::BindLightData() const
+{
+	auto currentShader = Resource::GetBoundShader();
+	currentShader->SetUniform("usePointLights", m_enabled);
+	currentShader->SetUniform("clusterDepthRange", glm::vec2(m_nearPlane, m_farPlane));
+
+	// The slices stop short of the camera's far plane, so depth is linearized with the projection's own terms
+	currentShader->SetUniform("projectionDepthTerms", glm::vec2(m_clusterProjection[2][2], m_clusterProjection[3][2]));
+	currentShader->SetUniform("clusterTileSize", m_screenSize / glm::vec2((float)CLUSTER_GRID_X, (float)CLUSTER_GRID_Y));
+
+	// The samplers are given their units even when disabled, as they can't be left sharing unit 0 with the textures
+	m_lightDataBuffer->BindBuffer("pointLightData", 10);
+	m_clusterGridBuffer->BindBuffer("clusterGrid", 11);
+	m_lightIndexBuffer->BindBuffer("clusterLightIndices", 12);
+}
+
+void ClusteredLighting::SetEnabled(bool enabled)
+{
+	m_enabled = enabled;
+}
+
+const bool& ClusteredLighting::IsEnabled() const
+{
+	return m_enabled;
+}
+
+const ClusterStats& ClusteredLighting::GetStats() const
+{
+	return m_stats;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class BufferTexture;
+
+struct PointLight
+{
+	glm::vec3 m_position; // In world space
+	glm::vec3 m_color; // Can go above 1, as the falloff is inverse square
+	float m_radius; // The light has no effect past this distance
+};
+
+struct ClusterStats
+{
+	uint32_t m_numLights, m_numVisibleLights;
+	uint32_t m_numAssignments, m_maxClusterLights; // Total light indices, and the most lights in one cluster
+	uint32_t m_numDropped; // Lights which touched a cluster that was already full, so they weren't drawn in it
+	float m_assignTime; // In milliseconds
+};
+
+class ClusteredLighting
+{
+private:
+	struct ViewLight
+	{
+		glm::vec3 m_viewPos;
+		float m_radius;
+		uint32_t m_index;
+
+		int m_minSlice, m_maxSlice;
+		glm::ivec2 m_minTile, m_maxTile;
+	};
+
+	std::vector<PointLight> m_lights;
+	std::vector<ViewLight> m_viewLights;
+
+	std::vector<glm::vec3> m_clusterMin, m_clusterMax; // The view space bounds of every cluster
+	glm::mat4 m_clusterProjection; // The projection the bounds were built for
+	float m_nearPlane, m_farPlane;
+
+	std::vector<std::vector<uint32_t>> m_clusterLights;
+	std::vector<uint32_t> m_sliceDropped; // Each depth slice is binned on its own thread, so each counts its own
+	std::vector<glm::uvec2> m_clusterGrid;
+	std::vector<uint32_t> m_lightIndices;
+	std::vector<glm::vec4> m_lightData;
+
+	std::shared_ptr<BufferTexture> m_lightDataBuffer, m_clusterGridBuffer, m_lightIndexBuffer;
+	glm::vec2 m_screenSize;
+
+	ClusterStats m_stats;
+	bool m_enabled, m_loggedLimit;
+private:
+	ClusteredLighting();
+	~ClusteredLighting();
+
+	void InitScript();
+
+	void BuildClusterBounds(const glm::mat4& projection);
+	bool CullLight(const PointLight& light, uint32_t index, const glm::mat4& view, ViewLight& viewLight) const;
+	int GetDepthSlice(float viewDepth) const;
+public:
+	static ClusteredLighting* GetPtr();
+
+	uint32_t AddPointLight(const glm::vec3& position, const glm::vec3& color, float radius);
+	void ClearLights();
+
+	// Bins the lights into the camera's froxel grid and uploads the cluster lists, this should be done once per frame
+	void AssignLights(const glm::mat4& view, const glm::mat4& projection, const glm::vec2& screenSize);
+
+	// Binds the light data to the bound shader, this takes up sampler units 10 to 12
+	void BindLightData() const;
+
+	void SetEnabled(bool enabled);
+public:
+	const bool& IsEnabled() const;
+	const ClusterStats& GetStats() const;
+};
\ No newline at end of file
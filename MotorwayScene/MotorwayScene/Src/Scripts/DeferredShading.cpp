@@ -0,0 +1,110 @@
+#include "DeferredShading.h"
+#include "PostProcessing.h"
+#include "ShadowGeneration.h"
+#include "ClusteredLighting.h"
+#include "Graphics/BufferObjects.h"
+#include "Graphics/ObjectRenderer.h"
+#include "Utils/ResourceManager.h"
+
+DeferredShading::DeferredShading()
+{
+	this->InitScript();
+}
+
+DeferredShading::~DeferredShading() {}
+
+DeferredShading* DeferredShading::GetPtr()
+{
+	static DeferredShading singleton;
+	return &singleton;
+}
+
+void DeferredShading::InitScript()
+{
+	Resource::LoadShader("GBuffer", "Resources/Shaders/ObjectShader.glsl.vsh", "Resources/Shaders/GBuffer.glsl.fsh");
+	Resource::LoadShader("DeferredLighting", "Resources/Shaders/PostProcessing.glsl.vsh",
+		"Resources/Shaders/DeferredLighting.glsl.fsh");
+}
+
+GBufferTargets DeferredShading::CreateGBuffer(RenderPassBuilder& builder) const
+{
+	const uint32_t width = PostProcess::GetPtr()->GetWidth(), height = PostProcess::GetPtr()->GetHeight();
+	GBufferTargets gBuffer;
+
+	// Albedo and shininess, stored as sRGB so the dark colors keep their precision in 8 bits (the geometry pass turns on
+	// the framebuffer's sRGB encoding, otherwise the linear albedo would be written as it is and darkened when read back)
+	gBuffer.m_albedo = builder.CreateTexture("GBufferAlbedo", { width, height, GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE });
+
+	// Specular color and how much of the albedo the ambient light picks up
+	gBuffer.m_specular = builder.CreateTexture("GBufferSpecular", { width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE });
+
+	// Octahedral encoded normal, with 16 bits per axis split over two channels
+	gBuffer.m_normal = builder.CreateTexture("GBufferNormal", { width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE });
+
+	gBuffer.m_depth = builder.CreateTexture("GBufferDepth", { width, height, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, 
+		GL_FLOAT });
+
+	builder.Write(gBuffer.m_albedo, GL_COLOR_ATTACHMENT0);
+	builder.Write(gBuffer.m_specular, GL_COLOR_ATTACHMENT1);
+	builder.Write(gBuffer.m_normal, GL_COLOR_ATTACHMENT2);
+	builder.Write(gBuffer.m_depth, GL_DEPTH_ATTACHMENT);
+
+	return gBuffer;
+}
+
+void DeferredShading::ReadGBuffer(RenderPassBuilder& builder, const GBufferTargets& gBuffer) const
+{
+	builder.Read(gBuffer.m_albedo);
+	builder.Read(gBuffer.m_specular);
+	builder.Read(gBuffer.m_normal);
+	builder.Read(gBuffer.m_depth);
+}
+
+void DeferredShading::BeginGeometryPass(const RenderPassContext& context, const glm::mat4& vpMatrix) const
+{
+	context.GetFramebuffer()->BindBuffer();
+	glViewport(0, 0, PostProcess::GetPtr()->GetRenderWidth(), PostProcess::GetPtr()->GetRenderHeight());
+
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// Only the sRGB albedo target is affected, the other targets hold plain data
+	glEnable(GL_FRAMEBUFFER_SRGB);
+
+	Resource::GetShader("GBuffer")->BindShader();
+	Resource::GetBoundShader()->SetUniform("vpMatrix", vpMatrix);
+}
+
+void DeferredShading::EndGeometryPass() const
+{
+	glDisable(GL_FRAMEBUFFER_SRGB);
+}
+
+void DeferredShading::BeginLightingPass(const RenderPassContext& context, const GBufferTargets& gBuffer, 
+	RenderResource shadowMap, const glm::mat4& vpMatrix, const glm::vec3& cameraPos) const
+{
+	PostProcess::GetPtr()->RenderToFBO(context);
+
+	Resource::GetShader("DeferredLighting")->BindShader();
+	Resource::GetBoundShader()->SetUniform("inverseVP", glm::inverse(vpMatrix));
+	Resource::GetBoundShader()->SetUniform("lightMatrixVP", ShadowGeneration::GetPtr()->GetLightMatrix());
+	Resource::GetBoundShader()->SetUniform("cameraPos", cameraPos);
+	Resource::GetBoundShader()->SetUniform("renderSize", glm::vec2((float)PostProcess::GetPtr()->GetRenderWidth(),
+		(float)PostProcess::GetPtr()->GetRenderHeight()));
+
+	context.GetTexture(gBuffer.m_albedo)->BindBuffer("gAlbedo", 0);
+	context.GetTexture(gBuffer.m_specular)->BindBuffer("gSpecular", 1);
+	context.GetTexture(gBuffer.m_normal)->BindBuffer("gNormal", 2);
+	context.GetTexture(gBuffer.m_depth)->BindBuffer("gDepth", 3);
+
+	ShadowGeneration::GetPtr()->BindShadowMaps(context.GetTexture(shadowMap));
+	ClusteredLighting::GetPtr()->BindLightData();
+}
+
+void DeferredShading::RenderLightingPass() const
+{
+	// The lighting shader writes out the G-buffer depth, so every pixel has to pass
+	glDepthFunc(GL_ALWAYS);
+	ObjectRenderer::GetPtr()->RenderQuad();
+	glDepthFunc(GL_LESS);
+}
\ No newline at end of file
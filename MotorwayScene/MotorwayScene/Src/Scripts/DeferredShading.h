@@ -0,0 +1,50 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "Graphics/RenderGraph.h"
+
+struct GBufferTargets
+{
+	RenderResource m_albedo, m_specular, m_normal, m_depth;
+};
+
+class DeferredShading
+{
+private:
+	DeferredShading();
+	~DeferredShading();
+
+	void InitScript();
+public:
+	static DeferredShading* GetPtr();
+
+	// Declares the G-buffer targets as transient textures written by the pass being built
+	GBufferTargets CreateGBuffer(RenderPassBuilder& builder) const;
+	void ReadGBuffer(RenderPassBuilder& builder, const GBufferTargets& gBuffer) const;
+
+	/*
+		BeginGeometryPass() : Binds and clears the G-buffer, then binds the G-buffer shader so the opaque objects can be 
+		drawn as normal with their materials. The albedo is sRGB encoded as it's written until EndGeometryPass().
+		[context] - The context of the pass that created the G-buffer
+		[vpMatrix] - The camera's view projection matrix
+	*/
+	void BeginGeometryPass(const RenderPassContext& context, const glm::mat4& vpMatrix) const;
+	void EndGeometryPass() const;
+
+	/*
+		BeginLightingPass() : Binds the pass's scene framebuffer and the lighting shader along with the G-buffer, shadow
+		map and point light data. The directional light and sky color uniforms are left to the caller, then
+		RenderLightingPass() lights the scene.
+		[context] - The context of a pass that reads the G-buffer and shadow map, and draws to the scene
+		[gBuffer] - The G-buffer targets
+		[shadowMap] - The shadow map
+		[vpMatrix] - The camera's view projection matrix, used to rebuild each pixel's position from its depth
+		[cameraPos] - The camera's position
+	*/
+	void BeginLightingPass(const RenderPassContext& context, const GBufferTargets& gBuffer, RenderResource shadowMap,
+		const glm::mat4& vpMatrix, const glm::vec3& cameraPos) const;
+
+	// Lights every pixel of the G-buffer, also copying its depth across so forward objects can still be drawn afterwards
+	void RenderLightingPass() const;
+};
\ No newline at end of file
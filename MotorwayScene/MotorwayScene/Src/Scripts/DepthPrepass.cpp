@@ -0,0 +1,117 @@
+#include "DepthPrepass.h"
+#include "Utils/ResourceManager.h"
+
+#include <glad/glad.h>
+
+DepthPrepass::DepthPrepass() :
+	m_frameIndex(0), m_prepassRecorded(), m_stats(), m_enabled(false)
+{
+	this->InitScript();
+}
+
+DepthPrepass::~DepthPrepass()
+{
+	glDeleteQueries(2 * NUM_QUERY_TYPES, &m_queries[0][0]);
+}
+
+DepthPrepass* DepthPrepass::GetPtr()
+{
+	static DepthPrepass singleton;
+	return &singleton;
+}
+
+void DepthPrepass::InitScript()
+{
+	glGenQueries(2 * NUM_QUERY_TYPES, &m_queries[0][0]);
+}
+
+void DepthPrepass::GatherStats() const
+{
+	if (m_frameIndex < 2)
+		return;
+
+	// These are the queries from two frames ago which are about to be reused, if they still haven't arrived the previous
+	// stats are kept rather than stalling
+	// The shading pass's end timestamp is the last query written, so once it's arrived the rest have too
+	const uint32_t prevFrame = m_frameIndex & 1;
+	GLuint resultAvailable = GL_FALSE;
+	glGetQueryObjectuiv(m_queries[prevFrame][SHADING_END], GL_QUERY_RESULT_AVAILABLE, &resultAvailable);
+	if (!resultAvailable)
+		return;
+
+	auto getElapsedTime = [this, prevFrame](QueryType startQuery, QueryType endQuery)
+	{
+		GLuint64 startTime = 0, endTime = 0;
+		glGetQueryObjectui64v(m_queries[prevFrame][startQuery], GL_QUERY_RESULT, &startTime);
+		glGetQueryObjectui64v(m_queries[prevFrame][endQuery], GL_QUERY_RESULT, &endTime);
+		return (endTime > startTime) ? (float)(endTime - startTime) / 1000000.0f : 0.0f;
+	};
+
+	m_stats.m_shadingTime = getElapsedTime(SHADING_START, SHADING_END);
+	m_stats.m_prepassTime = m_prepassRecorded[prevFrame] ? getElapsedTime(PREPASS_START, PREPASS_END) : 0.0f;
+
+	glGetQueryObjectuiv(m_queries[prevFrame][SHADED_SAMPLES], GL_QUERY_RESULT, &m_stats.m_samplesShaded);
+}
+
+void DepthPrepass::BeginPrepass(const glm::mat4& vpMatrix) const
+{
+	glQueryCounter(m_queries[m_frameIndex & 1][PREPASS_START], GL_TIMESTAMP);
+
+	// The light matrix uniform is just reused for the camera's matrix
+	Resource::GetShader("DepthMapping")->BindShader();
+	Resource::GetBoundShader()->SetUniform("lightMatrixVP", vpMatrix);
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+}
+
+void DepthPrepass::EndPrepass() const
+{
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glQueryCounter(m_queries[m_frameIndex & 1][PREPASS_END], GL_TIMESTAMP);
+
+	m_prepassRecorded[m_frameIndex & 1] = true;
+}
+
+void DepthPrepass::BeginShadingPass() const
+{
+	glQueryCounter(m_queries[m_frameIndex & 1][SHADING_START], GL_TIMESTAMP);
+	glBeginQuery(GL_SAMPLES_PASSED, m_queries[m_frameIndex & 1][SHADED_SAMPLES]);
+
+	if (m_prepassRecorded[m_frameIndex & 1])
+	{
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+	}
+}
+
+void DepthPrepass::EndShadingPass() const
+{
+	if (m_prepassRecorded[m_frameIndex & 1])
+	{
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_TRUE);
+	}
+
+	glEndQuery(GL_SAMPLES_PASSED);
+	glQueryCounter(m_queries[m_frameIndex & 1][SHADING_END], GL_TIMESTAMP);
+
+	// Move onto the next frame's queries
+	m_frameIndex++;
+	this->GatherStats();
+	m_prepassRecorded[m_frameIndex & 1] = false;
+}
+
+void DepthPrepass::SetEnabled(bool enabled)
+{
+	m_enabled = enabled;
+}
+
+const bool& DepthPrepass::IsEnabled() const
+{
+	return m_enabled;
+}
+
+const PrepassStats& DepthPrepass::GetStats() const
+{
+	return m_stats;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+
+struct PrepassStats
+{
+	float m_prepassTime, m_shadingTime; // In milliseconds
+	uint32_t m_samplesShaded; // Compare against the number of MSAA samples in the target to see how much overdraw is left
+};
+
+class DepthPrepass
+{
+private:
+	// The times are timestamp pairs rather than elapsed time queries, which can't be nested and so would break whenever
+	// a pass timer was running around the pre-pass
+	enum QueryType
+	{
+		PREPASS_START,
+		PREPASS_END,
+		SHADING_START,
+		SHADING_END,
+		SHADED_SAMPLES,
+		NUM_QUERY_TYPES
+	};
+
+	uint32_t m_queries[2][NUM_QUERY_TYPES]; // Ping-ponged so that last frame's results are read while this frame's are recorded
+	mutable uint32_t m_frameIndex;
+	mutable bool m_prepassRecorded[2];
+
+	mutable PrepassStats m_stats;
+	bool m_enabled;
+private:
+	DepthPrepass();
+	~DepthPrepass();
+
+	void InitScript();
+	void GatherStats() const;
+public:
+	static DepthPrepass* GetPtr();
+
+	// Binds the position only program, the opaque objects should be drawn after this to lay down the depth buffer
+	void BeginPrepass(const glm::mat4& vpMatrix) const;
+	void EndPrepass() const;
+
+	/*
+		BeginShadingPass() : Starts the stats queries for the shading pass, when the pre-pass is enabled this also switches
+		the depth test to GL_EQUAL with depth writes off so each sample is only shaded once.
+		NOTE: EndShadingPass() must be called before drawing anything that wasn't in the pre-pass.
+	*/
+	void BeginShadingPass() const;
+	void EndShadingPass() const;
+
+	void SetEnabled(bool enabled);
+public:
+	const bool& IsEnabled() const;
+	const PrepassStats& GetStats() const;
+};
@@ -0,0 +1,209 @@
+#include "OcclusionCulling.h"
+#include "Utils/ResourceManager.h"
+#include "Utils/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	constexpr uint32_t DEPTH_BUFFER_WIDTH = 256;
+	constexpr uint32_t DEPTH_BUFFER_HEIGHT = 128;
+
+	constexpr float OCCLUDER_MAX_DISTANCE = 60.0f;
+	constexpr size_t MAX_OCCLUDERS = 512;
+	constexpr uint32_t INSTANCES_PER_JOB = 512;
+
+	// The 12 triangles of a box, indexing into the corners given by Bounds::GetCorners()
+	constexpr uint32_t BOX_INDICES[] =
+	{
+		0, 1, 3, 0, 3, 2, // Front face
+		4, 6, 7, 4, 7, 5, // Back face
+		0, 2, 6, 0, 6, 4, // Left face
+		1, 5, 7, 1, 7, 3, // Right face
+		2, 3, 7, 2, 7, 6, // Top face
+		0, 4, 5, 0, 5, 1  // Bottom face
+	};
+}
+
+OcclusionCulling::OcclusionCulling() :
+	m_depthBuffer(DEPTH_BUFFER_WIDTH, DEPTH_BUFFER_HEIGHT), m_stats(), m_enabled(true)
+{}
+
+OcclusionCulling::~OcclusionCulling() {}
+
+OcclusionCulling* OcclusionCulling::GetPtr()
+{
+	static OcclusionCulling singleton;
+	return &singleton;
+}
+
+void OcclusionCulling::RegisterInstances(const std::string& modelKey, const std::vector<glm::mat4>& transforms, 
+	bool isOccluder, const BoundingBox& occluderFraction)
+{
+	const BoundingBox& modelBounds = Resource::GetModel(modelKey)->GetBounds();
+	const glm::vec3 modelSize = modelBounds.m_max - modelBounds.m_min;
+
+	InstanceGroup group;
+	group.m_modelKey = modelKey;
+	group.m_transforms = transforms;
+	group.m_visibility.resize(transforms.size(), 1);
+	group.m_isOccluder = isOccluder;
+	group.m_occluderBounds = { modelBounds.m_min + modelSize * occluderFraction.m_min, 
+		modelBounds.m_min + modelSize * occluderFraction.m_max };
+
+	// The instances never move, so their world bounds only need working out once
+	group.m_worldBounds.reserve(transforms.size());
+	for (const auto& transform : transforms)
+		group.m_worldBounds.emplace_back(Bounds::Transform(modelBounds, transform));
+
+	const auto previous = std::find_if(m_groups.begin(), m_groups.end(), 
+		[&](const InstanceGroup& existing) { return existing.m_modelKey == modelKey; });
+	if (previous != m_groups.end())
+		*previous = std::move(group);
+	else
+		m_groups.emplace_back(std::move(group));
+}
+
+void OcclusionCulling::CullInstances(const glm::mat4& vpMatrix, const glm::vec3& viewPos)
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	m_stats = CullingStats();
+
+	const auto frustumPlanes = Bounds::ExtractFrustumPlanes(vpMatrix);
+
+	FrameVector<glm::vec3> occluderVertices;
+	occluderVertices.reserve(MAX_OCCLUDERS * (sizeof(BOX_INDICES) / sizeof(uint32_t)));
+
+	m_depthBuffer.Clear();
+	this->GatherOccluders(frustumPlanes, viewPos, occluderVertices);
+	m_depthBuffer.RasterizeOccluders(occluderVertices.data(), occluderVertices.size(), vpMatrix);
+
+	for (auto& group : m_groups)
+		this->CullGroup(group, frustumPlanes, vpMatrix);
+
+	const auto endTime = std::chrono::high_resolution_clock::now();
+	m_stats.m_cullingTime = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+}
+
+void OcclusionCulling::GatherOccluders(const std::array<glm::vec4, 6>& frustumPlanes, const glm::vec3& viewPos,
+	FrameVector<glm::vec3>& occluderVertices)
+{
+	size_t numCandidates = 0;
+	for (const auto& group : m_groups)
+		numCandidates += group.m_isOccluder ? group.m_transforms.size() : 0;
+
+	FrameVector<std::pair<float, const glm::mat4*>> occluderCandidates;
+	occluderCandidates.reserve(numCandidates);
+
+	// Only the closest instances are worth rasterizing, as they cover the most of the screen
+	for (const auto& group : m_groups)
+	{
+		if (!group.m_isOccluder)
+			continue;
+
+		for (size_t i = 0; i < group.m_transforms.size(); i++)
+		{
+			const BoundingBox& bounds = group.m_worldBounds[i];
+			const float distance = glm::length(((bounds.m_min + bounds.m_max) * 0.5f) - viewPos);
+
+			if (distance < OCCLUDER_MAX_DISTANCE && Bounds::IsInsideFrustum(bounds, frustumPlanes))
+				occluderCandidates.emplace_back(distance, &group.m_transforms[i]);
+		}
+	}
+
+	if (occluderCandidates.size() > MAX_OCCLUDERS)
+	{
+		std::nth_element(occluderCandidates.begin(), occluderCandidates.begin() + MAX_OCCLUDERS, 
+			occluderCandidates.end());
+		occluderCandidates.resize(MAX_OCCLUDERS);
+	}
+
+	// Find which group each candidate came from, so the right proxy box is used
+	for (const auto& group : m_groups)
+	{
+		if (!group.m_isOccluder || group.m_transforms.empty())
+			continue;
+
+		const glm::mat4* firstTransform = &group.m_transforms.front();
+		const glm::mat4* lastTransform = &group.m_transforms.back();
+
+		for (const auto& candidate : occluderCandidates)
+		{
+			if (candidate.second < firstTransform || candidate.second > lastTransform)
+				continue;
+
+			const auto corners = Bounds::GetCorners(group.m_occluderBounds, *candidate.second);
+			for (const uint32_t index : BOX_INDICES)
+				occluderVertices.emplace_back(corners[index]);
+		}
+	}
+
+	m_stats.m_numOccluders = (uint32_t)occluderCandidates.size();
+}
+
+void OcclusionCulling::CullGroup(InstanceGroup& group, const std::array<glm::vec4, 6>& frustumPlanes, 
+	const glm::mat4& vpMatrix)
+{
+	const uint32_t numInstances = (uint32_t)group.m_transforms.size();
+	const uint32_t numJobs = (numInstances + INSTANCES_PER_JOB - 1) / INSTANCES_PER_JOB;
+
+	// 0 = outside the frustum, 1 = hidden behind an occluder, 2 = visible
+	Jobs::ParallelFor(numJobs, [&](uint32_t job)
+	{
+		const uint32_t lastInstance = std::min((job + 1) * INSTANCES_PER_JOB, numInstances);
+		for (uint32_t i = job * INSTANCES_PER_JOB; i < lastInstance; i++)
+		{
+			if (!Bounds::IsInsideFrustum(group.m_worldBounds[i], frustumPlanes))
+				group.m_visibility[i] = 0;
+			else
+				group.m_visibility[i] = m_depthBuffer.IsVisible(group.m_worldBounds[i], vpMatrix) ? 2 : 1;
+		}
+	});
+
+	// Compacting on the main thread keeps the instance order the same every frame, and the result only has to last
+	// until it's uploaded below, so it's made in the frame arena
+	FrameVector<glm::mat4> visibleTransforms;
+	visibleTransforms.reserve(numInstances);
+
+	for (uint32_t i = 0; i < numInstances; i++)
+	{
+		switch (group.m_visibility[i])
+		{
+		case 0:
+			m_stats.m_numFrustumCulled++;
+			break;
+		case 1:
+			m_stats.m_numOcclusionCulled++;
+			break;
+		default:
+			visibleTransforms.emplace_back(group.m_transforms[i]);
+			break;
+		}
+	}
+
+	m_stats.m_numTested += numInstances;
+	m_stats.m_numVisible += (uint32_t)visibleTransforms.size();
+
+	Resource::GetModel(group.m_modelKey)->SetVisibleInstances(visibleTransforms.data(), visibleTransforms.size());
+}
+
+void OcclusionCulling::SetEnabled(bool enabled)
+{
+	m_enabled = enabled;
+}
+
+const bool& OcclusionCulling::IsEnabled() const
+{
+	return m_enabled;
+}
+
+const CullingStats& OcclusionCulling::GetStats() const
+{
+	return m_stats;
+}
+
+const HierarchicalDepthBuffer& OcclusionCulling::GetDepthBuffer() const
+{
+	return m_depthBuffer;
+}
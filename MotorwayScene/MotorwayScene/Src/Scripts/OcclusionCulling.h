@@ -0,0 +1,68 @@
+#pragma once
+#include "Graphics/HierarchicalDepth.h"
+#include "Utils/FrameArena.h"
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdint>
+
+struct CullingStats
+{
+	uint32_t m_numTested, m_numFrustumCulled, m_numOcclusionCulled, m_numVisible;
+	uint32_t m_numOccluders;
+	float m_cullingTime; // In milliseconds
+};
+
+class OcclusionCulling
+{
+private:
+	struct InstanceGroup
+	{
+		std::string m_modelKey;
+
+		std::vector<glm::mat4> m_transforms;
+		std::vector<BoundingBox> m_worldBounds;
+		std::vector<uint8_t> m_visibility;
+
+		bool m_isOccluder;
+		BoundingBox m_occluderBounds; // The proxy box in model space, this should sit fully inside the real geometry
+	};
+
+	std::vector<InstanceGroup> m_groups;
+	HierarchicalDepthBuffer m_depthBuffer;
+
+	CullingStats m_stats;
+	bool m_enabled;
+private:
+	OcclusionCulling();
+	~OcclusionCulling();
+
+	// The occluders' triangles are added to the vertices given, which are taken from the frame arena
+	void GatherOccluders(const std::array<glm::vec4, 6>& frustumPlanes, const glm::vec3& viewPos,
+		FrameVector<glm::vec3>& occluderVertices);
+	void CullGroup(InstanceGroup& group, const std::array<glm::vec4, 6>& frustumPlanes, const glm::mat4& vpMatrix);
+public:
+	static OcclusionCulling* GetPtr();
+
+	/*
+		RegisterInstances() : Hands the instances of a loaded model over to the culling system, registering the same
+		model again replaces its instances.
+		[modelKey] - The key of the model, it must have been loaded with the same transformations
+		[transforms] - The model matrices of every instance
+		[isOccluder] - Whether the instances should also be rasterized as occluders
+		[occluderFraction] - The occluder proxy as a fraction of the model bounds, e.g. (0.25, 0.5, 0.25) to (0.75, 1, 0.75)
+	*/
+	void RegisterInstances(const std::string& modelKey, const std::vector<glm::mat4>& transforms, bool isOccluder = false,
+		const BoundingBox& occluderFraction = { glm::vec3(0.0f), glm::vec3(1.0f) });
+
+	// Culls every registered group against the camera and uploads the survivors as the models' visible instances
+	void CullInstances(const glm::mat4& vpMatrix, const glm::vec3& viewPos);
+
+	void SetEnabled(bool enabled);
+public:
+	const bool& IsEnabled() const;
+	const CullingStats& GetStats() const;
+	const HierarchicalDepthBuffer& GetDepthBuffer() const;
+};
@@ -0,0 +1,285 @@
+#include "OcclusionQueries.h"
+#include "Graphics/VertexArray.h"
+#include "Utils/ResourceManager.h"
+
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+
+namespace
+{
+	constexpr float CLUSTER_CELL_SIZE = 40.0f;
+	constexpr uint32_t MAX_CLUSTER_INSTANCES = 32;
+
+	// Added to every box so that the camera's near plane clipping the box doesn't hide the cluster
+	constexpr float CAMERA_INSIDE_MARGIN = 0.5f;
+}
+
+OcclusionQueries::OcclusionQueries() :
+	m_frameIndex(0), m_lastIssuedFrame(0), m_hasPrevResults(false), m_stats()
+{
+	this->InitScript();
+}
+
+OcclusionQueries::~OcclusionQueries()
+{
+	for (auto& group : m_groups)
+	{
+		for (auto& cluster : group.m_clusters)
+			glDeleteQueries(2, cluster.m_queries);
+	}
+}
+
+OcclusionQueries* OcclusionQueries::GetPtr()
+{
+	static OcclusionQueries singleton;
+	return &singleton;
+}
+
+void OcclusionQueries::InitScript()
+{
+	Resource::LoadShader("BoundingVolume", "Resources/Shaders/BoundingVolume.glsl.vsh", 
+		"Resources/Shaders/BoundingVolume.glsl.fsh");
+
+	// A unit box with its corners in the same order as Bounds::GetCorners()
+	float vertexPosData[24];
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		vertexPosData[i * 3] = (i & 1) ? 1.0f : 0.0f;
+		vertexPosData[i * 3 + 1] = (i & 2) ? 1.0f : 0.0f;
+		vertexPosData[i * 3 + 2] = (i & 4) ? 1.0f : 0.0f;
+	}
+
+	const uint32_t indexData[]
+	{
+		0, 1, 3, 0, 3, 2,
+		4, 6, 7, 4, 7, 5,
+		0, 2, 6, 0, 6, 4,
+		1, 5, 7, 1, 7, 3,
+		2, 3, 7, 2, 7, 6,
+		0, 4, 5, 0, 5, 1
+	};
+
+	m_boxVBO = Buffer::GenerateVBO(vertexPosData, sizeof(vertexPosData), GL_STATIC_DRAW);
+	m_boxIBO = Buffer::GenerateIBO(indexData, sizeof(indexData), GL_STATIC_DRAW);
+
+	m_boxVAO = Buffer::GenerateVAO();
+	m_boxVAO->PushAttribLayout<float>(0, 3, 3 * sizeof(float));
+	m_boxVAO->AttachBufferObjects(m_boxVBO, m_boxIBO);
+
+	m_boxVBO->SetLabel("Occlusion box vertices");
+	m_boxIBO->SetLabel("Occlusion box indices");
+	m_boxVAO->SetLabel("Occlusion box");
+}
+
+glm::ivec2 OcclusionQueries::GetClusterCell(const glm::mat4& transform) const
+{
+	const glm::vec3 position = glm::vec3(transform[3]);
+	return glm::ivec2((int)std::floor(position.x / CLUSTER_CELL_SIZE), (int)std::floor(position.z / CLUSTER_CELL_SIZE));
+}
+
+void OcclusionQueries::SortIntoClusters(std::vector<glm::mat4>& transforms) const
+{
+	std::stable_sort(transforms.begin(), transforms.end(), [this](const glm::mat4& first, const glm::mat4& second)
+	{
+		const glm::ivec2 firstCell = this->GetClusterCell(first);
+		const glm::ivec2 secondCell = this->GetClusterCell(second);
+
+		return (firstCell.y != secondCell.y) ? firstCell.y < secondCell.y : firstCell.x < secondCell.x;
+	});
+}
+
+void OcclusionQueries::RegisterClusters(const std::string& modelKey, const std::vector<glm::mat4>& sortedTransforms)
+{
+	const BoundingBox& modelBounds = Resource::GetModel(modelKey)->GetBounds();
+
+	const auto previous = std::find_if(m_groups.begin(), m_groups.end(), 
+		[&](const ClusterGroup& group) { return group.m_modelKey == modelKey; });
+	if (previous != m_groups.end())
+	{
+		for (auto& cluster : previous->m_clusters)
+			glDeleteQueries(2, cluster.m_queries);
+
+		m_stats.m_numClusters -= (uint32_t)previous->m_clusters.size();
+		m_groups.erase(previous);
+
+		// The new queries have never been issued, so nothing can be conditionally drawn on them until next frame
+		m_lastIssuedFrame = 0;
+	}
+
+	ClusterGroup group;
+	group.m_numVisibleInstances = 0;
+	group.m_modelKey = modelKey;
+
+	for (uint32_t i = 0; i < (uint32_t)sortedTransforms.size(); i++)
+	{
+		const BoundingBox instanceBounds = Bounds::Transform(modelBounds, sortedTransforms[i]);
+
+		// Start a new cluster when the grid cell changes or the current cluster is full
+		const bool newCluster = group.m_clusters.empty() || 
+			group.m_clusters.back().m_numInstances == MAX_CLUSTER_INSTANCES ||
+			this->GetClusterCell(sortedTransforms[i]) != this->GetClusterCell(sortedTransforms[i - 1]);
+
+		if (newCluster)
+		{
+			InstanceCluster cluster;
+			cluster.m_firstInstance = i;
+			cluster.m_numInstances = 1;
+			cluster.m_bounds = instanceBounds;
+			glGenQueries(2, cluster.m_queries);
+
+			group.m_clusters.emplace_back(cluster);
+		}
+		else
+		{
+			group.m_clusters.back().m_numInstances++;
+			group.m_clusters.back().m_bounds = Bounds::Merge(group.m_clusters.back().m_bounds, instanceBounds);
+		}
+	}
+
+	m_stats.m_numClusters += (uint32_t)group.m_clusters.size();
+	m_groups.emplace_back(std::move(group));
+}
+
+void OcclusionQueries::BeginFrame() const
+{
+	m_frameIndex++;
+	m_stats.m_numVisibleClusters = 0;
+	for (const auto& group : m_groups)
+		group.m_numVisibleInstances = 0;
+
+	// The previous results are only usable if the queries were issued last frame, otherwise they're stale
+	m_hasPrevResults = (m_frameIndex > 1 && m_lastIssuedFrame == m_frameIndex - 1);
+	if (!m_hasPrevResults)
+		return;
+
+	// Count how many clusters were visible last frame, without waiting on any results that haven't arrived
+	const uint32_t prevQuery = (m_frameIndex + 1) & 1;
+	for (const auto& group : m_groups)
+	{
+		for (const auto& cluster : group.m_clusters)
+		{
+			GLuint resultAvailable = GL_FALSE, result = GL_TRUE;
+			glGetQueryObjectuiv(cluster.m_queries[prevQuery], GL_QUERY_RESULT_AVAILABLE, &resultAvailable);
+			if (resultAvailable)
+				glGetQueryObjectuiv(cluster.m_queries[prevQuery], GL_QUERY_RESULT, &result);
+
+			if (result)
+			{
+				m_stats.m_numVisibleClusters++;
+				group.m_numVisibleInstances += cluster.m_numInstances;
+			}
+		}
+	}
+}
+
+void OcclusionQueries::RenderClusters(const std::string& modelKey, const std::string& structUniform, 
+	const glm::vec3& viewPos, bool depthOnly) const
+{
+	const auto groupIterator = std::find_if(m_groups.begin(), m_groups.end(), 
+		[&](const ClusterGroup& group) { return group.m_modelKey == modelKey; });
+	if (groupIterator == m_groups.end())
+		return;
+
+	const auto& clusters = groupIterator->m_clusters;
+	const uint32_t prevQuery = (m_frameIndex + 1) & 1;
+
+	// Sorting near to far lets the closer clusters fill the depth buffer before the further ones are shaded
+	m_drawOrder.resize(clusters.size());
+	for (uint32_t i = 0; i < (uint32_t)clusters.size(); i++)
+		m_drawOrder[i] = i;
+
+	std::sort(m_drawOrder.begin(), m_drawOrder.end(), [&](uint32_t first, uint32_t second)
+	{
+		const auto& firstBounds = clusters[first].m_bounds;
+		const auto& secondBounds = clusters[second].m_bounds;
+		return glm::length((firstBounds.m_min + firstBounds.m_max) * 0.5f - viewPos) < 
+			glm::length((secondBounds.m_min + secondBounds.m_max) * 0.5f - viewPos);
+	});
+
+	auto currentShader = ShaderManager::GetPtr()->GetBoundShader();
+	for (const auto& mesh : Resource::GetModel(modelKey)->GetMeshes())
+	{
+		if (!depthOnly)
+			mesh.BindMaterial(structUniform);
+
+		currentShader->SetUniform("usingInstancing", true);
+
+		for (const uint32_t index : m_drawOrder)
+		{
+			const auto& cluster = clusters[index];
+			const bool cameraInside = glm::all(glm::greaterThan(viewPos, cluster.m_bounds.m_min - CAMERA_INSIDE_MARGIN)) &&
+				glm::all(glm::lessThan(viewPos, cluster.m_bounds.m_max + CAMERA_INSIDE_MARGIN));
+
+			// If the previous result is still in flight the cluster is drawn anyway
+			const bool useCondition = (m_hasPrevResults && !cameraInside);
+			if (useCondition)
+				glBeginConditionalRender(cluster.m_queries[prevQuery], GL_QUERY_NO_WAIT);
+
+			mesh.DrawInstances(cluster.m_firstInstance, cluster.m_numInstances, depthOnly);
+
+			if (useCondition)
+				glEndConditionalRender();
+		}
+
+		currentShader->SetUniform("usingInstancing", false);
+	}
+}
+
+void OcclusionQueries::IssueQueries(const glm::mat4& vpMatrix) const
+{
+	const uint32_t currentQuery = m_frameIndex & 1;
+	m_lastIssuedFrame = m_frameIndex;
+
+	Resource::GetShader("BoundingVolume")->BindShader();
+	Resource::GetShader("BoundingVolume")->SetUniform("vpMatrix", vpMatrix);
+
+	// The boxes only test against the depth buffer, they mustn't show up or hide anything themselves
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	m_boxVAO->BindVertexArray();
+
+	for (const auto& group : m_groups)
+	{
+		for (const auto& cluster : group.m_clusters)
+		{
+			glm::mat4 model;
+			model = glm::translate(model, cluster.m_bounds.m_min);
+			model = glm::scale(model, cluster.m_bounds.m_max - cluster.m_bounds.m_min);
+			Resource::GetShader("BoundingVolume")->SetUniform("model", model);
+
+			glBeginQuery(GL_ANY_SAMPLES_PASSED, cluster.m_queries[currentQuery]);
+			glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
+			glEndQuery(GL_ANY_SAMPLES_PASSED);
+		}
+	}
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+}
+
+const QueryStats& OcclusionQueries::GetStats() const
+{
+	return m_stats;
+}
+
+uint32_t OcclusionQueries::GetNumVisibleInstances(const std::string& modelKey) const
+{
+	for (const auto& group : m_groups)
+	{
+		if (group.m_modelKey != modelKey)
+			continue;
+
+		// Without last frame's results every cluster is drawn
+		if (m_hasPrevResults)
+			return group.m_numVisibleInstances;
+
+		uint32_t numInstances = 0;
+		for (const auto& cluster : group.m_clusters)
+			numInstances += cluster.m_numInstances;
+
+		return numInstances;
+	}
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "Graphics/BoundingBox.h"
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+
+class VertexBuffer;
+class IndexBuffer;
+class VertexArray;
+
+struct QueryStats
+{
+	uint32_t m_numClusters;
+	uint32_t m_numVisibleClusters; // Counted from last frame's results which have already arrived
+};
+
+class OcclusionQueries
+{
+private:
+	struct InstanceCluster
+	{
+		uint32_t m_firstInstance, m_numInstances;
+		BoundingBox m_bounds;
+		uint32_t m_queries[2]; // Ping-ponged, one is issued this frame while the other is used for conditional rendering
+	};
+
+	struct ClusterGroup
+	{
+		std::string m_modelKey;
+		std::vector<InstanceCluster> m_clusters;
+		mutable uint32_t m_numVisibleInstances; // In the clusters that were visible last frame
+	};
+
+	std::vector<ClusterGroup> m_groups;
+
+	std::shared_ptr<VertexBuffer> m_boxVBO;
+	std::shared_ptr<IndexBuffer> m_boxIBO;
+	std::shared_ptr<VertexArray> m_boxVAO;
+
+	mutable uint32_t m_frameIndex, m_lastIssuedFrame;
+	mutable bool m_hasPrevResults;
+	mutable std::vector<uint32_t> m_drawOrder;
+	mutable QueryStats m_stats;
+private:
+	OcclusionQueries();
+	~OcclusionQueries();
+
+	void InitScript();
+	glm::ivec2 GetClusterCell(const glm::mat4& transform) const;
+public:
+	static OcclusionQueries* GetPtr();
+
+	// Reorders the transformations so that instances in the same grid cell are next to each other, this must be done
+	// before the model is loaded with them
+	void SortIntoClusters(std::vector<glm::mat4>& transforms) const;
+
+	// Registering a model again replaces its clusters, for when its instances are rebuilt
+	void RegisterClusters(const std::string& modelKey, const std::vector<glm::mat4>& sortedTransforms);
+
+	// Must be called once per frame before any clusters are rendered, this also gathers last frame's visibility stats
+	void BeginFrame() const;
+
+	// Draws the clusters of the model, near to far, skipping those whose bounding box was hidden last frame
+	void RenderClusters(const std::string& modelKey, const std::string& structUniform, const glm::vec3& viewPos, 
+		bool depthOnly = false) const;
+
+	// Renders every cluster's bounding box into a query, this should be done once all the opaque objects are drawn
+	void IssueQueries(const glm::mat4& vpMatrix) const;
+public:
+	const QueryStats& GetStats() const;
+	uint32_t GetNumVisibleInstances(const std::string& modelKey) const;
+};
@@ -0,0 +1,494 @@
+#include "PerformanceOverlay.h"
+#include "Graphics/BufferObjects.h"
+#include "Graphics/GpuMemory.h"
+#include "Graphics/GpuProfiler.h"
+#include "Graphics/VertexArray.h"
+#include "Utils/AllocationTracker.h"
+#include "Utils/FrameArena.h"
+#include "Utils/ResourceManager.h"
+#include "Utils/Profiler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#define NK_INCLUDE_FIXED_TYPES
+#define NK_INCLUDE_STANDARD_IO
+#define NK_INCLUDE_STANDARD_VARARGS
+#define NK_INCLUDE_DEFAULT_ALLOCATOR
+#define NK_INCLUDE_VERTEX_BUFFER_OUTPUT
+#define NK_INCLUDE_FONT_BAKING
+#define NK_INCLUDE_DEFAULT_FONT
+#define NK_IMPLEMENTATION
+#include <nuklear.h>
+
+namespace Config
+{
+	constexpr uint32_t FRAME_HISTORY_LENGTH = 120;
+	constexpr float GRAPH_MAX_TIME = 33.3f; // The graphs are clamped to this many milliseconds, which is 30 fps
+
+	constexpr float FONT_HEIGHT = 13.0f;
+	constexpr float MAX_WINDOW_WIDTH = 340.0f;
+	constexpr float MAX_WINDOW_HEIGHT = 720.0f;
+	constexpr float WINDOW_MARGIN = 10.0f;
+
+	constexpr uint32_t NUM_MEMORY_CONSUMERS = 5; // How many of the biggest GPU objects are listed
+}
+
+namespace
+{
+	// The extensions the driver reports its memory through, both of which are in kilobytes
+	constexpr GLenum GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX = 0x9048;
+	constexpr GLenum GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX = 0x9049;
+	constexpr GLenum TEXTURE_FREE_MEMORY_ATI = 0x87FC;
+
+	struct OverlayVertex
+	{
+		float m_position[2];
+		float m_uv[2];
+		nk_byte m_color[4];
+	};
+
+	bool HasExtension(const char* name)
+	{
+		GLint numExtensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+		for (GLint i = 0; i < numExtensions; i++)
+		{
+			if (std::strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	void PushHistory(FrameHistory& history, float value)
+	{
+		history.m_times[history.m_next] = value;
+		history.m_next = (history.m_next + 1) % Config::FRAME_HISTORY_LENGTH;
+		history.m_count = std::min(history.m_count + 1, Config::FRAME_HISTORY_LENGTH);
+	}
+
+	float GetLatest(const FrameHistory& history)
+	{
+		if (history.m_count == 0)
+			return 0.0f;
+
+		return history.m_times[(history.m_next + Config::FRAME_HISTORY_LENGTH - 1) % Config::FRAME_HISTORY_LENGTH];
+	}
+
+	// The string is made in the frame arena, it only has to last until nuklear has copied it into its command buffer
+	const char* FormatMegabytes(size_t bytes)
+	{
+		return FrameArena::GetPtr()->Format("%.1f MB", (double)bytes / (1024.0 * 1024.0));
+	}
+
+	// Label and value side by side, which is how every stat in the overlay is laid out
+	void StatRow(nk_context* context, const char* label, const char* format, ...)
+	{
+		char value[64];
+		va_list args;
+		va_start(args, format);
+		vsnprintf(value, sizeof(value), format, args);
+		va_end(args);
+
+		nk_layout_row_dynamic(context, Config::FONT_HEIGHT + 4.0f, 2);
+		nk_label(context, label, NK_TEXT_LEFT);
+		nk_label(context, value, NK_TEXT_RIGHT);
+	}
+
+	void HistoryGraph(nk_context* context, const FrameHistory& history, nk_color color)
+	{
+		nk_layout_row_dynamic(context, 60.0f, 1);
+		if (nk_chart_begin_colored(context, NK_CHART_LINES, color, color, (int)Config::FRAME_HISTORY_LENGTH, 0.0f,
+			Config::GRAPH_MAX_TIME))
+		{
+			// Oldest first, which is where the next time would go once the ring is full
+			const uint32_t oldest = (history.m_next + Config::FRAME_HISTORY_LENGTH - history.m_count) % 
+				Config::FRAME_HISTORY_LENGTH;
+			for (uint32_t i = 0; i < history.m_count; i++)
+			{
+				const float time = history.m_times[(oldest + i) % Config::FRAME_HISTORY_LENGTH];
+				nk_chart_push(context, std::min(time, Config::GRAPH_MAX_TIME));
+			}
+
+			nk_chart_end(context);
+		}
+	}
+}
+
+struct OverlayContext
+{
+	nk_context m_context;
+	nk_font_atlas m_atlas;
+	nk_draw_null_texture m_nullTexture;
+	nk_buffer m_commands;
+	nk_buffer m_vertices, m_elements; // Cleared rather than freed after each frame, so their memory is reused
+};
+
+PerformanceOverlay::PerformanceOverlay() :
+	m_context(std::make_unique<OverlayContext>()), m_visible(false), m_frameTimes(), m_gpuFrameTimes(), 
+	m_renderTargetBytes(0), m_hasNvidiaMemoryInfo(false), m_hasAtiMemoryInfo(false), m_overlayCpuTime(0.0f), 
+	m_overlayCounters()
+{
+	this->InitScript();
+}
+
+PerformanceOverlay::~PerformanceOverlay() 
+{
+	nk_buffer_free(&m_context->m_commands);
+	nk_buffer_free(&m_context->m_vertices);
+	nk_buffer_free(&m_context->m_elements);
+	nk_font_atlas_clear(&m_context->m_atlas);
+	nk_free(&m_context->m_context);
+}
+
+PerformanceOverlay* PerformanceOverlay::GetPtr()
+{
+	static PerformanceOverlay singleton;
+	return &singleton;
+}
+
+void PerformanceOverlay::InitScript()
+{
+	Resource::LoadShader("Overlay", "Resources/Shaders/Overlay.glsl.vsh", "Resources/Shaders/Overlay.glsl.fsh");
+
+	// Bake the default font and upload it, the atlas also holds the white pixel that untextured shapes sample
+	nk_font_atlas_init_default(&m_context->m_atlas);
+	nk_font_atlas_begin(&m_context->m_atlas);
+	nk_font* font = nk_font_atlas_add_default(&m_context->m_atlas, Config::FONT_HEIGHT, nullptr);
+
+	int atlasWidth = 0, atlasHeight = 0;
+	const void* atlasPixels = nk_font_atlas_bake(&m_context->m_atlas, &atlasWidth, &atlasHeight, NK_FONT_ATLAS_RGBA32);
+
+	m_fontAtlas = Buffer::GenerateTBO(atlasWidth, atlasHeight, GL_RGBA8, GL_RGBA);
+	m_fontAtlas->SetFiltering(GL_LINEAR, GL_LINEAR);
+	m_fontAtlas->SetWrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+	m_fontAtlas->SetLabel("Overlay font atlas");
+
+	glBindTexture(GL_TEXTURE_2D, m_fontAtlas->GetID());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, atlasWidth, atlasHeight, GL_RGBA, GL_UNSIGNED_BYTE, atlasPixels);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	nk_font_atlas_end(&m_context->m_atlas, nk_handle_id((int)m_fontAtlas->GetID()), &m_context->m_nullTexture);
+
+	nk_init_default(&m_context->m_context, &font->handle);
+	nk_buffer_init_default(&m_context->m_commands);
+	nk_buffer_init_default(&m_context->m_vertices);
+	nk_buffer_init_default(&m_context->m_elements);
+
+	// The geometry is rebuilt every frame, so the buffers start empty and are reallocated each time they're drawn
+	m_VBO = Buffer::GenerateVBO(nullptr, 0, GL_STREAM_DRAW);
+	m_IBO = Buffer::GenerateIBO(nullptr, 0, GL_STREAM_DRAW);
+
+	m_VAO = Buffer::GenerateVAO();
+	m_VAO->PushAttribLayout<GLfloat>(0, 2, sizeof(OverlayVertex), offsetof(OverlayVertex, m_position));
+	m_VAO->PushAttribLayout<GLfloat>(1, 2, sizeof(OverlayVertex), offsetof(OverlayVertex, m_uv));
+	m_VAO->PushAttribLayout<GLubyte>(2, 4, sizeof(OverlayVertex), offsetof(OverlayVertex, m_color), 0, GL_TRUE);
+	m_VAO->AttachBufferObjects(m_VBO, m_IBO);
+
+	m_VBO->SetLabel("Overlay vertices");
+	m_IBO->SetLabel("Overlay indices");
+	m_VAO->SetLabel("Overlay");
+
+	m_hasNvidiaMemoryInfo = HasExtension("GL_NVX_gpu_memory_info");
+	m_hasAtiMemoryInfo = HasExtension("GL_ATI_meminfo");
+
+	m_frameTimes.m_times.assign(Config::FRAME_HISTORY_LENGTH, 0.0f);
+	m_gpuFrameTimes.m_times.assign(Config::FRAME_HISTORY_LENGTH, 0.0f);
+	m_lastFrameTime = std::chrono::steady_clock::now();
+}
+
+void PerformanceOverlay::RecordFrameTime()
+{
+	const auto currentTime = std::chrono::steady_clock::now();
+	const std::chrono::duration<float, std::milli> frameTime = currentTime - m_lastFrameTime;
+	m_lastFrameTime = currentTime;
+
+	PushHistory(m_frameTimes, frameTime.count());
+
+	// The GPU history only takes frames the profiler has timed, which lag a few behind
+	float gpuFrameTime = 0.0f;
+	for (const auto& timing : GpuProfiler::GetPtr()->GetTimings())
+	{
+		if (std::strcmp(timing.m_name, "ShadowGeneration") == 0 || std::strcmp(timing.m_name, "MainScene") == 0 ||
+			std::strcmp(timing.m_name, "PostProcessResolve") == 0 || std::strcmp(timing.m_name, "Overlay") == 0)
+		{
+			gpuFrameTime += timing.m_time;
+		}
+	}
+
+	PushHistory(m_gpuFrameTimes, gpuFrameTime);
+}
+
+void PerformanceOverlay::Render(uint32_t windowWidth, uint32_t windowHeight)
+{
+	// The frame times are kept while hidden, so the graphs are already filled in when it's shown
+	this->RecordFrameTime();
+	if (!m_visible)
+		return;
+
+	PROFILE_ZONE("PerformanceOverlay::Render");
+
+	const auto startTime = std::chrono::steady_clock::now();
+	const RenderCounters countersBefore = RenderStats::GetCurrentFrame();
+	GpuProfiler::GetPtr()->BeginTimer("Overlay");
+
+	this->BuildWindow(windowWidth, windowHeight);
+	this->DrawCommands(windowWidth, windowHeight);
+
+	GpuProfiler::GetPtr()->EndTimer("Overlay");
+
+	m_overlayCounters = RenderStats::GetDifference(RenderStats::GetCurrentFrame(), countersBefore);
+
+	const std::chrono::duration<float, std::milli> cpuTime = std::chrono::steady_clock::now() - startTime;
+	m_overlayCpuTime = cpuTime.count();
+}
+
+void PerformanceOverlay::BuildWindow(uint32_t windowWidth, uint32_t windowHeight)
+{
+	nk_context* context = &m_context->m_context;
+
+	// Nothing in the overlay is interactive, but nuklear still expects the input to be opened and closed every frame
+	nk_input_begin(context);
+	nk_input_end(context);
+
+	// Shrunk to fit small windows, keeping the margin on each side
+	const float windowWidthLimit = std::min(Config::MAX_WINDOW_WIDTH,
+		(float)windowWidth - (Config::WINDOW_MARGIN * 2.0f));
+	const float windowHeightLimit = std::min(Config::MAX_WINDOW_HEIGHT,
+		(float)windowHeight - (Config::WINDOW_MARGIN * 2.0f));
+
+	if (nk_begin(context, "Performance", nk_rect(Config::WINDOW_MARGIN, Config::WINDOW_MARGIN, windowWidthLimit,
+		windowHeightLimit), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_INPUT))
+	{
+		const float latestFrameTime = GetLatest(m_frameTimes);
+		StatRow(context, "Frame time", "%.2f ms (%.0f fps)", latestFrameTime, (latestFrameTime > 0.0f) ? 
+			1000.0f / latestFrameTime : 0.0f);
+		HistoryGraph(context, m_frameTimes, nk_rgb(120, 200, 120));
+
+		StatRow(context, "GPU time", "%.2f ms", GetLatest(m_gpuFrameTimes));
+		HistoryGraph(context, m_gpuFrameTimes, nk_rgb(200, 160, 90));
+
+		// The GPU timings, which trail the frame being drawn by the profiler's latency
+		nk_layout_row_dynamic(context, Config::FONT_HEIGHT + 4.0f, 1);
+		nk_label_colored(context, FrameArena::GetPtr()->Format("GPU timings (%u frames behind)", 
+			GpuProfiler::GetPtr()->GetLatency()), NK_TEXT_LEFT, nk_rgb(180, 180, 255));
+
+		for (const auto& timing : GpuProfiler::GetPtr()->GetTimings())
+		{
+			if (std::strcmp(timing.m_name, "Overlay") != 0)
+				StatRow(context, timing.m_name, "%.3f ms", timing.m_time);
+		}
+
+		// The last frame's counters include the overlay's own draws, which are taken out so the scene's stand alone
+		const RenderCounters scene = RenderStats::GetDifference(RenderStats::GetLastFrame(), m_overlayCounters);
+		nk_layout_row_dynamic(context, Config::FONT_HEIGHT + 4.0f, 1);
+		nk_label_colored(context, "Scene", NK_TEXT_LEFT, nk_rgb(180, 180, 255));
+
+		StatRow(context, "Draw calls", "%u", scene.m_drawCalls);
+		StatRow(context, "Instances", "%llu", (unsigned long long)scene.m_instances);
+		StatRow(context, "Triangles", "%llu", (unsigned long long)scene.m_triangles);
+		StatRow(context, "Buffer uploads", "%s", FormatMegabytes((size_t)scene.m_uploadBytes));
+		StatRow(context, "Texture binds", "%u", scene.m_textureBinds);
+		StatRow(context, "Program switches", "%u", scene.m_programSwitches);
+		StatRow(context, "Uniform updates", "%u", scene.m_uniformUpdates);
+		StatRow(context, "State changes", "%u", scene.m_stateChanges);
+
+		// Made by the whole of the last frame on every thread, the overlay's own included
+		const AllocationCounts& allocations = AllocationTracker::GetLastFrame();
+		StatRow(context, "Heap allocations", "%llu (%llu bytes)", (unsigned long long)allocations.m_allocations, 
+			(unsigned long long)allocations.m_bytes);
+
+		StatRow(context, "Frame arena", "%s / %s", FormatMegabytes(FrameArena::GetPtr()->GetLastFrameBytes()),
+			FormatMegabytes(FrameArena::GetPtr()->GetCapacity()));
+
+		nk_layout_row_dynamic(context, Config::FONT_HEIGHT + 4.0f, 1);
+		nk_label_colored(context, "Visible instances", NK_TEXT_LEFT, nk_rgb(180, 180, 255));
+
+		for (const auto& count : m_instanceCounts)
+			StatRow(context, count.m_modelKey.c_str(), "%u / %u", count.m_numVisible, count.m_numTotal);
+
+		this->BuildMemoryRows();
+
+		// What drawing the overlay itself costs, kept apart from everything above
+		nk_layout_row_dynamic(context, Config::FONT_HEIGHT + 4.0f, 1);
+		nk_label_colored(context, "Overlay", NK_TEXT_LEFT, nk_rgb(180, 180, 255));
+
+		StatRow(context, "CPU time", "%.3f ms", m_overlayCpuTime);
+		StatRow(context, "GPU time", "%.3f ms", std::max(GpuProfiler::GetPtr()->GetTime("Overlay"), 0.0f));
+		StatRow(context, "Draw calls", "%u", m_overlayCounters.m_drawCalls);
+	}
+
+	nk_end(context);
+}
+
+void PerformanceOverlay::BuildMemoryRows()
+{
+	nk_context* context = &m_context->m_context;
+
+	nk_layout_row_dynamic(context, Config::FONT_HEIGHT + 4.0f, 1);
+	nk_label_colored(context, "GPU memory", NK_TEXT_LEFT, nk_rgb(180, 180, 255));
+
+	if (m_hasNvidiaMemoryInfo)
+	{
+		GLint totalKilobytes = 0, availableKilobytes = 0;
+		glGetIntegerv(GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &totalKilobytes);
+		glGetIntegerv(GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &availableKilobytes);
+
+		StatRow(context, "In use", "%s / %s", FormatMegabytes((size_t)(totalKilobytes - availableKilobytes) * 1024),
+			FormatMegabytes((size_t)totalKilobytes * 1024));
+	}
+	else if (m_hasAtiMemoryInfo)
+	{
+		GLint freeMemory[4] = {}; // The total free, the largest free block, then the same two for shared memory
+		glGetIntegerv(TEXTURE_FREE_MEMORY_ATI, freeMemory);
+
+		StatRow(context, "Free", "%s", FormatMegabytes((size_t)freeMemory[0] * 1024));
+	}
+	else
+	{
+		StatRow(context, "Driver", "not reported");
+	}
+
+	// What the app itself has made, worked out from the formats and sizes it asked for
+	const GpuMemoryUsage& usage = GpuMemory::GetUsage();
+	StatRow(context, "Tracked", "%s (%u objects)", FormatMegabytes(usage.m_totalBytes), usage.m_numObjects);
+	StatRow(context, "Peak", "%s", FormatMegabytes(usage.m_peakTotalBytes));
+
+	if (GpuMemory::GetBudget() > 0)
+	{
+		StatRow(context, "Budget", "%s / %s", FormatMegabytes(usage.m_totalBytes), 
+			FormatMegabytes(GpuMemory::GetBudget()));
+	}
+
+	for (size_t i = 0; i < (size_t)GpuMemoryCategory::NUM_CATEGORIES; i++)
+	{
+		StatRow(context, GpuMemory::GetCategoryName((GpuMemoryCategory)i), "%s (peak %s)", 
+			FormatMegabytes(usage.m_bytes[i]), FormatMegabytes(usage.m_peakBytes[i]));
+	}
+
+	StatRow(context, "Render graph pool", "%s", FormatMegabytes(m_renderTargetBytes));
+
+	nk_layout_row_dynamic(context, Config::FONT_HEIGHT + 4.0f, 1);
+	nk_label_colored(context, "Largest GPU objects", NK_TEXT_LEFT, nk_rgb(180, 180, 255));
+
+	for (const GpuAllocation* allocation : GpuMemory::GetTopConsumers(Config::NUM_MEMORY_CONSUMERS))
+	{
+		StatRow(context, allocation->m_label.empty() ? "Unnamed" : allocation->m_label.c_str(), "%s", 
+			FormatMegabytes(allocation->m_bytes));
+	}
+}
+
+void PerformanceOverlay::DrawCommands(uint32_t windowWidth, uint32_t windowHeight) const
+{
+	static const nk_draw_vertex_layout_element vertexLayout[] =
+	{
+		{ NK_VERTEX_POSITION, NK_FORMAT_FLOAT, offsetof(OverlayVertex, m_position) },
+		{ NK_VERTEX_TEXCOORD, NK_FORMAT_FLOAT, offsetof(OverlayVertex, m_uv) },
+		{ NK_VERTEX_COLOR, NK_FORMAT_R8G8B8A8, offsetof(OverlayVertex, m_color) },
+		{ NK_VERTEX_LAYOUT_END }
+	};
+
+	nk_convert_config config = {};
+	config.vertex_layout = vertexLayout;
+	config.vertex_size = sizeof(OverlayVertex);
+	config.vertex_alignment = NK_ALIGNOF(OverlayVertex);
+	config.null = m_context->m_nullTexture;
+	config.circle_segment_count = config.curve_segment_count = config.arc_segment_count = 22;
+	config.global_alpha = 1.0f;
+	config.shape_AA = config.line_AA = NK_ANTI_ALIASING_ON;
+
+	nk_buffer* vertices = &m_context->m_vertices;
+	nk_buffer* elements = &m_context->m_elements;
+	nk_convert(&m_context->m_context, &m_context->m_commands, vertices, elements, &config);
+
+	m_VBO->ReallocateData(nk_buffer_memory_const(vertices), vertices->allocated, GL_STREAM_DRAW);
+	m_IBO->ReallocateData(nk_buffer_memory_const(elements), elements->allocated, GL_STREAM_DRAW);
+
+	// The scene's state is put back afterwards, the overlay is drawn last but the next frame shouldn't have to know
+	const GLboolean blendEnabled = glIsEnabled(GL_BLEND), cullEnabled = glIsEnabled(GL_CULL_FACE),
+		depthEnabled = glIsEnabled(GL_DEPTH_TEST), scissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_SCISSOR_TEST);
+
+	Resource::GetShader("Overlay")->BindShader();
+	Resource::GetBoundShader()->SetUniform("projection", glm::ortho(0.0f, (float)windowWidth, (float)windowHeight, 0.0f));
+	m_fontAtlas->BindBuffer("overlayTexture", 0);
+
+	m_VAO->BindVertexArray();
+
+	const nk_draw_command* command = nullptr;
+	const nk_draw_index* offset = nullptr;
+	nk_draw_foreach(command, &m_context->m_context, &m_context->m_commands)
+	{
+		if (command->elem_count == 0)
+			continue;
+
+		// Nuklear's clip rects start at the top left, the scissor's at the bottom left
+		glScissor((GLint)command->clip_rect.x, (GLint)((float)windowHeight - (command->clip_rect.y + command->clip_rect.h)),
+			(GLsizei)command->clip_rect.w, (GLsizei)command->clip_rect.h);
+		glDrawElements(GL_TRIANGLES, (GLsizei)command->elem_count, GL_UNSIGNED_SHORT, offset);
+
+		offset += command->elem_count;
+	}
+
+	m_VAO->UnbindVertexArray();
+	m_fontAtlas->UnbindBuffer();
+
+	nk_clear(&m_context->m_context);
+	nk_buffer_clear(&m_context->m_commands);
+	nk_buffer_clear(vertices);
+	nk_buffer_clear(elements);
+
+	blendEnabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+	cullEnabled ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+	depthEnabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+	scissorEnabled ? glEnable(GL_SCISSOR_TEST) : glDisable(GL_SCISSOR_TEST);
+}
+
+void PerformanceOverlay::SetVisible(bool visible)
+{
+	if (visible == m_visible)
+		return;
+
+	// The GL calls are only counted while the overlay is up
+	if (visible)
+		RenderStats::InstallHooks();
+	else
+		RenderStats::RemoveHooks();
+
+	m_visible = visible;
+}
+
+void PerformanceOverlay::SetInstanceCount(const std::string& modelKey, uint32_t numVisible, uint32_t numTotal)
+{
+	for (auto& count : m_instanceCounts)
+	{
+		if (count.m_modelKey == modelKey)
+		{
+			count.m_numVisible = numVisible;
+			count.m_numTotal = numTotal;
+			return;
+		}
+	}
+
+	m_instanceCounts.push_back({ modelKey, numVisible, numTotal });
+}
+
+void PerformanceOverlay::SetRenderTargetBytes(size_t bytes)
+{
+	m_renderTargetBytes = bytes;
+}
+
+const bool& PerformanceOverlay::IsVisible() const
+{
+	return m_visible;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Graphics/RenderStats.h"
+
+class VertexBuffer;
+class IndexBuffer;
+class VertexArray;
+class TextureBuffer;
+
+struct OverlayContext; // The nuklear state, which is kept out of the header so only the overlay includes nuklear
+
+// A fixed ring of the last so many frame times, so recording one doesn't have to move the others along
+struct FrameHistory
+{
+	std::vector<float> m_times; // Sized once when the overlay starts
+	uint32_t m_next, m_count; // Where the next time goes, and how many have been recorded (up to the ring's size)
+};
+
+/*
+	PerformanceOverlay : Draws the frame times, the GPU timings, the draw and state change counts, the visible instances
+	of each model and the GPU memory in use over the final image, through nuklear. It's drawn last in the post process
+	and times itself on the CPU and GPU, and its own draws are kept out of the scene's counts, so it can show what it
+	costs as an item of its own.
+*/
+class PerformanceOverlay
+{
+private:
+	struct InstanceCount
+	{
+		std::string m_modelKey;
+		uint32_t m_numVisible, m_numTotal;
+	};
+
+	std::unique_ptr<OverlayContext> m_context;
+	std::shared_ptr<TextureBuffer> m_fontAtlas;
+	std::shared_ptr<VertexBuffer> m_VBO;
+	std::shared_ptr<IndexBuffer> m_IBO;
+	std::shared_ptr<VertexArray> m_VAO;
+
+	bool m_visible;
+
+	FrameHistory m_frameTimes, m_gpuFrameTimes;
+	std::chrono::steady_clock::time_point m_lastFrameTime;
+
+	std::vector<InstanceCount> m_instanceCounts;
+	size_t m_renderTargetBytes;
+	bool m_hasNvidiaMemoryInfo, m_hasAtiMemoryInfo;
+
+	// What the overlay itself cost last time it was drawn
+	float m_overlayCpuTime;
+	RenderCounters m_overlayCounters;
+private:
+	PerformanceOverlay();
+	~PerformanceOverlay();
+
+	void InitScript();
+	void RecordFrameTime();
+
+	void BuildWindow(uint32_t windowWidth, uint32_t windowHeight);
+	void BuildMemoryRows();
+	void DrawCommands(uint32_t windowWidth, uint32_t windowHeight) const;
+public:
+	static PerformanceOverlay* GetPtr();
+
+	// Draws the overlay over whatever is bound, this is called at the end of the post process
+	void Render(uint32_t windowWidth, uint32_t windowHeight);
+
+	void SetVisible(bool visible);
+	void SetInstanceCount(const std::string& modelKey, uint32_t numVisible, uint32_t numTotal);
+	void SetRenderTargetBytes(size_t bytes); // The transient targets the render graph keeps pooled
+public:
+	const bool& IsVisible() const;
+};
\ No newline at end of file
@@ -55,7 +55,7 @@ void Player::HandleMovement(const float& deltaTime)
 void Player::HandleEvents()
 {
 	static float prevTime = 0.0f;
-	float currentTime = (float)glfwGetTime();
+	float currentTime = (float)m_window->GetTime();
 
 	// Press "F" to toggle flying
 	if (m_window->WasKeyPressed(GLFW_KEY_F) && (currentTime - prevTime) > 0.5f)
@@ -80,6 +80,11 @@ void Player::UpdateTick(const float& deltaTime)
 	m_camera.UpdateTick();
 }
 
+PerspectiveCamera& Player::GetCamera()
+{
+	return m_camera;
+}
+
 const PerspectiveCamera& Player::GetCamera() const
 {
 	return m_camera;
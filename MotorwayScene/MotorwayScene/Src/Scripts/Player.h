@@ -21,5 +21,6 @@ public:
 	void InitScript(std::shared_ptr<WindowFrame> window, float speed);
 	void UpdateTick(const float& deltaTime);
 public:
+	PerspectiveCamera& GetCamera();
 	const PerspectiveCamera& GetCamera() const;
 };
\ No newline at end of file
@@ -1,18 +1,56 @@
 #include "PostProcessing.h"
+#include "Scalability.h"
+#include "PerformanceOverlay.h"
 #include "Graphics/BufferObjects.h"
 #include "Graphics/ObjectRenderer.h"
+#include "Graphics/GpuProfiler.h"
 #include "Utils/ResourceManager.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Config
 {
-	constexpr uint32_t WIDTH = 1600;
-	constexpr uint32_t HEIGHT = 900;
-	
-	constexpr int MAX_SAMPLES = 4;
 	constexpr float GAMMA = 2.2f;
+
+	// Raising the maximum above 1 lets the scene supersample when there's time to spare, at the cost of bigger targets
+	constexpr float MIN_RESOLUTION_SCALE = 0.5f;
+	constexpr float MAX_RESOLUTION_SCALE = 1.0f;
+
+	constexpr float FRAME_TIME_BUDGET = 1.0f / 60.0f;
+	constexpr float FRAME_TIME_SMOOTHING = 0.1f; // The weight of the newest frame in the moving average
+
+	// The scale only moves when the average leaves this band around the budget, and at most by the step each time
+	constexpr float SCALE_DOWN_THRESHOLD = 1.05f;
+	constexpr float SCALE_UP_THRESHOLD = 0.85f;
+	constexpr float MAX_SCALE_STEP = 0.05f;
+	constexpr uint32_t SCALE_COOLDOWN_FRAMES = 15; // Lets the average settle on the new scale before it moves again
+
+	constexpr uint32_t JITTER_SEQUENCE_LENGTH = 16;
+}
+
+namespace
+{
+	// Low discrepancy sequence used for the TAA jitter, so the samples cover each pixel evenly over a few frames
+	float GenerateHalton(uint32_t index, uint32_t base)
+	{
+		float result = 0.0f, fraction = 1.0f;
+		while (index > 0)
+		{
+			fraction /= (float)base;
+			result += fraction * (float)(index % base);
+			index /= base;
+		}
+
+		return result;
+	}
 }
 
-PostProcess::PostProcess() 
+PostProcess::PostProcess() :
+	m_width(0), m_height(0), m_windowWidth(0), m_windowHeight(0), m_msaaSamples(0), 
+	m_antiAliasing(AntiAliasingMode::MSAA), m_resolutionScale(1.0f), 
+	m_averageFrameTime(Config::FRAME_TIME_BUDGET), m_framesSinceScaleChange(0), m_dynamicResolution(false), m_frameIndex(0), 
+	m_historyValid(false), m_unjitteredVP(1.0f), m_prevUnjitteredVP(1.0f)
 {
 	this->InitScript();
 }
@@ -27,36 +65,320 @@ PostProcess* PostProcess::GetPtr()
 
 void PostProcess::InitScript()
 {
-	Resource::LoadShader("PostProcessingMS", "Resources/Shaders/PostProcessing.glsl.vsh",
+	Resource::LoadShader("PostProcessing", "Resources/Shaders/PostProcessing.glsl.vsh",
 		"Resources/Shaders/PostProcessing.glsl.fsh");
+	Resource::LoadShader("FXAA", "Resources/Shaders/PostProcessing.glsl.vsh", "Resources/Shaders/FXAA.glsl.fsh");
+	Resource::LoadShader("TemporalResolve", "Resources/Shaders/PostProcessing.glsl.vsh", 
+		"Resources/Shaders/TemporalResolve.glsl.fsh");
+
+	this->RebuildTargets();
+}
+
+void PostProcess::RebuildTargets()
+{
+	const QualitySettings& settings = Scalability::GetPtr()->GetSettings();
+	m_width = settings.m_renderWidth;
+	m_height = settings.m_renderHeight;
+
+	GLint maxSamples = 0;
+	glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+	m_msaaSamples = (uint32_t)std::min(settings.m_msaaSamples, (int)maxSamples);
 
-	auto colorAttachment = Buffer::GenerateTBO(Config::WIDTH, Config::HEIGHT, GL_SRGB, GL_RGB, GL_UNSIGNED_BYTE, false, true,
-		Config::MAX_SAMPLES);
-	auto depthStenilAttachment = Buffer::GenerateRBO(Config::WIDTH, Config::HEIGHT, GL_DEPTH24_STENCIL8, true,
-		Config::MAX_SAMPLES);
+	// The window opens at the render size, this only changes if it's told otherwise
+	if (m_windowWidth == 0 || m_windowHeight == 0)
+		this->SetWindowSize(m_width, m_height);
 
-	m_FBO = Buffer::GenerateFBO();
-	m_FBO->AttachTextureBuffer("PostProcessMS", colorAttachment, GL_COLOR_ATTACHMENT0);
-	m_FBO->AttachRenderBuffer(depthStenilAttachment, GL_DEPTH_STENCIL_ATTACHMENT);
+	this->RebuildHistory();
 }
 
-void PostProcess::RenderToFBO() const
+void PostProcess::RebuildHistory()
 {
-	m_FBO->BindBuffer();
-	glViewport(0, 0, 1600, 900);
+	for (auto& historyFBO : m_historyFBOs)
+	{
+		auto history = Buffer::GenerateTBO(m_windowWidth, m_windowHeight, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+		history->SetFiltering(GL_LINEAR, GL_LINEAR);
+		history->SetWrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
+		historyFBO = Buffer::GenerateFBO();
+		historyFBO->AttachTextureBuffer("History", history, GL_COLOR_ATTACHMENT0);
+
+		history->SetLabel("TAA history");
+		historyFBO->SetLabel("TAA history");
+	}
+
+	m_historyValid = false;
+}
+
+SceneTargets PostProcess::CreateSceneTargets(RenderPassBuilder& builder) const
+{
+	const uint32_t width = this->GetWidth(), height = this->GetHeight();
+	SceneTargets targets;
+
+	targets.m_color = builder.CreateTexture("SceneColor", { width, height, GL_SRGB, GL_RGB, GL_UNSIGNED_BYTE });
+
+	if (m_antiAliasing == AntiAliasingMode::MSAA)
+	{
+		// The resolve only copies the color across, so nothing ever samples the depth
+		targets.m_drawColor = builder.CreateTexture("SceneColorMS", 
+			{ width, height, GL_SRGB, GL_RGB, GL_UNSIGNED_BYTE, m_msaaSamples });
+		targets.m_drawDepthStencil = builder.CreateRenderbuffer("SceneDepthStencilMS", 
+			{ width, height, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, m_msaaSamples });
+		targets.m_depthStencil = NULL_RENDER_RESOURCE;
+	}
+	else
+	{
+		// The TAA reprojects from the depth, so this has to be a texture
+		targets.m_depthStencil = builder.CreateTexture("SceneDepthStencil", 
+			{ width, height, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8 });
+		targets.m_drawColor = targets.m_color;
+		targets.m_drawDepthStencil = targets.m_depthStencil;
+	}
+
+	builder.Write(targets.m_drawColor, GL_COLOR_ATTACHMENT0);
+	builder.Write(targets.m_drawDepthStencil, GL_DEPTH_STENCIL_ATTACHMENT);
+
+	return targets;
 }
 
-void PostProcess::RenderPostProcess() const
+void PostProcess::DrawToScene(RenderPassBuilder& builder, const SceneTargets& targets) const
 {
-	m_FBO->UnbindBuffer();
+	builder.Read(targets.m_drawColor);
+	builder.Read(targets.m_drawDepthStencil);
+	builder.Write(targets.m_drawColor, GL_COLOR_ATTACHMENT0);
+	builder.Write(targets.m_drawDepthStencil, GL_DEPTH_STENCIL_ATTACHMENT);
+}
+
+void PostProcess::ReadScene(RenderPassBuilder& builder, const SceneTargets& targets) const
+{
+	// The single sampled color is first written here with MSAA, so it only takes up memory from the resolve onwards
+	if (m_antiAliasing == AntiAliasingMode::MSAA)
+	{
+		builder.Read(targets.m_drawColor);
+		builder.Write(targets.m_color);
+	}
+	else
+		builder.Read(targets.m_color);
+
+	if (m_antiAliasing == AntiAliasingMode::TAA)
+		builder.Read(targets.m_depthStencil);
+}
+
+void PostProcess::RenderToFBO(const RenderPassContext& context) const
+{
+	context.GetFramebuffer()->BindBuffer();
+	glViewport(0, 0, this->GetRenderWidth(), this->GetRenderHeight());
+}
+
+void PostProcess::RenderPostProcess(const RenderPassContext& context, const SceneTargets& targets) const
+{
+	GpuProfiler::GetPtr()->BeginTimer("PostProcessResolve");
+
+	// The blit averages the samples of each pixel, which is cheaper than fetching every sample in the shader
+	if (m_antiAliasing == AntiAliasingMode::MSAA)
+	{
+		const auto source = context.GetFramebuffer(targets.m_drawColor, GL_COLOR_ATTACHMENT0);
+		const auto target = context.GetFramebuffer(targets.m_color, GL_COLOR_ATTACHMENT0);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, source->GetID());
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target->GetID());
+		glBlitFramebuffer(0, 0, this->GetRenderWidth(), this->GetRenderHeight(), 0, 0, this->GetRenderWidth(),
+			this->GetRenderHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+
+	// The final pass upsamples this and FXAA reads the neighbouring pixels, both with bilinear filtering
+	const auto sceneColor = context.GetTexture(targets.m_color);
+	sceneColor->SetFiltering(GL_LINEAR, GL_LINEAR);
+
+	if (m_antiAliasing == AntiAliasingMode::TAA)
+		this->ResolveTemporal(context, targets);
+
+	// The render size can differ from the window's once the settings change, so the final pass scales to the window
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, m_windowWidth, m_windowHeight);
 
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	Resource::GetShader("PostProcessingMS")->BindShader();
-	Resource::GetShader("PostProcessingMS")->SetUniform("gammaValue", Config::GAMMA);
-	Resource::GetShader("PostProcessingMS")->SetUniform("numSamples", Config::MAX_SAMPLES);
+	auto shader = Resource::GetShader((m_antiAliasing == AntiAliasingMode::FXAA) ? "FXAA" : "PostProcessing");
+	shader->BindShader();
+	shader->SetUniform("gammaValue", Config::GAMMA);
+
+	// The TAA output is already at the window resolution
+	if (m_antiAliasing == AntiAliasingMode::TAA)
+	{
+		shader->SetUniform("sceneScale", glm::vec2(1.0f));
+		m_historyFBOs[m_frameIndex & 1]->GetColorBuffer("History")->BindBuffer("sceneTexture", 0);
+	}
+	else
+	{
+		shader->SetUniform("sceneScale", this->GetTargetScale());
+		sceneColor->BindBuffer("sceneTexture", 0);
+	}
 
-	m_FBO->GetColorBuffer("PostProcessMS")->BindBuffer("sceneTexture", 0);
 	ObjectRenderer::GetPtr()->RenderQuad();
+	m_frameIndex++;
+
+	GpuProfiler::GetPtr()->EndTimer("PostProcessResolve");
+
+	// Drawn outside of the resolve's timer, so the overlay's cost shows up as its own item
+	PerformanceOverlay::GetPtr()->Render(m_windowWidth, m_windowHeight);
+}
+
+void PostProcess::ResolveTemporal(const RenderPassContext& context, const SceneTargets& targets) const
+{
+	const auto& outputFBO = m_historyFBOs[m_frameIndex & 1];
+	const auto& historyFBO = m_historyFBOs[(m_frameIndex + 1) & 1];
+
+	// Drawn at the window resolution, so a lower render resolution is upscaled as the jittered frames accumulate
+	outputFBO->BindBuffer();
+	glViewport(0, 0, m_windowWidth, m_windowHeight);
+	glDisable(GL_DEPTH_TEST);
+
+	Resource::GetShader("TemporalResolve")->BindShader();
+	Resource::GetBoundShader()->SetUniform("sceneScale", this->GetTargetScale());
+	Resource::GetBoundShader()->SetUniform("renderSize", glm::vec2((float)this->GetRenderWidth(), 
+		(float)this->GetRenderHeight()));
+	Resource::GetBoundShader()->SetUniform("jitter", this->GetJitterPixels());
+	Resource::GetBoundShader()->SetUniform("inverseVP", glm::inverse(m_unjitteredVP));
+	Resource::GetBoundShader()->SetUniform("prevVP", m_prevUnjitteredVP);
+	Resource::GetBoundShader()->SetUniform("historyValid", m_historyValid);
+
+	context.GetTexture(targets.m_color)->BindBuffer("sceneTexture", 0);
+	context.GetTexture(targets.m_depthStencil)->BindBuffer("sceneDepth", 1);
+	historyFBO->GetColorBuffer("History")->BindBuffer("historyTexture", 2);
+	ObjectRenderer::GetPtr()->RenderQuad();
+
+	glEnable(GL_DEPTH_TEST);
+
+	m_prevUnjitteredVP = m_unjitteredVP;
+	m_historyValid = true;
+}
+
+void PostProcess::ResolveDepth(const RenderPassContext& context, const SceneTargets& targets) const
+{
+	const auto source = context.GetFramebuffer(targets.m_drawDepthStencil, GL_DEPTH_STENCIL_ATTACHMENT);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, source->GetID());
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, context.GetFramebuffer()->GetID());
+	glBlitFramebuffer(0, 0, this->GetRenderWidth(), this->GetRenderHeight(), 0, 0, this->GetRenderWidth(), 
+		this->GetRenderHeight(), GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PostProcess::SetAntiAliasing(AntiAliasingMode mode)
+{
+	m_antiAliasing = mode;
+	m_historyValid = false; // The history stops being updated while TAA is off, so it's stale if it comes back on
+}
+
+void PostProcess::SetWindowSize(uint32_t width, uint32_t height)
+{
+	if (width == m_windowWidth && height == m_windowHeight)
+		return;
+
+	m_windowWidth = width;
+	m_windowHeight = height;
+
+	// Before the first RebuildTargets() there's no history yet, it's made along with the rest of the targets
+	if (m_historyFBOs[0])
+		this->RebuildHistory();
+}
+
+void PostProcess::SetViewProjection(const glm::mat4& unjitteredVP)
+{
+	m_unjitteredVP = unjitteredVP;
+}
+
+void PostProcess::UpdateResolution(float frameTime)
+{
+	if (!m_dynamicResolution)
+		return;
+
+	m_averageFrameTime += (frameTime - m_averageFrameTime) * Config::FRAME_TIME_SMOOTHING;
+	if (++m_framesSinceScaleChange < Config::SCALE_COOLDOWN_FRAMES)
+		return;
+
+	const bool overBudget = m_averageFrameTime > Config::FRAME_TIME_BUDGET * Config::SCALE_DOWN_THRESHOLD;
+	const bool underBudget = m_averageFrameTime < Config::FRAME_TIME_BUDGET * Config::SCALE_UP_THRESHOLD;
+	if (!overBudget && !underBudget)
+		return;
+
+	// The cost goes with the number of pixels, so the scale needed to hit the budget goes with the square root
+	const float idealScale = m_resolutionScale * std::sqrt(Config::FRAME_TIME_BUDGET / m_averageFrameTime);
+	const float step = std::min(std::max(idealScale - m_resolutionScale, -Config::MAX_SCALE_STEP), Config::MAX_SCALE_STEP);
+	const float newScale = std::min(std::max(m_resolutionScale + step, Config::MIN_RESOLUTION_SCALE), 
+		Config::MAX_RESOLUTION_SCALE);
+
+	if (newScale != m_resolutionScale)
+	{
+		m_resolutionScale = newScale;
+		m_framesSinceScaleChange = 0;
+	}
+}
+
+void PostProcess::SetDynamicResolution(bool enabled)
+{
+	m_dynamicResolution = enabled;
+	m_averageFrameTime = Config::FRAME_TIME_BUDGET;
+	m_framesSinceScaleChange = 0;
+
+	if (!enabled)
+		m_resolutionScale = 1.0f;
+}
+
+uint32_t PostProcess::GetWidth() const
+{
+	return (uint32_t)(m_width * Config::MAX_RESOLUTION_SCALE);
+}
+
+uint32_t PostProcess::GetHeight() const
+{
+	return (uint32_t)(m_height * Config::MAX_RESOLUTION_SCALE);
+}
+
+uint32_t PostProcess::GetRenderWidth() const
+{
+	// Kept even so the half resolution passes line up with it
+	return std::min((uint32_t)(m_width * m_resolutionScale) & ~1u, this->GetWidth());
+}
+
+uint32_t PostProcess::GetRenderHeight() const
+{
+	return std::min((uint32_t)(m_height * m_resolutionScale) & ~1u, this->GetHeight());
+}
+
+glm::vec2 PostProcess::GetTargetScale() const
+{
+	return glm::vec2((float)this->GetRenderWidth() / (float)this->GetWidth(), 
+		(float)this->GetRenderHeight() / (float)this->GetHeight());
+}
+
+glm::vec2 PostProcess::GetJitterPixels() const
+{
+	if (m_antiAliasing != AntiAliasingMode::TAA)
+		return glm::vec2(0.0f);
+
+	const uint32_t sequenceIndex = (m_frameIndex % Config::JITTER_SEQUENCE_LENGTH) + 1; // Index 0 is always the corner
+	return glm::vec2(GenerateHalton(sequenceIndex, 2), GenerateHalton(sequenceIndex, 3)) - 0.5f;
+}
+
+glm::vec2 PostProcess::GetJitter() const
+{
+	return 2.0f * this->GetJitterPixels() / glm::vec2((float)this->GetRenderWidth(), (float)this->GetRenderHeight());
+}
+
+const AntiAliasingMode& PostProcess::GetAntiAliasing() const
+{
+	return m_antiAliasing;
+}
+
+const float& PostProcess::GetResolutionScale() const
+{
+	return m_resolutionScale;
+}
+
+const bool& PostProcess::IsDynamicResolution() const
+{
+	return m_dynamicResolution;
 }
\ No newline at end of file
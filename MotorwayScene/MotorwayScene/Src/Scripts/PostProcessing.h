@@ -1,24 +1,117 @@
 #pragma once
 #include <memory>
+#include <glm/glm.hpp>
+
+#include "Graphics/RenderGraph.h"
 
 class FrameBuffer;
 class ShaderProgram;
 
 typedef unsigned int GLenum;
+typedef unsigned int uint32_t;
+
+enum class AntiAliasingMode
+{
+	MSAA,	// The scene is drawn with MSAA (4x unless the settings say otherwise), then resolved with a blit
+	FXAA,	// The scene is drawn single sampled, then smoothed in screen space
+	TAA,	// The scene is drawn single sampled and jittered, then accumulated over frames at the window resolution
+	NONE
+};
+
+struct SceneTargets
+{
+	// What the scene's passes draw into, which are the multisampled targets while MSAA is on
+	RenderResource m_drawColor, m_drawDepthStencil;
+
+	// What the post process reads, the MSAA targets are resolved into the color. There's no single sampled depth with
+	// MSAA, as only the TAA reads it back.
+	RenderResource m_color, m_depthStencil;
+};
 
 class PostProcess
 {
 private:
 	std::shared_ptr<ShaderProgram> m_shader;
-	std::shared_ptr<FrameBuffer> m_FBO;
+	uint32_t m_width, m_height; // The render size from the settings, which the scene targets are allocated at
+	uint32_t m_windowWidth, m_windowHeight; // What the final pass scales the scene to, and the TAA history's size
+	uint32_t m_msaaSamples; // The sample count from the settings, limited to what the driver supports
+
+	AntiAliasingMode m_antiAliasing;
+
+	// The targets are allocated at the maximum scale, only the viewport changes with the resolution scale
+	float m_resolutionScale, m_averageFrameTime;
+	uint32_t m_framesSinceScaleChange;
+	bool m_dynamicResolution;
+
+	// The TAA history is kept at the window resolution, so a lower render resolution gets upscaled as it accumulates.
+	// Unlike the scene targets it isn't a graph resource, as it has to last into the next frame.
+	std::shared_ptr<FrameBuffer> m_historyFBOs[2];
+	mutable uint32_t m_frameIndex;
+	mutable bool m_historyValid;
+	glm::mat4 m_unjitteredVP;
+	mutable glm::mat4 m_prevUnjitteredVP;
 private:
 	PostProcess();
 	~PostProcess();
 
 	void InitScript();
+	void RebuildHistory();
+	void ResolveTemporal(const RenderPassContext& context, const SceneTargets& targets) const;
+	glm::vec2 GetJitterPixels() const;
 public:
 	static PostProcess* GetPtr();
 
-	void RenderToFBO() const;
-	void RenderPostProcess() const;
+	// Picks up the render size and MSAA sample count in the current settings, the graph allocates the scene targets
+	// with them from the next frame
+	void RebuildTargets();
+
+	// Declares the scene targets for the current anti-aliasing mode, written by the pass being built, which has to
+	// either clear them or draw over every pixel
+	SceneTargets CreateSceneTargets(RenderPassBuilder& builder) const;
+
+	// Declares that the pass being built draws on top of what the earlier passes left in the scene targets
+	void DrawToScene(RenderPassBuilder& builder, const SceneTargets& targets) const;
+
+	// Declares what the post process reads, the pass being built also resolves the MSAA targets if there are any
+	void ReadScene(RenderPassBuilder& builder, const SceneTargets& targets) const;
+
+	// Binds the framebuffer of a pass that draws to the scene, with the viewport at the render size
+	void RenderToFBO(const RenderPassContext& context) const;
+	void RenderPostProcess(const RenderPassContext& context, const SceneTargets& targets) const;
+
+	// Copies the scene depth into the pass's framebuffer, which must be single sampled and have a matching depth
+	// format. The pass has to read the depth stencil the scene is drawn into.
+	void ResolveDepth(const RenderPassContext& context, const SceneTargets& targets) const;
+
+	void SetAntiAliasing(AntiAliasingMode mode);
+	void SetWindowSize(uint32_t width, uint32_t height); // The size of the default framebuffer, or the headless surface
+
+	// Needed by the TAA to reproject last frame, this must be given the camera's unjittered matrix before the post process
+	void SetViewProjection(const glm::mat4& unjitteredVP);
+
+	/*
+		UpdateResolution() : Moves the resolution scale towards the frame time budget, if dynamic resolution is on. The
+		frame time is averaged and has to leave a band around the budget before the scale changes, so it doesn't hunt.
+		[frameTime] - How long the last frame took, in seconds
+	*/
+	void UpdateResolution(float frameTime);
+	void SetDynamicResolution(bool enabled); // The scale goes back to 1 when it's switched off
+public:
+	// The size the screen space targets are allocated at
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+
+	// The size the scene is currently drawn at, which is what the screen space passes should cover
+	uint32_t GetRenderWidth() const;
+	uint32_t GetRenderHeight() const;
+
+	// The fraction of the allocated targets that's drawn to, for turning screen coordinates into texture coordinates
+	glm::vec2 GetTargetScale() const;
+
+	// The offset the camera's projection should use this frame, in NDC, which is zero unless TAA is on
+	glm::vec2 GetJitter() const;
+
+	const AntiAliasingMode& GetAntiAliasing() const;
+	const float& GetResolutionScale() const;
+	const bool& IsDynamicResolution() const;
 };
\ No newline at end of file
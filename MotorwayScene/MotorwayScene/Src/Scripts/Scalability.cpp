@@ -0,0 +1,218 @@
+#include "Scalability.h"
+#include "PostProcessing.h"
+#include "ShadowGeneration.h"
+#include "Utils/LoggingManager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	const std::string DEFAULT_CONFIG_PATH = "Resources/Settings.cfg";
+
+	const char* PRESET_NAMES[] = { "low", "medium", "high", "ultra" };
+
+	// Trees, shadow resolution, MSAA samples, render size, shadow distance, fog density. The lower presets thicken the
+	// fog to hide how much closer the shadows end.
+	const QualitySettings PRESETS[] =
+	{
+		{ 5000, 1024, 2, 1280, 720, 15.0f, 0.06f },
+		{ 10000, 1536, 2, 1600, 900, 20.0f, 0.05f },
+		{ 20000, 2160, 4, 1600, 900, 25.0f, 0.04f },
+		{ 30000, 4096, 8, 1920, 1080, 35.0f, 0.035f }
+	};
+
+	const char* KNOB_NAMES[] = { "tree_count", "shadow_resolution", "msaa_samples", "render_width", "render_height",
+		"shadow_distance", "fog_density" };
+
+	bool IsSettingName(const std::string& name)
+	{
+		return name == "preset" || std::find(std::begin(KNOB_NAMES), std::end(KNOB_NAMES), name) != std::end(KNOB_NAMES);
+	}
+
+	std::string TrimWhitespace(const std::string& text)
+	{
+		const size_t first = text.find_first_not_of(" \t\r\n");
+		if (first == std::string::npos)
+			return "";
+
+		return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+	}
+}
+
+Scalability::Scalability() :
+	m_preset(QualityPreset::HIGH), m_settings(PRESETS[(int)QualityPreset::HIGH])
+{}
+
+Scalability::~Scalability() {}
+
+Scalability* Scalability::GetPtr()
+{
+	static Scalability singleton;
+	return &singleton;
+}
+
+void Scalability::LoadSettings(int argc, char** argv)
+{
+	// The config file is read first, so the command line can override anything in it
+	std::string configPath = DEFAULT_CONFIG_PATH;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+		if (argument.compare(0, 9, "--config=") == 0)
+			configPath = argument.substr(9);
+	}
+
+	this->LoadConfigFile(configPath);
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+		if (argument.compare(0, 2, "--") != 0 || argument.compare(0, 9, "--config=") == 0)
+			continue;
+
+		// Both "--name=value" and "--name value" are accepted, flags that aren't settings are left for the rest of the app
+		const size_t separator = argument.find('=');
+		const std::string name = argument.substr(2, (separator != std::string::npos) ? separator - 2 : std::string::npos);
+		if (!IsSettingName(name))
+			continue;
+
+		if (separator != std::string::npos)
+			this->ParseSetting(name, argument.substr(separator + 1), "the command line");
+		else if (i + 1 < argc && this->ParseSetting(name, argv[i + 1], "the command line"))
+			i++;
+	}
+
+	m_settings = this->ResolveSettings();
+
+	OutputLog("Scalability preset \"" + std::string(PRESET_NAMES[(int)m_preset]) + "\": " +
+		std::to_string(m_settings.m_treeCount) + " trees, " + std::to_string(m_settings.m_shadowResolution) +
+		" shadow map, " + std::to_string(m_settings.m_msaaSamples) + "x MSAA, " + std::to_string(m_settings.m_renderWidth) +
+		"x" + std::to_string(m_settings.m_renderHeight), Logging::Severity::NOTIFICATION);
+}
+
+void Scalability::LoadConfigFile(const std::string& filePath)
+{
+	std::ifstream file(filePath);
+	if (!file.is_open())
+	{
+		if (filePath != DEFAULT_CONFIG_PATH)
+			OutputLog("Failed to open the config file \"" + filePath + "\"", Logging::Severity::WARNING);
+
+		return;
+	}
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		line = line.substr(0, line.find('#'));
+
+		const size_t separator = line.find('=');
+		if (separator == std::string::npos)
+			continue;
+
+		this->ParseSetting(TrimWhitespace(line.substr(0, separator)), TrimWhitespace(line.substr(separator + 1)), filePath);
+	}
+}
+
+bool Scalability::ParseSetting(const std::string& name, const std::string& value, const std::string& source)
+{
+	if (name == "preset")
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			if (value == PRESET_NAMES[i])
+			{
+				m_preset = (QualityPreset)i;
+				return true;
+			}
+		}
+
+		OutputLog("Unknown preset \"" + value + "\" in " + source + ", expected low, medium, high or ultra",
+			Logging::Severity::WARNING);
+		return false;
+	}
+
+	if (!IsSettingName(name))
+	{
+		OutputLog("Unknown setting \"" + name + "\" in " + source, Logging::Severity::WARNING);
+		return false;
+	}
+
+	std::istringstream stream(value);
+	float number = 0.0f;
+	if (!(stream >> number) || number < 0.0f)
+	{
+		OutputLog("The setting \"" + name + "\" in " + source + " needs a positive number, not \"" + value + "\"",
+			Logging::Severity::WARNING);
+		return false;
+	}
+
+	m_overrides[name] = number;
+	return true;
+}
+
+QualitySettings Scalability::ResolveSettings() const
+{
+	QualitySettings settings = PRESETS[(int)m_preset];
+
+	for (const auto& knob : m_overrides)
+	{
+		if (knob.first == "tree_count")
+			settings.m_treeCount = (uint32_t)knob.second;
+		else if (knob.first == "shadow_resolution")
+			settings.m_shadowResolution = std::max((uint32_t)knob.second, 256u);
+		else if (knob.first == "msaa_samples")
+			settings.m_msaaSamples = std::max((int)knob.second, 2); // Turning MSAA off is the anti-aliasing mode's job
+		else if (knob.first == "render_width")
+			settings.m_renderWidth = std::max((uint32_t)knob.second, 64u);
+		else if (knob.first == "render_height")
+			settings.m_renderHeight = std::max((uint32_t)knob.second, 64u);
+		else if (knob.first == "shadow_distance")
+			settings.m_shadowDistance = std::max(knob.second, 1.0f);
+		else if (knob.first == "fog_density")
+			settings.m_fogDensity = knob.second;
+	}
+
+	return settings;
+}
+
+void Scalability::SetPreset(QualityPreset preset)
+{
+	const QualitySettings previous = m_settings;
+
+	m_preset = preset;
+	m_settings = this->ResolveSettings();
+	this->ApplySettings(previous);
+}
+
+void Scalability::ApplySettings(const QualitySettings& previous)
+{
+	// The shadow distance and fog density are read every frame, so only the knobs behind GPU resources need anything done
+	if (m_settings.m_renderWidth != previous.m_renderWidth || m_settings.m_renderHeight != previous.m_renderHeight ||
+		m_settings.m_msaaSamples != previous.m_msaaSamples)
+	{
+		PostProcess::GetPtr()->RebuildTargets();
+	}
+
+	if (m_settings.m_shadowResolution != previous.m_shadowResolution)
+		ShadowGeneration::GetPtr()->RebuildShadowMaps();
+
+	// The tree count is picked up by the world scene on its next tick, which refills the trees' instance buffer
+}
+
+const QualityPreset& Scalability::GetPreset() const
+{
+	return m_preset;
+}
+
+std::string Scalability::GetPresetName() const
+{
+	return PRESET_NAMES[(int)m_preset];
+}
+
+const QualitySettings& Scalability::GetSettings() const
+{
+	return m_settings;
+}
\ No newline at end of file
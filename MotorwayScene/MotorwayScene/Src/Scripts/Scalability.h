@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+typedef unsigned int uint32_t;
+
+enum class QualityPreset
+{
+	LOW,
+	MEDIUM,
+	HIGH,	// The scene as it was first tuned
+	ULTRA
+};
+
+struct QualitySettings
+{
+	uint32_t m_treeCount; // Changes to it rebuild the trees' instance buffer on the world scene's next tick
+	uint32_t m_shadowResolution;
+	int m_msaaSamples;
+	uint32_t m_renderWidth, m_renderHeight; // The window opens at this size, the final pass scales to the window after
+	float m_shadowDistance; // How far the shadow map reaches either side of the player
+	float m_fogDensity;
+};
+
+class Scalability
+{
+private:
+	QualityPreset m_preset;
+	QualitySettings m_settings;
+
+	// Knobs set by the config file or command line, which stay pinned when the preset changes
+	std::unordered_map<std::string, float> m_overrides;
+private:
+	Scalability();
+	~Scalability();
+
+	void LoadConfigFile(const std::string& filePath);
+	bool ParseSetting(const std::string& name, const std::string& value, const std::string& source);
+	QualitySettings ResolveSettings() const;
+	void ApplySettings(const QualitySettings& previous);
+public:
+	static Scalability* GetPtr();
+
+	/*
+		LoadSettings() : Reads the config file, then the command line on top of it. Both take the preset and any of the
+		knobs, e.g. "shadow_resolution = 4096" in the file or "--shadow_resolution=4096" on the command line. The config file
+		can be changed with "--config=<path>". This is called before the window is made, so no GPU resources are touched.
+		[argc] - The number of command line arguments
+		[argv] - The command line arguments
+	*/
+	void LoadSettings(int argc, char** argv);
+
+	// Rebuilds the GPU resources of any knob the preset changes, overridden knobs are kept as they are
+	void SetPreset(QualityPreset preset);
+public:
+	const QualityPreset& GetPreset() const;
+	std::string GetPresetName() const;
+	const QualitySettings& GetSettings() const;
+};
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "ScreenSpaceShadows.h"
+#include "PostProcessing.h"
+#include "ShadowGeneration.h"
+#include "Graphics/BufferObjects.h"
+#include "Graphics/ObjectRenderer.h"
+#include "Utils/ResourceManager.h"
+
+ScreenSpaceShadows::ScreenSpaceShadows() :
+	m_mode(ShadowMaskMode::OFF)
+{
+	this->InitScript();
+}
+
+ScreenSpaceShadows::~ScreenSpaceShadows() {}
+
+ScreenSpaceShadows* ScreenSpaceShadows::GetPtr()
+{
+	static ScreenSpaceShadows singleton;
+	return &singleton;
+}
+
+void ScreenSpaceShadows::InitScript()
+{
+	Resource::LoadShader("ShadowMask", "Resources/Shaders/PostProcessing.glsl.vsh", "Resources/Shaders/ShadowMask.glsl.fsh");
+}
+
+glm::vec2 ScreenSpaceShadows::GetMaskSize() const
+{
+	// The mask follows the scene's resolution scale, so only part of it may be used
+	const uint32_t width = PostProcess::GetPtr()->GetRenderWidth(), height = PostProcess::GetPtr()->GetRenderHeight();
+	if (m_mode == ShadowMaskMode::HALF_RES)
+		return glm::vec2((float)(width / 2), (float)(height / 2));
+
+	return glm::vec2((float)width, (float)height);
+}
+
+RenderResource ScreenSpaceShadows::AddMaskPasses(RenderGraph& graph, const SceneTargets& scene, 
+	RenderResource shadowMap, const glm::mat4& vpMatrix, const glm::vec3& cameraPos) const
+{
+	const uint32_t width = PostProcess::GetPtr()->GetWidth(), height = PostProcess::GetPtr()->GetHeight();
+
+	// The format has to match the scene's depth stencil buffer for the depth to be blitted across
+	RenderPassBuilder resolvePass = graph.AddPass("ResolveSceneDepth");
+	resolvePass.Read(scene.m_drawDepthStencil);
+	const RenderResource sceneDepth = resolvePass.CreateTexture("ResolvedSceneDepth",
+		{ width, height, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8 });
+	resolvePass.Write(sceneDepth, GL_DEPTH_STENCIL_ATTACHMENT);
+
+	resolvePass.SetExecute([scene](const RenderPassContext& context)
+	{
+		PostProcess::GetPtr()->ResolveDepth(context, scene);
+	});
+
+	// The red channel is the shadow value, the green channel is the distance from the camera used when upsampling
+	const bool halfRes = (m_mode == ShadowMaskMode::HALF_RES);
+	RenderPassBuilder maskPass = graph.AddPass("ShadowMask");
+	maskPass.Read(sceneDepth);
+	maskPass.Read(shadowMap);
+	const RenderResource shadowMask = maskPass.CreateTexture("ShadowMask", 
+		{ halfRes ? width / 2 : width, halfRes ? height / 2 : height, GL_RG16F, GL_RG, GL_FLOAT });
+	maskPass.Write(shadowMask, GL_COLOR_ATTACHMENT0);
+
+	const glm::vec2 maskSize = this->GetMaskSize();
+	maskPass.SetExecute([=](const RenderPassContext& context)
+	{
+		context.GetFramebuffer()->BindBuffer();
+		glViewport(0, 0, (GLsizei)maskSize.x, (GLsizei)maskSize.y);
+		glDisable(GL_DEPTH_TEST);
+
+		Resource::GetShader("ShadowMask")->BindShader();
+		Resource::GetBoundShader()->SetUniform("inverseVP", glm::inverse(vpMatrix));
+		Resource::GetBoundShader()->SetUniform("lightMatrixVP", ShadowGeneration::GetPtr()->GetLightMatrix());
+		Resource::GetBoundShader()->SetUniform("cameraPos", cameraPos);
+		Resource::GetBoundShader()->SetUniform("sceneScale", PostProcess::GetPtr()->GetTargetScale());
+
+		context.GetTexture(sceneDepth)->BindBuffer("sceneDepth", 0);
+		ShadowGeneration::GetPtr()->BindShadowMaps(context.GetTexture(shadowMap));
+		ObjectRenderer::GetPtr()->RenderQuad();
+
+		glEnable(GL_DEPTH_TEST);
+		context.GetFramebuffer()->UnbindBuffer();
+	});
+
+	return shadowMask;
+}
+
+void ScreenSpaceShadows::BindShadowMask(std::shared_ptr<TextureBuffer> shadowMask, uint32_t samplerUnit) const
+{
+	Resource::GetBoundShader()->SetUniform("useShadowMask", shadowMask != nullptr);
+	Resource::GetBoundShader()->SetUniform("halfResShadowMask", m_mode == ShadowMaskMode::HALF_RES);
+
+	if (shadowMask)
+	{
+		Resource::GetBoundShader()->SetUniform("shadowMaskSize", this->GetMaskSize());
+		shadowMask->BindBuffer("shadowMask", samplerUnit);
+	}
+}
+
+void ScreenSpaceShadows::SetMode(ShadowMaskMode mode)
+{
+	m_mode = mode;
+}
+
+const ShadowMaskMode& ScreenSpaceShadows::GetMode() const
+{
+	return m_mode;
+}
\ No newline at end of file
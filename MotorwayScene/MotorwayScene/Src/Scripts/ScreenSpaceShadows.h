@@ -0,0 +1,48 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "Graphics/RenderGraph.h"
+
+struct SceneTargets;
+
+enum class ShadowMaskMode
+{
+	OFF,		// Every shaded fragment samples the shadow map itself
+	FULL_RES,	// The shadows are worked out once per pixel
+	HALF_RES	// The shadows are worked out once per 2x2 pixels, then upsampled with the scene depth
+};
+
+class ScreenSpaceShadows
+{
+private:
+	ShadowMaskMode m_mode;
+private:
+	ScreenSpaceShadows();
+	~ScreenSpaceShadows();
+
+	void InitScript();
+	glm::vec2 GetMaskSize() const;
+public:
+	static ScreenSpaceShadows* GetPtr();
+
+	/*
+		AddMaskPasses() : Adds the passes that resolve the scene depth then fill the shadow mask from it, so the scene
+		depth must already be laid down (e.g. by the depth pre-pass). The shadows are sampled with ShadowGeneration's
+		current filter mode. Both passes are culled by the graph unless a later pass reads the returned mask.
+		[graph] - The graph the passes are added to
+		[scene] - The scene targets the depth is resolved from
+		[shadowMap] - The shadow map the mask is filled from
+		[vpMatrix] - The camera's view projection matrix
+		[cameraPos] - The camera's position
+	*/
+	RenderResource AddMaskPasses(RenderGraph& graph, const SceneTargets& scene, RenderResource shadowMap, 
+		const glm::mat4& vpMatrix, const glm::vec3& cameraPos) const;
+
+	// Sets up the object shader (which must be bound) to read the shadow mask, or to sample the shadow map if it's null
+	void BindShadowMask(std::shared_ptr<TextureBuffer> shadowMask, uint32_t samplerUnit) const;
+
+	void SetMode(ShadowMaskMode mode);
+public:
+	const ShadowMaskMode& GetMode() const;
+};
\ No newline at end of file
@@ -1,18 +1,24 @@
 #include "ShadowGeneration.h"
+#include "Scalability.h"
+#include "Graphics/ObjectRenderer.h"
+#include "Graphics/GpuProfiler.h"
 #include "Utils/ResourceManager.h"
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
 
 namespace 
 {
-	const uint32_t SHADOW_RESOLUTION = 2160;
-
-	const float SHADOW_MAP_MAX_LENGTH = 25.0f;
 	const float SHADOW_MAP_NEAR_LIMIT = -55.0f;
 	const float SHADOW_MAP_FAR_LIMIT = 50.0f;
+
+	// Must match the exponents in ShadowSampling.glsl and MomentMapping.glsl.fsh
+	const float EVSM_POSITIVE_EXPONENT = 40.0f;
+	const float EVSM_NEGATIVE_EXPONENT = 5.0f;
 }
 
-ShadowGeneration::ShadowGeneration()
+ShadowGeneration::ShadowGeneration() :
+	m_resolution(0), m_momentResolution(0), m_filterMode(ShadowFilterMode::PCF)
 {
 	this->InitScript();
 }
@@ -22,13 +28,18 @@ ShadowGeneration::~ShadowGeneration() {}
 void ShadowGeneration::InitScript()
 {
 	Resource::LoadShader("DepthMapping", "Resources/Shaders/DepthMapping.glsl.vsh", "Resources/Shaders/DepthMapping.glsl.fsh");
+	Resource::LoadShader("MomentMapping", "Resources/Shaders/DepthMapping.glsl.vsh", 
+		"Resources/Shaders/MomentMapping.glsl.fsh");
+	Resource::LoadShader("MomentBlur", "Resources/Shaders/PostProcessing.glsl.vsh", "Resources/Shaders/MomentBlur.glsl.fsh");
 
-	auto depthMap = Buffer::GenerateTBO(SHADOW_RESOLUTION, SHADOW_RESOLUTION, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT);
-	depthMap->SetFiltering(GL_NEAREST, GL_NEAREST);
-	depthMap->SetBorderColor(glm::vec4(1.0f));
+	this->RebuildShadowMaps();
+}
 
-	m_depthMapFBO = Buffer::GenerateFBO(true);
-	m_depthMapFBO->AttachTextureBuffer("DepthMap", depthMap, GL_DEPTH_ATTACHMENT);
+void ShadowGeneration::RebuildShadowMaps()
+{
+	// The moments are filtered, so they hold up at half the resolution
+	m_resolution = Scalability::GetPtr()->GetSettings().m_shadowResolution;
+	m_momentResolution = m_resolution / 2;
 }
 
 ShadowGeneration* ShadowGeneration::GetPtr()
@@ -37,33 +48,183 @@ ShadowGeneration* ShadowGeneration::GetPtr()
 	return &singleton;
 }
 
-void ShadowGeneration::RenderDepthMap(const glm::vec3& lightDir, const glm::vec3& playerPos) const
+ShadowTargets ShadowGeneration::CreateShadowMaps(RenderPassBuilder& builder) const
+{
+	ShadowTargets targets;
+	targets.m_momentBlur = NULL_RENDER_RESOURCE;
+
+	if (m_filterMode == ShadowFilterMode::VSM || m_filterMode == ShadowFilterMode::EVSM)
+	{
+		const TransientTextureDesc momentDesc = 
+			{ m_momentResolution, m_momentResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT };
+		targets.m_map = builder.CreateTexture("ShadowMomentMap", momentDesc);
+		targets.m_momentBlur = builder.CreateTexture("ShadowMomentBlur", momentDesc);
+
+		// The moment map keeps its own depth buffer, as it's rendered instead of the depth map
+		const RenderResource momentDepth = builder.CreateRenderbuffer("ShadowMomentDepth", 
+			{ m_momentResolution, m_momentResolution, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT });
+
+		builder.Write(targets.m_map, GL_COLOR_ATTACHMENT0);
+		builder.Write(momentDepth, GL_DEPTH_ATTACHMENT);
+		builder.Write(targets.m_momentBlur); // The blur draws it through its own framebuffer
+	}
+	else
+	{
+		targets.m_map = builder.CreateTexture("ShadowDepthMap", 
+			{ m_resolution, m_resolution, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT });
+		builder.Write(targets.m_map, GL_DEPTH_ATTACHMENT);
+	}
+
+	return targets;
+}
+
+void ShadowGeneration::RenderDepthMap(const RenderPassContext& context, const ShadowTargets& targets, 
+	const glm::vec3& lightDir, const glm::vec3& playerPos) const
 {
-	m_depthMapFBO->BindBuffer();
+	GpuProfiler::GetPtr()->BeginTimer("ShadowGeneration");
 
-	glViewport(0, 0, SHADOW_RESOLUTION, SHADOW_RESOLUTION);
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_DEPTH_BUFFER_BIT);
+	const float shadowDistance = Scalability::GetPtr()->GetSettings().m_shadowDistance;
 
 	m_lightView = glm::lookAt(playerPos - lightDir, glm::vec3(playerPos), glm::vec3(0.0f, 1.0f, 0.0f));
-	m_lightProjection = glm::ortho(-SHADOW_MAP_MAX_LENGTH, SHADOW_MAP_MAX_LENGTH, -SHADOW_MAP_MAX_LENGTH, SHADOW_MAP_MAX_LENGTH, 
-		SHADOW_MAP_NEAR_LIMIT, SHADOW_MAP_FAR_LIMIT);
+	m_lightProjection = glm::ortho(-shadowDistance, shadowDistance, -shadowDistance, shadowDistance, SHADOW_MAP_NEAR_LIMIT, 
+		SHADOW_MAP_FAR_LIMIT);
+
+	context.GetFramebuffer()->BindBuffer();
+
+	if (m_filterMode == ShadowFilterMode::VSM || m_filterMode == ShadowFilterMode::EVSM)
+	{
+		const bool exponential = (m_filterMode == ShadowFilterMode::EVSM);
+		glViewport(0, 0, m_momentResolution, m_momentResolution);
+
+		// Clear to the moments of the furthest depth, so nothing drawn means fully lit
+		if (exponential)
+		{
+			const float positiveDepth = std::exp(EVSM_POSITIVE_EXPONENT), negativeDepth = -std::exp(-EVSM_NEGATIVE_EXPONENT);
+			glClearColor(positiveDepth, positiveDepth * positiveDepth, negativeDepth, negativeDepth * negativeDepth);
+		}
+		else
+			glClearColor(1.0f, 1.0f, 0.0f, 0.0f);
+
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		Resource::GetShader("MomentMapping")->BindShader();
+		Resource::GetBoundShader()->SetUniform("exponentialMoments", exponential);
+	}
+	else
+	{
+		glViewport(0, 0, m_resolution, m_resolution);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_DEPTH_BUFFER_BIT);
+
+		Resource::GetShader("DepthMapping")->BindShader();
+	}
 
-	Resource::GetShader("DepthMapping")->BindShader();
 	Resource::GetBoundShader()->SetUniform("lightMatrixVP", m_lightProjection * m_lightView);
 }
 
-void ShadowGeneration::StopDepthMapRender() const
+void ShadowGeneration::StopDepthMapRender(const RenderPassContext& context, const ShadowTargets& targets) const
 {
-	m_depthMapFBO->UnbindBuffer();
+	if (m_filterMode == ShadowFilterMode::VSM || m_filterMode == ShadowFilterMode::EVSM)
+		this->BlurMomentMap(context, targets);
+
+	// The texture stays with the shadow map until the frame's last pass that reads it, so this holds until then
+	this->SetSamplerState(*context.GetTexture(targets.m_map));
+	context.GetFramebuffer()->UnbindBuffer();
+
+	GpuProfiler::GetPtr()->EndTimer("ShadowGeneration");
 }
 
-const std::shared_ptr<TextureBuffer> ShadowGeneration::GetDepthMap() const
+void ShadowGeneration::BlurMomentMap(const RenderPassContext& context, const ShadowTargets& targets) const
 {
-	return m_depthMapFBO->GetColorBuffer("DepthMap");
+	const auto momentMap = context.GetTexture(targets.m_map), momentBlur = context.GetTexture(targets.m_momentBlur);
+	momentBlur->SetFiltering(GL_LINEAR, GL_LINEAR);
+
+	// The blur is paid once per map here, rather than by every fragment that samples it
+	Resource::GetShader("MomentBlur")->BindShader();
+	glDisable(GL_DEPTH_TEST);
+
+	context.GetFramebuffer(targets.m_momentBlur, GL_COLOR_ATTACHMENT0)->BindBuffer();
+	Resource::GetBoundShader()->SetUniform("blurDirection", glm::vec2(1.0f / m_momentResolution, 0.0f));
+	momentMap->BindBuffer("momentMap", 0);
+	ObjectRenderer::GetPtr()->RenderQuad();
+
+	context.GetFramebuffer()->BindBuffer();
+	Resource::GetBoundShader()->SetUniform("blurDirection", glm::vec2(0.0f, 1.0f / m_momentResolution));
+	momentBlur->BindBuffer("momentMap", 0);
+	ObjectRenderer::GetPtr()->RenderQuad();
+
+	glEnable(GL_DEPTH_TEST);
+	momentMap->GenerateMipmaps();
+}
+
+void ShadowGeneration::SetSamplerState(const TextureBuffer& shadowMap) const
+{
+	switch (m_filterMode)
+	{
+	case ShadowFilterMode::PCF:
+		shadowMap.SetCompareMode(GL_NONE);
+		shadowMap.SetFiltering(GL_NEAREST, GL_NEAREST);
+		shadowMap.SetBorderColor(glm::vec4(1.0f));
+		break;
+	case ShadowFilterMode::HARDWARE_PCF:
+		// Hardware comparisons need the compare mode on, which the manual PCF can't sample with
+		shadowMap.SetCompareMode(GL_COMPARE_REF_TO_TEXTURE);
+		shadowMap.SetFiltering(GL_LINEAR, GL_LINEAR);
+		shadowMap.SetBorderColor(glm::vec4(1.0f));
+		break;
+	case ShadowFilterMode::VSM:
+		// The moment map's border has to read as fully lit for the current mode
+		shadowMap.SetFiltering(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+		shadowMap.SetBorderColor(glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+		break;
+	case ShadowFilterMode::EVSM:
+	{
+		const float positiveDepth = std::exp(EVSM_POSITIVE_EXPONENT);
+		const float negativeDepth = -std::exp(-EVSM_NEGATIVE_EXPONENT);
+
+		shadowMap.SetFiltering(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+		shadowMap.SetBorderColor(glm::vec4(positiveDepth, positiveDepth * positiveDepth, negativeDepth, 
+			negativeDepth * negativeDepth));
+		break;
+	}
+	}
+}
+
+void ShadowGeneration::BindShadowMaps(std::shared_ptr<TextureBuffer> shadowMap) const
+{
+	// Every sampler gets its own unit even when unused, as samplers of different types can't share one
+	auto currentShader = Resource::GetBoundShader();
+	currentShader->SetUniform("shadowFilterMode", (int)m_filterMode);
+	currentShader->SetUniform("depthMap", 7);
+	currentShader->SetUniform("depthMapCompare", 8);
+	currentShader->SetUniform("momentMap", 9);
+
+	switch (m_filterMode)
+	{
+	case ShadowFilterMode::PCF:
+		shadowMap->BindBuffer("depthMap", 7);
+		break;
+	case ShadowFilterMode::HARDWARE_PCF:
+		shadowMap->BindBuffer("depthMapCompare", 8);
+		break;
+	case ShadowFilterMode::VSM:
+	case ShadowFilterMode::EVSM:
+		shadowMap->BindBuffer("momentMap", 9);
+		break;
+	}
+}
+
+void ShadowGeneration::SetFilterMode(ShadowFilterMode mode)
+{
+	m_filterMode = mode;
 }
 
 const glm::mat4 ShadowGeneration::GetLightMatrix() const
 {
 	return m_lightProjection * m_lightView;
+}
+
+const ShadowFilterMode& ShadowGeneration::GetFilterMode() const
+{
+	return m_filterMode;
 }
\ No newline at end of file
@@ -1,26 +1,64 @@
 #pragma once
 #include "Graphics/BufferObjects.h"
+#include "Graphics/RenderGraph.h"
 #include <memory>
 #include <glm/glm.hpp>
 
-class FrameBuffer;
+// The values must match the SHADOW_FILTER defines in ShadowSampling.glsl
+enum class ShadowFilterMode
+{
+	PCF,			// 3x3 manual depth comparisons
+	HARDWARE_PCF,	// 2x2 taps of sampler2DShadow, each compared and filtered by the hardware
+	VSM,			// Variance shadow map, blurred once then mip-mapped so lookups are a single tap
+	EVSM			// Exponential variance shadow map, same as VSM but with much less light bleeding
+};
+
+struct ShadowTargets
+{
+	RenderResource m_map; // The depth map, or the moment map for the filter modes that need one
+	RenderResource m_momentBlur; // Only declared with the moment map, which the blur ping-pongs with
+};
 
 class ShadowGeneration
 {
 private:
-	std::shared_ptr<FrameBuffer> m_depthMapFBO;
+	uint32_t m_resolution, m_momentResolution;
+
 	mutable glm::mat4 m_lightView, m_lightProjection;
+	ShadowFilterMode m_filterMode;
 private:
 	ShadowGeneration();
 	~ShadowGeneration();
 
 	void InitScript();
+	void BlurMomentMap(const RenderPassContext& context, const ShadowTargets& targets) const;
+	void SetSamplerState(const TextureBuffer& shadowMap) const;
 public:
 	static ShadowGeneration* GetPtr();
 
-	void RenderDepthMap(const glm::vec3& lightDir, const glm::vec3& playerPos) const;
-	void StopDepthMapRender() const;
+	// Picks up the shadow resolution in the current settings, the graph allocates the maps at it from the next frame
+	void RebuildShadowMaps();
+
+	// Declares the maps the current filter mode needs as transient textures written by the pass being built
+	ShadowTargets CreateShadowMaps(RenderPassBuilder& builder) const;
+
+	/*
+		RenderDepthMap() : Binds and clears the shadow map, then binds the shader the shadow casters are drawn with
+		until StopDepthMapRender(), which blurs the moment map if there is one.
+		[context] - The context of the pass that created the shadow maps
+		[targets] - The shadow maps
+		[lightDir] - The direction the light shines in
+		[playerPos] - Where the shadow map is centred
+	*/
+	void RenderDepthMap(const RenderPassContext& context, const ShadowTargets& targets, const glm::vec3& lightDir, 
+		const glm::vec3& playerPos) const;
+	void StopDepthMapRender(const RenderPassContext& context, const ShadowTargets& targets) const;
+
+	// Binds the shadow map to the bound shader, each filter mode samples it through its own unit from 7 to 9
+	void BindShadowMaps(std::shared_ptr<TextureBuffer> shadowMap) const;
+
+	void SetFilterMode(ShadowFilterMode mode);
 public:
-	const std::shared_ptr<TextureBuffer> GetDepthMap() const;
 	const glm::mat4 GetLightMatrix() const;
+	const ShadowFilterMode& GetFilterMode() const;
 };
\ No newline at end of file
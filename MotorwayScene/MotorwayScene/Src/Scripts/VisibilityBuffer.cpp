@@ -0,0 +1,173 @@
+#include "VisibilityBuffer.h"
+#include "PostProcessing.h"
+#include "ShadowGeneration.h"
+#include "ClusteredLighting.h"
+#include "Graphics/BufferObjects.h"
+#include "Graphics/ObjectRenderer.h"
+#include "Utils/ResourceManager.h"
+#include "Utils/LoggingManager.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+namespace
+{
+	// The visibility buffer and vertex fetch take units 0 to 4 and the shadow maps and light data 7 to 12, so the
+	// material's textures go after all of them however many the mesh has
+	constexpr uint32_t MATERIAL_FIRST_UNIT = 13;
+}
+
+VisibilityBuffer::VisibilityBuffer() :
+	m_nextBaseID(1) // ID 0 is left for pixels that aren't covered by a registered model
+{
+	this->InitScript();
+}
+
+VisibilityBuffer::~VisibilityBuffer() {}
+
+VisibilityBuffer* VisibilityBuffer::GetPtr()
+{
+	static VisibilityBuffer singleton;
+	return &singleton;
+}
+
+void VisibilityBuffer::InitScript()
+{
+	Resource::LoadShader("VisibilityBuffer", "Resources/Shaders/VisibilityBuffer.glsl.vsh",
+		"Resources/Shaders/VisibilityBuffer.glsl.fsh");
+	Resource::LoadShader("VisibilityShading", "Resources/Shaders/PostProcessing.glsl.vsh",
+		"Resources/Shaders/VisibilityShading.glsl.fsh");
+}
+
+void VisibilityBuffer::RegisterModel(const std::string& modelKey)
+{
+	// Registering a model again drops its old ranges, then the rest are packed back together from the first ID, as the
+	// instance counts they were worked out from may have changed
+	m_records.erase(std::remove_if(m_records.begin(), m_records.end(), 
+		[&](const DrawRecord& record) { return record.m_modelKey == modelKey; }), m_records.end());
+
+	m_nextBaseID = 1;
+	for (auto& record : m_records)
+	{
+		record.m_baseID = m_nextBaseID;
+		m_nextBaseID += record.m_numTriangles * 
+			(uint32_t)Resource::GetModel(record.m_modelKey)->GetMeshes()[record.m_meshIndex].GetNumInstances();
+	}
+
+	const auto& meshes = Resource::GetModel(modelKey)->GetMeshes();
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		// The material pass reads the transforms from the instance buffer, it has nowhere to get a single model matrix from
+		if (meshes[i].GetNumInstances() == 0)
+		{
+			OutputLog("Only instanced models can be drawn into the visibility buffer, \"" + modelKey + "\" won't be shaded",
+				Logging::Severity::WARNING);
+			return;
+		}
+
+		// The IDs are passed to the shaders as ints, so they have to stay below INT_MAX
+		const uint64_t numIDs = (uint64_t)meshes[i].GetNumTriangles() * meshes[i].GetNumInstances();
+		if (m_nextBaseID + numIDs > (uint64_t)INT_MAX)
+		{
+			OutputLog("The visibility buffer has run out of IDs for the model \"" + modelKey + "\", it won't be shaded",
+				Logging::Severity::WARNING);
+			return;
+		}
+
+		m_records.push_back({ modelKey, i, m_nextBaseID, meshes[i].GetNumTriangles() });
+		m_nextBaseID += (uint32_t)numIDs;
+	}
+}
+
+VisibilityTargets VisibilityBuffer::CreateTargets(RenderPassBuilder& builder) const
+{
+	const uint32_t width = PostProcess::GetPtr()->GetWidth(), height = PostProcess::GetPtr()->GetHeight();
+	VisibilityTargets targets;
+
+	targets.m_visibility = builder.CreateTexture("VisibilityBuffer", { width, height, GL_R32UI, GL_RED_INTEGER, 
+		GL_UNSIGNED_INT });
+	targets.m_depth = builder.CreateTexture("VisibilityDepth", { width, height, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT,
+		GL_FLOAT });
+
+	builder.Write(targets.m_visibility, GL_COLOR_ATTACHMENT0);
+	builder.Write(targets.m_depth, GL_DEPTH_ATTACHMENT);
+
+	return targets;
+}
+
+void VisibilityBuffer::ReadTargets(RenderPassBuilder& builder, const VisibilityTargets& targets) const
+{
+	builder.Read(targets.m_visibility);
+	builder.Read(targets.m_depth);
+}
+
+void VisibilityBuffer::BeginGeometryPass(const RenderPassContext& context, const glm::mat4& vpMatrix) const
+{
+	context.GetFramebuffer()->BindBuffer();
+	glViewport(0, 0, PostProcess::GetPtr()->GetRenderWidth(), PostProcess::GetPtr()->GetRenderHeight());
+
+	const GLuint clearID[4] = { 0, 0, 0, 0 };
+	glClearBufferuiv(GL_COLOR, 0, clearID);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	Resource::GetShader("VisibilityBuffer")->BindShader();
+	Resource::GetBoundShader()->SetUniform("vpMatrix", vpMatrix);
+	Resource::GetBoundShader()->SetUniform("drawBaseID", 0);
+}
+
+void VisibilityBuffer::DrawRegisteredModels(InstanceSource source) const
+{
+	for (const auto& record : m_records)
+	{
+		Resource::GetBoundShader()->SetUniform("drawBaseID", (int)record.m_baseID);
+		Resource::GetBoundShader()->SetUniform("drawNumTriangles", (int)record.m_numTriangles);
+
+		// Only the positions are needed, so the position stream is used if there is one
+		Resource::GetModel(record.m_modelKey)->GetMeshes()[record.m_meshIndex].DrawDepth(source);
+	}
+
+	Resource::GetBoundShader()->SetUniform("drawBaseID", 0);
+}
+
+void VisibilityBuffer::BeginMaterialPass(const RenderPassContext& context, const VisibilityTargets& targets, 
+	RenderResource shadowMap, const glm::mat4& vpMatrix, const glm::vec3& cameraPos) const
+{
+	PostProcess::GetPtr()->RenderToFBO(context);
+
+	Resource::GetShader("VisibilityShading")->BindShader();
+	Resource::GetBoundShader()->SetUniform("vpMatrix", vpMatrix);
+	Resource::GetBoundShader()->SetUniform("lightMatrixVP", ShadowGeneration::GetPtr()->GetLightMatrix());
+	Resource::GetBoundShader()->SetUniform("cameraPos", cameraPos);
+	Resource::GetBoundShader()->SetUniform("screenSize", glm::vec2((float)PostProcess::GetPtr()->GetRenderWidth(), 
+		(float)PostProcess::GetPtr()->GetRenderHeight()));
+
+	context.GetTexture(targets.m_visibility)->BindBuffer("visibilityBuffer", 0);
+	context.GetTexture(targets.m_depth)->BindBuffer("visibilityDepth", 1);
+
+	ShadowGeneration::GetPtr()->BindShadowMaps(context.GetTexture(shadowMap));
+	ClusteredLighting::GetPtr()->BindLightData();
+}
+
+void VisibilityBuffer::ResolveMaterials(InstanceSource source) const
+{
+	// The material shader writes out the visibility buffer depth, so every pixel has to pass
+	glDepthFunc(GL_ALWAYS);
+
+	// One full screen pass per mesh, each one only keeps the pixels in its range of IDs so a pixel is shaded once
+	for (const auto& record : m_records)
+	{
+		const auto& mesh = Resource::GetModel(record.m_modelKey)->GetMeshes()[record.m_meshIndex];
+		const uint64_t numIDs = (uint64_t)record.m_numTriangles * mesh.GetNumInstances();
+
+		Resource::GetBoundShader()->SetUniform("drawBaseID", (int)record.m_baseID);
+		Resource::GetBoundShader()->SetUniform("drawNumIDs", (int)numIDs);
+		Resource::GetBoundShader()->SetUniform("drawNumTriangles", (int)record.m_numTriangles);
+
+		mesh.BindMaterial("mat", MATERIAL_FIRST_UNIT);
+		mesh.BindVertexFetch(source, 2);
+		ObjectRenderer::GetPtr()->RenderQuad();
+	}
+
+	glDepthFunc(GL_LESS);
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Graphics/RenderGraph.h"
+
+enum class InstanceSource;
+
+struct VisibilityTargets
+{
+	RenderResource m_visibility, m_depth;
+};
+
+class VisibilityBuffer
+{
+private:
+	// Every triangle of every instance of the mesh gets its own ID, starting from the base ID
+	struct DrawRecord
+	{
+		std::string m_modelKey;
+		size_t m_meshIndex;
+		uint32_t m_baseID, m_numTriangles;
+	};
+
+	std::vector<DrawRecord> m_records;
+	uint32_t m_nextBaseID;
+private:
+	VisibilityBuffer();
+	~VisibilityBuffer();
+
+	void InitScript();
+public:
+	static VisibilityBuffer* GetPtr();
+
+	// Gives each mesh of the loaded model a range of IDs, only registered models are shaded by the material pass.
+	// Register the model again whenever its instance count changes.
+	void RegisterModel(const std::string& modelKey);
+
+	// Declares the visibility buffer and its depth as transient textures written by the pass being built
+	VisibilityTargets CreateTargets(RenderPassBuilder& builder) const;
+	void ReadTargets(RenderPassBuilder& builder, const VisibilityTargets& targets) const;
+
+	/*
+		BeginGeometryPass() : Binds and clears the visibility buffer, then binds the visibility shader. Anything drawn
+		straight after this only writes depth (ID 0), which is how the simple scene geometry still occludes the models
+		before it's drawn forward later on.
+		[context] - The context of the pass that created the visibility buffer
+		[vpMatrix] - The camera's view projection matrix
+	*/
+	void BeginGeometryPass(const RenderPassContext& context, const glm::mat4& vpMatrix) const;
+
+	// Writes the (draw ID, triangle ID) of every registered model into the visibility buffer
+	void DrawRegisteredModels(InstanceSource source) const;
+
+	/*
+		BeginMaterialPass() : Binds the pass's scene framebuffer and the material shader, along with the visibility
+		buffer, shadow map and point light data. The directional light and sky color uniforms are left to the caller.
+		[context] - The context of a pass that reads the visibility buffer and shadow map, and draws to the scene
+		[targets] - The visibility buffer and its depth
+		[shadowMap] - The shadow map
+		[vpMatrix] - The camera's view projection matrix, used to rebuild each pixel's triangle
+		[cameraPos] - The camera's position
+	*/
+	void BeginMaterialPass(const RenderPassContext& context, const VisibilityTargets& targets, RenderResource shadowMap,
+		const glm::mat4& vpMatrix, const glm::vec3& cameraPos) const;
+
+	// Shades every pixel covered by a registered model exactly once, writing out the visibility buffer's depth with it
+	void ResolveMaterials(InstanceSource source) const;
+};
\ No newline at end of file
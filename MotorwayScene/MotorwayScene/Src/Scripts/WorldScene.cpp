@@ -2,13 +2,26 @@
 #include "Player.h"
 #include "PostProcessing.h"
 #include "ShadowGeneration.h"
+#include "OcclusionCulling.h"
+#include "OcclusionQueries.h"
+#include "DepthPrepass.h"
+#include "ScreenSpaceShadows.h"
+#include "ClusteredLighting.h"
+#include "DeferredShading.h"
+#include "VisibilityBuffer.h"
+#include "Scalability.h"
+#include "PerformanceOverlay.h"
 
 #include "Utils/ResourceManager.h"
 #include "Graphics/SceneLighting.h"
 #include "Graphics/ObjectRenderer.h"
+#include "Graphics/GpuProfiler.h"
 #include "Utils/RandomGenerator.h"
+#include "Utils/Profiler.h"
+#include "Core/WindowFrame.h"
 
 #include <glad/glad.h>
+#include <GLFW/glfw3.h>
 
 namespace World
 {
@@ -17,18 +30,34 @@ namespace World
 
 	const float STREET_BOUND_MIN_X = -8.5f;
 	const float STREET_BOUND_MAX_X = 8.5f;
+
+	const glm::vec3 LAMP_LIGHT_COLOR = { 12.0f, 9.0f, 5.5f };
+	const float LAMP_LIGHT_RADIUS = 14.0f;
+
+	// The forest is laid out the same way every launch, otherwise no two benchmark runs would draw the same scene
+	const uint32_t TREE_SEED = 1337;
+
+	const glm::vec2 TREE_MIN_BOUND = { -500.0f, -500.0f };
+	const glm::vec2 TREE_MAX_BOUND = { 500.0f, 500.0f };
+	const float TREE_SPAWN_HEIGHT = 1.9f;
+
+	// The instanced models the overlay counts, kept as strings so their lookups don't build new ones every frame
+	const std::string INSTANCED_MODELS[] = { "Tree", "StreetLamp", "CrashBarrier" };
 }
 
 WorldScene::WorldScene() :
-	m_player(nullptr)
+	m_player(nullptr), m_cullingMethod(CullingMethod::NONE), m_renderPath(RenderPath::FORWARD), m_treeCount(0)
 {}
 
 WorldScene::~WorldScene() {}
 
-void WorldScene::InitScript(Player& player)
+void WorldScene::InitScript(std::shared_ptr<WindowFrame> window, Player& player)
 {
+	m_window = window;
 	m_player = &player;
 
+	PostProcess::GetPtr()->SetWindowSize(window->GetWidth(), window->GetHeight());
+
 	this->SetupShaders();
 	this->SetupTextures();
 	this->SetupModels();
@@ -53,74 +82,449 @@ void WorldScene::SetupTextures()
 
 void WorldScene::SetupModels() 
 {
-	const auto treeTransformations = this->GenerateTrees(20000, glm::vec2(-500, -500), glm::vec2(500, 500), 1.9f);
+	PROFILE_ZONE("WorldScene::SetupModels");
+
+	// The instances are grouped by grid cell so each occlusion query cluster is a contiguous range of the instance buffer.
+	// The instanced models are also loaded with a position stream, as they make up most of the shadow and pre-pass work.
+	m_treeCount = Scalability::GetPtr()->GetSettings().m_treeCount;
+	auto treeTransformations = this->GenerateTrees(m_treeCount, World::TREE_MIN_BOUND, World::TREE_MAX_BOUND, 
+		World::TREE_SPAWN_HEIGHT);
+	OcclusionQueries::GetPtr()->SortIntoClusters(treeTransformations);
+
 	ObjectRenderer::GetPtr()->LoadModel("Tree", "Resources/Models/LowPolyTree/lowpolytree.obj", "None", 64.0f,
-		&treeTransformations[0], treeTransformations.size());
+		&treeTransformations[0], treeTransformations.size(), true);
+	this->RegisterTrees(treeTransformations);
+
+	auto barrierTransformations = this->GenerateAdjacentTranslations(3.0f, 0.1f, 4.36f);
+	OcclusionQueries::GetPtr()->SortIntoClusters(barrierTransformations);
 
-	const auto barrierTransformations = this->GenerateAdjacentTranslations(3.0f, 0.1f, 4.36f);
 	ObjectRenderer::GetPtr()->LoadModel("CrashBarrier", "Resources/Models/CrashBarrier/crash-barrier.obj",
-		"Resources/Textures/CrashBarrier/", 64.0f, &barrierTransformations[0], barrierTransformations.size());
+		"Resources/Textures/CrashBarrier/", 64.0f, &barrierTransformations[0], barrierTransformations.size(), true);
+	// The proxy is a slab through the middle of the rail, leaving out the posts and the open gap underneath it
+	OcclusionCulling::GetPtr()->RegisterInstances("CrashBarrier", barrierTransformations, true,
+		{ glm::vec3(0.4f, 0.6f, 0.05f), glm::vec3(0.6f, 0.85f, 0.95f) });
+	OcclusionQueries::GetPtr()->RegisterClusters("CrashBarrier", barrierTransformations);
+	VisibilityBuffer::GetPtr()->RegisterModel("CrashBarrier");
+
+	auto lampTransformations = this->GenerateAdjacentTranslations(15.0f, 0.25f, 7.0f, 0.0f, 180.0f, 0.0f);
+	OcclusionQueries::GetPtr()->SortIntoClusters(lampTransformations);
 
-	const auto lampTransformations = this->GenerateAdjacentTranslations(15.0f, 0.25f, 7.0f, 0.0f, 180.0f, 0.0f);
 	ObjectRenderer::GetPtr()->LoadModel("StreetLamp", "Resources/Models/StreetLamp/street-lamp.obj", "", 128.0f,
-		&lampTransformations[0], lampTransformations.size());
+		&lampTransformations[0], lampTransformations.size(), true);
+	OcclusionCulling::GetPtr()->RegisterInstances("StreetLamp", lampTransformations);
+	OcclusionQueries::GetPtr()->RegisterClusters("StreetLamp", lampTransformations);
+	VisibilityBuffer::GetPtr()->RegisterModel("StreetLamp");
+
+	// Each lamp gets a point light just under the top of the model, where the lamp head is
+	const BoundingBox& lampBounds = Resource::GetModel("StreetLamp")->GetBounds();
+	const glm::vec3 lampHead = glm::vec3((lampBounds.m_min.x + lampBounds.m_max.x) * 0.5f, lampBounds.m_max.y * 0.95f,
+		(lampBounds.m_min.z + lampBounds.m_max.z) * 0.5f);
+
+	for (const auto& transform : lampTransformations)
+	{
+		ClusteredLighting::GetPtr()->AddPointLight(glm::vec3(transform * glm::vec4(lampHead, 1.0f)), World::LAMP_LIGHT_COLOR,
+			World::LAMP_LIGHT_RADIUS);
+	}
 
 	ObjectRenderer::GetPtr()->LoadModel("DistantSun", "Resources/Models/DistantSun/sun.obj", "None");
 }
 
-void WorldScene::UpdateTick(const float& deltaTime) {}
+void WorldScene::HandleEvents()
+{
+	static float prevTime = 0.0f;
+	float currentTime = (float)m_window->GetTime();
+
+	// Press "O" to cycle through the culling methods of instanced models (none, software HiZ, hardware queries)
+	if (m_window->WasKeyPressed(GLFW_KEY_O) && (currentTime - prevTime) > 0.5f)
+	{
+		m_cullingMethod = (CullingMethod)(((int)m_cullingMethod + 1) % 3);
+		OcclusionCulling::GetPtr()->SetEnabled(m_cullingMethod == CullingMethod::SOFTWARE_HIZ);
+		prevTime = currentTime;
+	}
+
+	// Press "P" to toggle the depth pre-pass of the main scene pass
+	if (m_window->WasKeyPressed(GLFW_KEY_P) && (currentTime - prevTime) > 0.5f)
+	{
+		DepthPrepass::GetPtr()->SetEnabled(!DepthPrepass::GetPtr()->IsEnabled());
+		prevTime = currentTime;
+	}
+
+	// Press "K" to cycle the shadow filtering (PCF, hardware PCF, VSM, EVSM)
+	if (m_window->WasKeyPressed(GLFW_KEY_K) && (currentTime - prevTime) > 0.5f)
+	{
+		const auto nextMode = (ShadowFilterMode)(((int)ShadowGeneration::GetPtr()->GetFilterMode() + 1) % 4);
+		ShadowGeneration::GetPtr()->SetFilterMode(nextMode);
+		prevTime = currentTime;
+	}
+
+	// Press "L" to switch the street lamp lights on/off
+	if (m_window->WasKeyPressed(GLFW_KEY_L) && (currentTime - prevTime) > 0.5f)
+	{
+		ClusteredLighting::GetPtr()->SetEnabled(!ClusteredLighting::GetPtr()->IsEnabled());
+		prevTime = currentTime;
+	}
+
+	// Press "G" to cycle the render paths (forward, deferred, visibility buffer)
+	if (m_window->WasKeyPressed(GLFW_KEY_G) && (currentTime - prevTime) > 0.5f)
+	{
+		m_renderPath = (RenderPath)(((int)m_renderPath + 1) % 3);
+		prevTime = currentTime;
+	}
+
+	// Press "N" to cycle the anti-aliasing (MSAA, FXAA, TAA, none)
+	if (m_window->WasKeyPressed(GLFW_KEY_N) && (currentTime - prevTime) > 0.5f)
+	{
+		const auto nextMode = (AntiAliasingMode)(((int)PostProcess::GetPtr()->GetAntiAliasing() + 1) % 4);
+		PostProcess::GetPtr()->SetAntiAliasing(nextMode);
+		prevTime = currentTime;
+	}
+
+	// Press "R" to enable/disable dynamic resolution
+	if (m_window->WasKeyPressed(GLFW_KEY_R) && (currentTime - prevTime) > 0.5f)
+	{
+		PostProcess::GetPtr()->SetDynamicResolution(!PostProcess::GetPtr()->IsDynamicResolution());
+		prevTime = currentTime;
+	}
+
+	// Press "Q" to cycle the scalability presets (low, medium, high, ultra)
+	if (m_window->WasKeyPressed(GLFW_KEY_Q) && (currentTime - prevTime) > 0.5f)
+	{
+		const auto nextPreset = (QualityPreset)(((int)Scalability::GetPtr()->GetPreset() + 1) % 4);
+		Scalability::GetPtr()->SetPreset(nextPreset);
+		prevTime = currentTime;
+	}
+
+	// Press "T" to log the GPU times of the shadow map, scene and post process every couple of seconds
+	if (m_window->WasKeyPressed(GLFW_KEY_T) && (currentTime - prevTime) > 0.5f)
+	{
+		GpuProfiler::GetPtr()->SetLogEnabled(!GpuProfiler::GetPtr()->IsLogEnabled());
+		prevTime = currentTime;
+	}
+
+	// Press "I" to show the performance overlay, the render graph's passes are only timed while it's up
+	if (m_window->WasKeyPressed(GLFW_KEY_I) && (currentTime - prevTime) > 0.5f)
+	{
+		const bool visible = !PerformanceOverlay::GetPtr()->IsVisible();
+		PerformanceOverlay::GetPtr()->SetVisible(visible);
+		m_renderGraph.SetTimingEnabled(visible);
+		prevTime = currentTime;
+	}
+
+	// Press "C" to capture a profile of the next 60 frames
+	if (m_window->WasKeyPressed(GLFW_KEY_C) && (currentTime - prevTime) > 0.5f)
+	{
+		Profiler::GetPtr()->BeginCapture(60, "profile_capture.json");
+		prevTime = currentTime;
+	}
+
+	// Press "M" to cycle the screen space shadow mask (off, full resolution, half resolution)
+	if (m_window->WasKeyPressed(GLFW_KEY_M) && (currentTime - prevTime) > 0.5f)
+	{
+		const auto nextMode = (ShadowMaskMode)(((int)ScreenSpaceShadows::GetPtr()->GetMode() + 1) % 3);
+		ScreenSpaceShadows::GetPtr()->SetMode(nextMode);
+		prevTime = currentTime;
+	}
+}
+
+void WorldScene::UpdateTick(const float& deltaTime)
+{
+	PROFILE_ZONE("WorldScene::UpdateTick");
+
+	this->HandleEvents();
+
+	if (Scalability::GetPtr()->GetSettings().m_treeCount != m_treeCount)
+		this->RebuildTrees(Scalability::GetPtr()->GetSettings().m_treeCount);
+
+	// Last frame's time decides how much of the targets this frame is drawn to, which the jitter is then scaled to
+	PostProcess::GetPtr()->UpdateResolution(deltaTime);
+	m_player->GetCamera().SetJitter(PostProcess::GetPtr()->GetJitter());
+
+	if (OcclusionCulling::GetPtr()->IsEnabled())
+		OcclusionCulling::GetPtr()->CullInstances(m_player->GetCamera().GetMatrix(), m_player->GetCamera().GetPosition());
+
+	if (ClusteredLighting::GetPtr()->IsEnabled())
+	{
+		ClusteredLighting::GetPtr()->AssignLights(m_player->GetCamera().GetView(), 
+			m_player->GetCamera().GetUnjitteredProjection(),
+			glm::vec2(PostProcess::GetPtr()->GetRenderWidth(), PostProcess::GetPtr()->GetRenderHeight()));
+	}
+}
 
 void WorldScene::Render() const
 {
-	this->GenerateShadowMap();
+	PROFILE_ZONE("WorldScene::Render");
+
+	GpuProfiler::GetPtr()->BeginFrame();
 	this->RenderScene();
 }
 
-void WorldScene::GenerateShadowMap() const
+void WorldScene::GenerateShadowMap(const RenderPassContext& context, const ShadowTargets& shadowMaps) const
 {
-	ShadowGeneration::GetPtr()->RenderDepthMap(World::LIGHT_RAY_DIR, m_player->GetCamera().GetPosition());
+	ShadowGeneration::GetPtr()->RenderDepthMap(context, shadowMaps, World::LIGHT_RAY_DIR, 
+		m_player->GetCamera().GetPosition());
+	this->DrawOpaqueObjects(CullingMethod::NONE, true);
+	ShadowGeneration::GetPtr()->StopDepthMapRender(context, shadowMaps);
+}
 
-	this->DrawFloorPlane();
-	this->DrawMainRoad();
-	this->DrawRoadLine();
-	this->DrawRoadBarriers();
-	this->DrawPavements();
-	this->DrawStreetLamps();
+void WorldScene::RenderScene() const
+{
+	// Only this pass is culled, the shadow map still needs every instance as hidden objects can cast shadows
+	if (m_cullingMethod == CullingMethod::HARDWARE_QUERIES)
+		OcclusionQueries::GetPtr()->BeginFrame();
+
+	// Kept alive even though every render path reads the shadow map, as the scene's timer is started here
+	RenderPassBuilder shadowPass = m_renderGraph.AddPass("ShadowMap");
+	const ShadowTargets shadowMaps = ShadowGeneration::GetPtr()->CreateShadowMaps(shadowPass);
+	shadowPass.KeepAlive();
 
-	this->DrawTrees();
+	shadowPass.SetExecute([this, shadowMaps](const RenderPassContext& context)
+	{
+		this->GenerateShadowMap(context, shadowMaps);
+
+		// The scene's passes change with the render path, so its timer runs from here to the start of the post process
+		GpuProfiler::GetPtr()->BeginTimer("MainScene");
+	});
+
+	const RenderResource shadowMap = shadowMaps.m_map;
+	SceneTargets scene;
+
+	if (m_renderPath == RenderPath::DEFERRED)
+		scene = this->AddDeferredPasses(shadowMap);
+	else if (m_renderPath == RenderPath::VISIBILITY)
+		scene = this->AddVisibilityPasses(shadowMap);
+	else
+		scene = this->AddForwardPasses(shadowMap);
+
+	// The sun is drawn with the object shader the last pass left bound, so it still samples the shadow map
+	RenderPassBuilder sunPass = m_renderGraph.AddPass("DistantSun");
+	PostProcess::GetPtr()->DrawToScene(sunPass, scene);
+	sunPass.Read(shadowMap);
+
+	sunPass.SetExecute([this](const RenderPassContext& context)
+	{
+		PostProcess::GetPtr()->RenderToFBO(context);
+		this->DrawDistantSun();
+	});
+
+	// The queries for next frame are issued against this frame's finished depth buffer
+	if (m_cullingMethod == CullingMethod::HARDWARE_QUERIES)
+	{
+		// The boxes don't change the scene, it's only attached so they're tested against its depth
+		RenderPassBuilder queryPass = m_renderGraph.AddPass("OcclusionQueries");
+		PostProcess::GetPtr()->DrawToScene(queryPass, scene);
+		queryPass.KeepAlive(); // The results are only read back next frame, outside of the graph
 
-	ShadowGeneration::GetPtr()->StopDepthMapRender();
+		queryPass.SetExecute([this](const RenderPassContext& context)
+		{
+			PostProcess::GetPtr()->RenderToFBO(context);
+			OcclusionQueries::GetPtr()->IssueQueries(m_player->GetCamera().GetMatrix());
+		});
+	}
+
+	if (PerformanceOverlay::GetPtr()->IsVisible())
+		this->UpdateOverlayStats();
+
+	RenderPassBuilder postProcessPass = m_renderGraph.AddPass("PostProcess");
+	PostProcess::GetPtr()->ReadScene(postProcessPass, scene);
+	postProcessPass.KeepAlive();
+
+	postProcessPass.SetExecute([this, scene](const RenderPassContext& context)
+	{
+		GpuProfiler::GetPtr()->EndTimer("MainScene");
+
+		PostProcess::GetPtr()->SetViewProjection(m_player->GetCamera().GetUnjitteredMatrix());
+		PostProcess::GetPtr()->RenderPostProcess(context, scene);
+	});
+
+	m_renderGraph.Execute();
 }
 
-void WorldScene::RenderScene() const
+void WorldScene::UpdateOverlayStats() const
+{
+	for (const std::string& modelKey : World::INSTANCED_MODELS)
+	{
+		const Mesh& mesh = Resource::GetModel(modelKey)->GetMeshes()[0];
+		uint32_t numVisible = (uint32_t)mesh.GetNumInstances();
+
+		if (m_cullingMethod == CullingMethod::SOFTWARE_HIZ)
+			numVisible = (uint32_t)mesh.GetNumVisible();
+		else if (m_cullingMethod == CullingMethod::HARDWARE_QUERIES)
+			numVisible = OcclusionQueries::GetPtr()->GetNumVisibleInstances(modelKey);
+
+		PerformanceOverlay::GetPtr()->SetInstanceCount(modelKey, numVisible, (uint32_t)mesh.GetNumInstances());
+	}
+
+	PerformanceOverlay::GetPtr()->SetRenderTargetBytes(m_renderGraph.GetPooledBytes());
+}
+
+SceneTargets WorldScene::AddForwardPasses(RenderResource shadowMap) const
+{
+	const glm::mat4 vpMatrix = m_player->GetCamera().GetMatrix();
+	const bool useShadowMask = (ScreenSpaceShadows::GetPtr()->GetMode() != ShadowMaskMode::OFF);
+
+	RenderPassBuilder prepass = m_renderGraph.AddPass("DepthPrepass");
+	const SceneTargets scene = PostProcess::GetPtr()->CreateSceneTargets(prepass);
+
+	prepass.SetExecute([this, vpMatrix, useShadowMask](const RenderPassContext& context)
+	{
+		PostProcess::GetPtr()->RenderToFBO(context);
+
+		glClearColor(World::SKY_COLOR.r, World::SKY_COLOR.g, World::SKY_COLOR.b, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// The shadow mask is built from the scene depth, so it needs the pre-pass even if that's switched off
+		if (DepthPrepass::GetPtr()->IsEnabled() || useShadowMask)
+		{
+			DepthPrepass::GetPtr()->BeginPrepass(vpMatrix);
+			this->DrawOpaqueObjects(m_cullingMethod, true);
+			DepthPrepass::GetPtr()->EndPrepass();
+		}
+	});
+
+	// The mask passes are always added, the graph culls them when the shading pass doesn't read the mask
+	const RenderResource shadowMask = ScreenSpaceShadows::GetPtr()->AddMaskPasses(m_renderGraph, scene, shadowMap, 
+		vpMatrix, m_player->GetCamera().GetPosition());
+
+	RenderPassBuilder shadingPass = m_renderGraph.AddPass("ForwardShading");
+	PostProcess::GetPtr()->DrawToScene(shadingPass, scene);
+	shadingPass.Read(shadowMap);
+	if (useShadowMask)
+		shadingPass.Read(shadowMask);
+
+	shadingPass.SetExecute([this, shadowMap, shadowMask, useShadowMask](const RenderPassContext& context)
+	{
+		PostProcess::GetPtr()->RenderToFBO(context);
+
+		this->SetupObjectShader(context.GetTexture(shadowMap));
+		ScreenSpaceShadows::GetPtr()->BindShadowMask(useShadowMask ? context.GetTexture(shadowMask) : nullptr, 6);
+
+		DepthPrepass::GetPtr()->BeginShadingPass();
+		this->DrawOpaqueObjects(m_cullingMethod, false);
+		DepthPrepass::GetPtr()->EndShadingPass();
+	});
+
+	return scene;
+}
+
+SceneTargets WorldScene::AddDeferredPasses(RenderResource shadowMap) const
+{
+	// The pre-pass and shadow mask are skipped here, the G-buffer is already shaded exactly once per pixel
+	RenderPassBuilder geometryPass = m_renderGraph.AddPass("GBuffer");
+	const GBufferTargets gBuffer = DeferredShading::GetPtr()->CreateGBuffer(geometryPass);
+
+	geometryPass.SetExecute([this](const RenderPassContext& context)
+	{
+		DeferredShading::GetPtr()->BeginGeometryPass(context, m_player->GetCamera().GetMatrix());
+		this->DrawOpaqueObjects(m_cullingMethod, false);
+		DeferredShading::GetPtr()->EndGeometryPass();
+	});
+
+	// Every pixel of the scene is written by the lighting pass, so it doesn't need clearing first
+	RenderPassBuilder lightingPass = m_renderGraph.AddPass("DeferredLighting");
+	DeferredShading::GetPtr()->ReadGBuffer(lightingPass, gBuffer);
+	lightingPass.Read(shadowMap);
+	const SceneTargets scene = PostProcess::GetPtr()->CreateSceneTargets(lightingPass);
+
+	lightingPass.SetExecute([this, gBuffer, shadowMap](const RenderPassContext& context)
+	{
+		DeferredShading::GetPtr()->BeginLightingPass(context, gBuffer, shadowMap, m_player->GetCamera().GetMatrix(), 
+			m_player->GetCamera().GetPosition());
+		Resource::GetBoundShader()->SetUniform("skyColor", World::SKY_COLOR);
+		Resource::GetBoundShader()->SetUniform("fogDensity", Scalability::GetPtr()->GetSettings().m_fogDensity);
+		Lighting::SetDirLight("dirLight", World::LIGHT_RAY_DIR, glm::vec3(0.025f), glm::vec3(0.15f),
+			glm::vec3(0.75f));
+		DeferredShading::GetPtr()->RenderLightingPass();
+
+		// The sun is still drawn forward on top of the lit scene
+		this->SetupObjectShader(context.GetTexture(shadowMap));
+	});
+
+	return scene;
+}
+
+SceneTargets WorldScene::AddVisibilityPasses(RenderResource shadowMap) const
 {
-	PostProcess::GetPtr()->RenderToFBO();
+	// Hardware queries draw every instance here, as each cluster would need its own material pass to be conditional
+	const InstanceSource source = (m_cullingMethod == CullingMethod::SOFTWARE_HIZ) ? InstanceSource::VISIBLE :
+		InstanceSource::ALL;
+
+	RenderPassBuilder geometryPass = m_renderGraph.AddPass("VisibilityGeometry");
+	const VisibilityTargets targets = VisibilityBuffer::GetPtr()->CreateTargets(geometryPass);
+
+	geometryPass.SetExecute([this, source](const RenderPassContext& context)
+	{
+		VisibilityBuffer::GetPtr()->BeginGeometryPass(context, m_player->GetCamera().GetMatrix());
+		this->DrawSimpleGeometry();
+		VisibilityBuffer::GetPtr()->DrawRegisteredModels(source);
+	});
+
+	RenderPassBuilder materialPass = m_renderGraph.AddPass("VisibilityMaterials");
+	VisibilityBuffer::GetPtr()->ReadTargets(materialPass, targets);
+	materialPass.Read(shadowMap);
+	const SceneTargets scene = PostProcess::GetPtr()->CreateSceneTargets(materialPass);
 
-	glClearColor(World::SKY_COLOR.r, World::SKY_COLOR.g, World::SKY_COLOR.b, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	materialPass.SetExecute([this, source, targets, shadowMap](const RenderPassContext& context)
+	{
+		VisibilityBuffer::GetPtr()->BeginMaterialPass(context, targets, shadowMap, m_player->GetCamera().GetMatrix(), 
+			m_player->GetCamera().GetPosition());
+		glClearColor(World::SKY_COLOR.r, World::SKY_COLOR.g, World::SKY_COLOR.b, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		Resource::GetBoundShader()->SetUniform("skyColor", World::SKY_COLOR);
+		Resource::GetBoundShader()->SetUniform("fogDensity", Scalability::GetPtr()->GetSettings().m_fogDensity);
+		Lighting::SetDirLight("dirLight", World::LIGHT_RAY_DIR, glm::vec3(0.025f), glm::vec3(0.15f),
+			glm::vec3(0.75f));
+		VisibilityBuffer::GetPtr()->ResolveMaterials(source);
+	});
+
+	// The simple geometry is only a few big triangles, so it's drawn forward against the depth of the shaded models
+	RenderPassBuilder simpleGeometryPass = m_renderGraph.AddPass("SimpleGeometry");
+	PostProcess::GetPtr()->DrawToScene(simpleGeometryPass, scene);
+	simpleGeometryPass.Read(shadowMap);
+
+	simpleGeometryPass.SetExecute([this, shadowMap](const RenderPassContext& context)
+	{
+		PostProcess::GetPtr()->RenderToFBO(context);
+
+		this->SetupObjectShader(context.GetTexture(shadowMap));
+		this->DrawSimpleGeometry();
+	});
+
+	return scene;
+}
 
+void WorldScene::SetupObjectShader(std::shared_ptr<TextureBuffer> shadowMap) const
+{
 	Resource::GetShader("ObjectShaders")->BindShader();
 	Resource::GetShader("ObjectShaders")->SetUniform("cameraPos", m_player->GetCamera().GetPosition());
 	Resource::GetShader("ObjectShaders")->SetUniform("skyColor", World::SKY_COLOR);
+	Resource::GetShader("ObjectShaders")->SetUniform("fogDensity", Scalability::GetPtr()->GetSettings().m_fogDensity);
 
 	Resource::GetShader("ObjectShaders")->SetUniform("vpMatrix", m_player->GetCamera().GetMatrix());
 	Resource::GetShader("ObjectShaders")->SetUniform("lightMatrixVP", ShadowGeneration::GetPtr()->GetLightMatrix());
-	ShadowGeneration::GetPtr()->GetDepthMap()->BindBuffer("depthMap", 7);
+	Resource::GetShader("ObjectShaders")->SetUniform("useShadowMask", false); // Only the forward path binds the mask
+	ShadowGeneration::GetPtr()->BindShadowMaps(shadowMap);
+	ClusteredLighting::GetPtr()->BindLightData();
 
 	Lighting::SetDirLight("dirLight", World::LIGHT_RAY_DIR, glm::vec3(0.025f), glm::vec3(0.15f),
 		glm::vec3(0.75f));
+}
+
+void WorldScene::DrawOpaqueObjects(CullingMethod culling, bool depthOnly) const
+{
+	this->DrawSimpleGeometry();
+	this->DrawRoadBarriers(culling, depthOnly);
+	this->DrawStreetLamps(culling, depthOnly);
+
+	this->DrawTrees(culling, depthOnly);
+}
 
+void WorldScene::DrawSimpleGeometry() const
+{
 	this->DrawFloorPlane();
 	this->DrawMainRoad();
 	this->DrawRoadLine();
-	this->DrawRoadBarriers();
 	this->DrawPavements();
-	this->DrawStreetLamps();
-	
-	this->DrawTrees();
-	this->DrawDistantSun();
-
-	PostProcess::GetPtr()->RenderPostProcess();
 }
 
 void WorldScene::DrawDistantSun() const
@@ -135,14 +539,29 @@ void WorldScene::DrawDistantSun() const
 	ObjectRenderer::GetPtr()->RenderModel("DistantSun", "mat");
 }
 
-void WorldScene::DrawStreetLamps() const 
+void WorldScene::DrawStreetLamps(CullingMethod culling, bool depthOnly) const 
 {
-	ObjectRenderer::GetPtr()->RenderModel("StreetLamp", "mat");
+	this->DrawInstancedModel("StreetLamp", culling, depthOnly);
 }
 
-void WorldScene::DrawTrees() const
+void WorldScene::DrawTrees(CullingMethod culling, bool depthOnly) const
 {
-	ObjectRenderer::GetPtr()->RenderModel("Tree", "mat");
+	this->DrawInstancedModel("Tree", culling, depthOnly);
+}
+
+void WorldScene::DrawInstancedModel(const std::string& modelKey, CullingMethod culling, bool depthOnly) const
+{
+	if (culling == CullingMethod::HARDWARE_QUERIES)
+	{
+		OcclusionQueries::GetPtr()->RenderClusters(modelKey, "mat", m_player->GetCamera().GetPosition(), depthOnly);
+		return;
+	}
+
+	const InstanceSource source = (culling == CullingMethod::SOFTWARE_HIZ) ? InstanceSource::VISIBLE : InstanceSource::ALL;
+	if (depthOnly)
+		ObjectRenderer::GetPtr()->RenderModelDepth(modelKey, source);
+	else
+		ObjectRenderer::GetPtr()->RenderModel(modelKey, "mat", source);
 }
 
 void WorldScene::DrawPavements() const
@@ -167,9 +586,9 @@ void WorldScene::DrawPavements() const
 	ObjectRenderer::GetPtr()->RenderCube(2, 1, 1000);
 }
 
-void WorldScene::DrawRoadBarriers() const
+void WorldScene::DrawRoadBarriers(CullingMethod culling, bool depthOnly) const
 {
-	ObjectRenderer::GetPtr()->RenderModel("CrashBarrier", "mat");
+	this->DrawInstancedModel("CrashBarrier", culling, depthOnly);
 }
 
 void WorldScene::DrawRoadLine() const
@@ -228,6 +647,7 @@ std::vector<glm::mat4> WorldScene::GenerateTrees(uint32_t numGenerate, const glm
 	std::vector<glm::mat4> transformations;
 	transformations.reserve(numGenerate);
 
+	Random::SetSeed(World::TREE_SEED);
 	for (uint32_t i = 0; i < numGenerate; i++)
 	{
 		glm::vec3 position = glm::vec3(0.0f, spawnHeight, 0.0f);
@@ -247,6 +667,30 @@ std::vector<glm::mat4> WorldScene::GenerateTrees(uint32_t numGenerate, const glm
 	return transformations;
 }
 
+void WorldScene::RegisterTrees(const std::vector<glm::mat4>& sortedTransforms) const
+{
+	OcclusionQueries::GetPtr()->RegisterClusters("Tree", sortedTransforms);
+	VisibilityBuffer::GetPtr()->RegisterModel("Tree");
+
+	// Only the middle of the canopy is used as the occluder, so the proxy never pokes out of the tree
+	OcclusionCulling::GetPtr()->RegisterInstances("Tree", sortedTransforms, true, 
+		{ glm::vec3(0.35f, 0.35f, 0.35f), glm::vec3(0.65f, 0.8f, 0.65f) });
+}
+
+void WorldScene::RebuildTrees(uint32_t numTrees)
+{
+	PROFILE_ZONE("WorldScene::RebuildTrees");
+
+	// The same seed is used again, so the trees that were already there stay where they were
+	m_treeCount = numTrees;
+	auto treeTransformations = this->GenerateTrees(m_treeCount, World::TREE_MIN_BOUND, World::TREE_MAX_BOUND, 
+		World::TREE_SPAWN_HEIGHT);
+	OcclusionQueries::GetPtr()->SortIntoClusters(treeTransformations);
+
+	Resource::GetModel("Tree")->SetInstances(treeTransformations.data(), treeTransformations.size());
+	this->RegisterTrees(treeTransformations);
+}
+
 std::vector<glm::mat4> WorldScene::GenerateAdjacentTranslations(float distance, float scale, float xValue, float yValue,
 	float rotationAngle, float flippedAngle) const
 {
@@ -273,4 +717,14 @@ std::vector<glm::mat4> WorldScene::GenerateAdjacentTranslations(float distance,
 	}
 
 	return transformations;
+}
+
+RenderGraph& WorldScene::GetRenderGraph()
+{
+	return m_renderGraph;
+}
+
+const RenderGraph& WorldScene::GetRenderGraph() const
+{
+	return m_renderGraph;
 }
\ No newline at end of file
@@ -1,18 +1,57 @@
 #pragma once
 #include <memory>
 #include <vector>
+#include <string>
 #include <glm/glm.hpp>
 
+#include "Graphics/RenderGraph.h"
+
 class Player;
 class FrameBuffer;
+class WindowFrame;
+
+struct SceneTargets;
+struct ShadowTargets;
+
+enum class CullingMethod
+{
+	NONE,
+	SOFTWARE_HIZ,
+	HARDWARE_QUERIES
+};
+
+enum class RenderPath
+{
+	FORWARD,	// The objects are lit as they're drawn
+	DEFERRED,	// The objects are written to a G-buffer, then lit in screen space
+	VISIBILITY	// The instanced models only write their triangle IDs, then each pixel is shaded once in screen space
+};
 
 class WorldScene
 {
 private:
+	std::shared_ptr<WindowFrame> m_window;
 	Player* m_player;
+
+	CullingMethod m_cullingMethod;
+	RenderPath m_renderPath;
+	uint32_t m_treeCount; // The number of trees in the instance buffer, rebuilt when the quality settings change it
+
+	mutable RenderGraph m_renderGraph; // Kept between frames so the transient textures it pools can be reused
 private:
-	void GenerateShadowMap() const;
+	void HandleEvents();
+
+	void GenerateShadowMap(const RenderPassContext& context, const ShadowTargets& shadowMaps) const;
 	void RenderScene() const;
+	void UpdateOverlayStats() const; // Hands the overlay the visible instances and the render targets' memory
+
+	// Each render path adds the passes that draw the opaque objects, the first of which creates the scene targets
+	SceneTargets AddForwardPasses(RenderResource shadowMap) const;
+	SceneTargets AddDeferredPasses(RenderResource shadowMap) const;
+	SceneTargets AddVisibilityPasses(RenderResource shadowMap) const;
+
+	// Binds the object shader and sets the camera and lighting uniforms that both render paths share
+	void SetupObjectShader(std::shared_ptr<TextureBuffer> shadowMap) const;
 
 	/*
 		GenerateTrees() : Generates specified number of transformations for the trees within bounds given.
@@ -22,23 +61,31 @@ private:
 	*/
 	std::vector<glm::mat4> GenerateTrees(uint32_t numGenerate, const glm::vec2& minBound, const glm::vec2& maxBound,
 		float spawnHeight = 1.0f) const; // This is for generating random trees, creating a forest
+	// Hands the trees' transformations to the systems that cull and shade them, replacing any given to them before
+	void RegisterTrees(const std::vector<glm::mat4>& sortedTransforms) const;
+	void RebuildTrees(uint32_t numTrees); // Refills the loaded tree model's instance buffer in place
+
 	std::vector<glm::mat4> GenerateAdjacentTranslations(float distance, float scale, float xValue, float yValue = 0.0f,
 		float rotationAngle = 90.0f, float flippedAngle = -90.0f) const;
 private:
+	// Draws everything apart from the distant sun, the depth only passes skip the materials and use the position streams
+	void DrawOpaqueObjects(CullingMethod culling, bool depthOnly) const;
+	void DrawSimpleGeometry() const; // The road, pavements and floor, which aren't instanced
 	void DrawPavements() const;
-	void DrawRoadBarriers() const;
+	void DrawRoadBarriers(CullingMethod culling, bool depthOnly) const;
 	void DrawRoadLine() const;
 	void DrawMainRoad() const;
 	void DrawFloorPlane() const;
-	void DrawStreetLamps() const;
+	void DrawStreetLamps(CullingMethod culling, bool depthOnly) const;
 
-	void DrawTrees() const;
+	void DrawTrees(CullingMethod culling, bool depthOnly) const;
+	void DrawInstancedModel(const std::string& modelKey, CullingMethod culling, bool depthOnly) const;
 	void DrawDistantSun() const; // Must be drawn last
 public:
 	WorldScene();
 	~WorldScene();
 
-	void InitScript(Player& m_player);
+	void InitScript(std::shared_ptr<WindowFrame> window, Player& player);
 
 	void SetupShaders();
 	void SetupTextures();
@@ -46,4 +93,7 @@ public:
 
 	void UpdateTick(const float& deltaTime);
 	void Render() const;
+public:
+	RenderGraph& GetRenderGraph();
+	const RenderGraph& GetRenderGraph() const;
 };
\ No newline at end of file
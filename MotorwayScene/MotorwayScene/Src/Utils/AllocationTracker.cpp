@@ -0,0 +1,222 @@
+#include "AllocationTracker.h"
+#include "LoggingManager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace
+{
+	// Constant initialised, so they're ready for the allocations made before main() and during static initialisation
+	std::atomic<uint64_t> totalAllocations(0), totalBytes(0);
+	thread_local AllocationCounts threadTotals = { 0, 0 };
+
+	AllocationCounts frameStart = { 0, 0 }, lastFrame = { 0, 0 };
+	uint32_t frameIndex = 0;
+
+	bool enforcing = false;
+	uint32_t numWarmupFrames = 0;
+
+	void* Allocate(size_t size)
+	{
+		totalAllocations.fetch_add(1, std::memory_order_relaxed);
+		totalBytes.fetch_add(size, std::memory_order_relaxed);
+		threadTotals.m_allocations++;
+		threadTotals.m_bytes += size;
+
+		// malloc(0) is allowed to return null, but operator new has to hand back a unique pointer
+		return std::malloc(size > 0 ? size : 1);
+	}
+
+	AllocationCounts LoadTotals()
+	{
+		return { totalAllocations.load(std::memory_order_relaxed), totalBytes.load(std::memory_order_relaxed) };
+	}
+
+#ifdef __cpp_aligned_new
+	// For types aligned past what malloc gives, which the standard library sends here rather than to the plain new
+	void* AllocateAligned(size_t size, std::align_val_t alignment)
+	{
+		totalAllocations.fetch_add(1, std::memory_order_relaxed);
+		totalBytes.fetch_add(size, std::memory_order_relaxed);
+		threadTotals.m_allocations++;
+		threadTotals.m_bytes += size;
+
+	#ifdef _WIN32
+		return _aligned_malloc(size > 0 ? size : 1, (size_t)alignment);
+	#else
+		// aligned_alloc() wants the size to be a multiple of the alignment
+		const size_t alignedSize = (std::max(size, (size_t)1) + (size_t)alignment - 1) & ~((size_t)alignment - 1);
+		return std::aligned_alloc((size_t)alignment, alignedSize);
+	#endif
+	}
+
+	void FreeAligned(void* memory)
+	{
+	#ifdef _WIN32
+		_aligned_free(memory);
+	#else
+		std::free(memory);
+	#endif
+	}
+#endif
+}
+
+void* operator new(size_t size)
+{
+	void* memory = Allocate(size);
+	if (!memory)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	void* memory = Allocate(size);
+	if (!memory)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+#ifdef __cpp_aligned_new
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* memory = AllocateAligned(size, alignment);
+	if (!memory)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	void* memory = AllocateAligned(size, alignment);
+	if (!memory)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	FreeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+	FreeAligned(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+	FreeAligned(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept
+{
+	FreeAligned(memory);
+}
+#endif
+
+namespace AllocationTracker
+{
+	AllocationCounts GetThreadTotals()
+	{
+		return threadTotals;
+	}
+
+	void EndFrame()
+	{
+		const AllocationCounts totals = LoadTotals();
+		lastFrame = { totals.m_allocations - frameStart.m_allocations, totals.m_bytes - frameStart.m_bytes };
+		frameIndex++;
+
+		if (enforcing && frameIndex > numWarmupFrames && lastFrame.m_allocations > 0)
+		{
+			OutputLog("Frame " + std::to_string(frameIndex) + " made " + std::to_string(lastFrame.m_allocations) +
+				" heap allocations (" + std::to_string(lastFrame.m_bytes) + " bytes) after the warm-up, a capture with "
+				"--capture shows which zones made them", Logging::Severity::FATAL);
+		}
+
+		// Taken after the report, as the message allocates and would otherwise be charged to the next frame
+		frameStart = LoadTotals();
+	}
+
+	const AllocationCounts& GetLastFrame()
+	{
+		return lastFrame;
+	}
+
+	void EnforceZeroAllocations(uint32_t warmupFrames)
+	{
+		enforcing = true;
+		numWarmupFrames = frameIndex + warmupFrames;
+
+		OutputLog("Frames allocating after the next " + std::to_string(warmupFrames) + " will be reported as errors",
+			Logging::Severity::NOTIFICATION);
+	}
+}
\ No newline at end of file
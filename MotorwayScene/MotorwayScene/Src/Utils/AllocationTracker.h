@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+typedef unsigned int uint32_t;
+
+struct AllocationCounts
+{
+	uint64_t m_allocations;
+	uint64_t m_bytes; // As asked for, so the heap's own overhead isn't included
+};
+
+/*
+	AllocationTracker : Counts every allocation made through operator new, which is replaced app wide, so the frames can
+	be held to not allocating at all once they've settled. The counts are kept both for the whole app, which give the
+	per frame totals, and for each thread, which the profiler's zones take the difference of so a capture shows where
+	the allocations were made. Counting is a couple of relaxed atomic adds per allocation, so it's always on.
+*/
+namespace AllocationTracker
+{
+	// The calling thread's running totals since it started
+	AllocationCounts GetThreadTotals();
+
+	// Keeps the allocations made since the last call as the last frame's, and checks them if they're being enforced
+	void EndFrame();
+
+	const AllocationCounts& GetLastFrame();
+
+	/*
+		EnforceZeroAllocations() : Every frame after the warm-up that allocates is reported as a fatal error, which asserts
+		in debug builds. The warm-up lets the pools, caches and per frame vectors reach the size they settle at.
+		[warmupFrames] - How many frames may allocate before the check starts
+	*/
+	void EnforceZeroAllocations(uint32_t warmupFrames);
+}
\ No newline at end of file
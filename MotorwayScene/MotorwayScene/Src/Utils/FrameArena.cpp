@@ -0,0 +1,133 @@
+#include "FrameArena.h"
+#include "LoggingManager.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <new>
+
+namespace
+{
+	// Enough for the render graph, the culling output and the overlay at the scene's size, the blocks grow if it isn't
+	constexpr size_t INITIAL_BLOCK_SIZE = 4 * 1024 * 1024;
+
+	uintptr_t AlignUp(uintptr_t address, size_t alignment)
+	{
+		return (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	}
+}
+
+FrameArena::FrameArena() :
+	m_currentBlock(0), m_peakBytes(0), m_lastFrameBytes(0)
+{
+	for (FrameBlock& block : m_blocks)
+	{
+		block.m_memory = std::make_unique<uint8_t[]>(INITIAL_BLOCK_SIZE);
+		block.m_capacity = INITIAL_BLOCK_SIZE;
+		block.m_offset = 0;
+	}
+}
+
+FrameArena::~FrameArena()
+{
+	for (FrameBlock& block : m_blocks)
+	{
+		for (void* memory : block.m_overflow)
+			::operator delete(memory);
+	}
+}
+
+FrameArena* FrameArena::GetPtr()
+{
+	static FrameArena singleton;
+	return &singleton;
+}
+
+void* FrameArena::AllocateOverflow(FrameBlock& block, size_t size)
+{
+	// operator new's memory is aligned for any fundamental type, which is all Allocate() takes
+	void* memory = ::operator new(size);
+
+	std::lock_guard<std::mutex> lock(block.m_overflowMutex);
+	block.m_overflow.emplace_back(memory);
+	return memory;
+}
+
+void FrameArena::ResetBlock(FrameBlock& block)
+{
+	for (void* memory : block.m_overflow)
+		::operator delete(memory);
+
+	block.m_overflow.clear();
+
+	// Grown past the most any frame has needed, so a frame a little busier than the last doesn't spill again
+	if (m_peakBytes > block.m_capacity)
+	{
+		block.m_capacity = m_peakBytes + (m_peakBytes / 2);
+		block.m_memory = std::make_unique<uint8_t[]>(block.m_capacity);
+
+		OutputLog("A frame needed " + std::to_string(m_peakBytes / 1024) + " KB of the frame arena, its blocks are being "
+			"grown to " + std::to_string(block.m_capacity / 1024) + " KB", Logging::Severity::NOTIFICATION);
+	}
+
+	block.m_offset.store(0, std::memory_order_relaxed);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	FrameBlock& block = m_blocks[m_currentBlock];
+
+	// Room for the worst case padding is taken along with the size, so a single add is enough to claim the memory
+	const size_t claimed = size + alignment - 1;
+	const size_t offset = block.m_offset.fetch_add(claimed, std::memory_order_relaxed);
+	if (offset + claimed > block.m_capacity)
+		return this->AllocateOverflow(block, size);
+
+	return (void*)AlignUp((uintptr_t)(block.m_memory.get() + offset), alignment);
+}
+
+const char* FrameArena::Format(const char* format, ...)
+{
+	va_list args, argsCopy;
+	va_start(args, format);
+	va_copy(argsCopy, args);
+
+	const int length = std::vsnprintf(nullptr, 0, format, args);
+	va_end(args);
+
+	if (length < 0)
+	{
+		va_end(argsCopy);
+		return "";
+	}
+
+	char* string = (char*)this->Allocate((size_t)length + 1, alignof(char));
+	std::vsnprintf(string, (size_t)length + 1, format, argsCopy);
+	va_end(argsCopy);
+
+	return string;
+}
+
+void FrameArena::EndFrame()
+{
+	m_lastFrameBytes = m_blocks[m_currentBlock].m_offset.load(std::memory_order_relaxed);
+	m_peakBytes = std::max(m_peakBytes, m_lastFrameBytes);
+
+	// The block being moved on to was last used the frame before this one, which everything has finished with now
+	m_currentBlock = (m_currentBlock + 1) % FRAMES_IN_FLIGHT;
+	this->ResetBlock(m_blocks[m_currentBlock]);
+}
+
+const size_t& FrameArena::GetLastFrameBytes() const
+{
+	return m_lastFrameBytes;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+	size_t capacity = 0;
+	for (const FrameBlock& block : m_blocks)
+		capacity += block.m_capacity;
+
+	return capacity;
+}
\ No newline at end of file
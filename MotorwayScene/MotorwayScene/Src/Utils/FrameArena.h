@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef unsigned int uint32_t;
+
+/*
+	FrameArena : A bump allocator for the data that only lives for a frame (culling output, the render graph's pass
+	records, sort arrays, the overlay's strings). Nothing is freed on its own, the whole frame's memory is handed back
+	at once when the frame ends, so taking memory from it is an atomic add and it can be used from the job threads too.
+	There's a block for each frame in flight, so what was made during a frame stays valid until the end of the next one,
+	which lets a frame read what the last one left behind. When a frame asks for more than its block holds the rest
+	comes from the heap, and the block is grown when it's next reset so the steady state never touches the heap.
+*/
+class FrameArena
+{
+private:
+	static constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
+	struct FrameBlock
+	{
+		std::unique_ptr<uint8_t[]> m_memory;
+		size_t m_capacity;
+		std::atomic<size_t> m_offset; // Can run past the capacity, in which case it's how much the frame asked for
+
+		std::mutex m_overflowMutex;
+		std::vector<void*> m_overflow; // Heap allocations made once the block ran out
+	};
+
+	FrameBlock m_blocks[FRAMES_IN_FLIGHT];
+	uint32_t m_currentBlock;
+	size_t m_peakBytes, m_lastFrameBytes;
+private:
+	FrameArena();
+	~FrameArena();
+
+	void* AllocateOverflow(FrameBlock& block, size_t size);
+	void ResetBlock(FrameBlock& block);
+public:
+	static FrameArena* GetPtr();
+
+	/*
+		Allocate() : Takes memory from the current frame's block, which is left uninitialised.
+		[size] - The number of bytes needed
+		[alignment] - A power of two no larger than alignof(std::max_align_t)
+	*/
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// A printf style string that lasts as long as the rest of the frame's allocations
+	const char* Format(const char* format, ...);
+
+	// Moves on to the next frame's block, freeing everything made in it the last time it was used. This must only be
+	// called from the main thread, once nothing that was given memory from that block is still using it.
+	void EndFrame();
+public:
+	const size_t& GetLastFrameBytes() const;
+	size_t GetCapacity() const; // Of every block together
+};
+
+// Lets the standard containers take their memory from the frame arena. Freeing does nothing, the memory is reclaimed
+// when the frame's block is reset, so containers that grow should be reserved up front where the size is known.
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameAllocator() {}
+
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>&) {}
+
+	T* allocate(size_t count)
+	{
+		return (T*)FrameArena::GetPtr()->Allocate(count * sizeof(T), alignof(T));
+	}
+
+	void deallocate(T*, size_t) {}
+};
+
+template<typename T, typename U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+	return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+	return false;
+}
+
+// A container made from these must not be kept past the end of the next frame, as its memory gets reused
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr uint32_t MAX_WORKERS = 7;
+}
+
+JobSystem::JobSystem() :
+	m_currentJob(nullptr), m_numJobs(0), m_numBusyWorkers(0), m_generation(0), m_shutdown(false), m_nextJob(0),
+	m_jobsCompleted(0)
+{
+	const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+	const uint32_t numWorkers = std::min(hardwareThreads - 1, MAX_WORKERS);
+
+	for (uint32_t i = 0; i < numWorkers; i++)
+		m_workers.emplace_back(&JobSystem::WorkerLoop, this);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+
+	m_jobsAvailable.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+JobSystem* JobSystem::GetPtr()
+{
+	static JobSystem singleton;
+	return &singleton;
+}
+
+void JobSystem::WorkerLoop()
+{
+	Profiler::GetPtr()->SetThreadName("Job worker");
+
+	uint64_t lastGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobsAvailable.wait(lock, [&]() { return m_shutdown || m_generation != lastGeneration; });
+			if (m_shutdown)
+				return;
+
+			lastGeneration = m_generation;
+			m_numBusyWorkers++;
+		}
+
+		this->RunPendingJobs();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numBusyWorkers--;
+		}
+
+		m_jobsFinished.notify_one();
+	}
+}
+
+void JobSystem::RunPendingJobs()
+{
+	PROFILE_ZONE("JobSystem::RunPendingJobs");
+
+	uint32_t jobIndex = m_nextJob.fetch_add(1);
+	while (jobIndex < m_numJobs)
+	{
+		(*m_currentJob)(jobIndex);
+		m_jobsCompleted.fetch_add(1);
+
+		jobIndex = m_nextJob.fetch_add(1);
+	}
+}
+
+void JobSystem::Dispatch(uint32_t numJobs, const std::function<void(uint32_t)>& job)
+{
+	if (numJobs == 0)
+		return;
+
+	// Not worth waking up the workers for a single job
+	if (numJobs == 1 || m_workers.empty())
+	{
+		for (uint32_t i = 0; i < numJobs; i++)
+			job(i);
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_currentJob = &job;
+		m_numJobs = numJobs;
+		m_jobsCompleted = 0;
+		m_nextJob = 0;
+		m_generation++;
+	}
+
+	m_jobsAvailable.notify_all();
+	this->RunPendingJobs();
+
+	// Wait for the jobs still running on the workers, the workers must also be idle before the job can be released
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobsFinished.wait(lock, [&]() { return m_jobsCompleted == m_numJobs && m_numBusyWorkers == 0; });
+	
+	m_currentJob = nullptr;
+	m_numJobs = 0;
+}
+
+uint32_t JobSystem::GetNumThreads() const
+{
+	return (uint32_t)m_workers.size() + 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace Jobs
+{
+	void ParallelFor(uint32_t numJobs, const std::function<void(uint32_t)>& job)
+	{
+		JobSystem::GetPtr()->Dispatch(numJobs, job);
+	}
+
+	uint32_t GetNumThreads()
+	{
+		return JobSystem::GetPtr()->GetNumThreads();
+	}
+}
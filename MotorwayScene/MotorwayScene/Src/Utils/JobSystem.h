@@ -0,0 +1,44 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+typedef unsigned int uint32_t;
+
+class JobSystem
+{
+private:
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_jobsAvailable, m_jobsFinished;
+
+	const std::function<void(uint32_t)>* m_currentJob;
+	uint32_t m_numJobs, m_numBusyWorkers;
+	uint64_t m_generation; // Incremented on every dispatch so sleeping workers know there is new work
+	bool m_shutdown;
+
+	std::atomic<uint32_t> m_nextJob, m_jobsCompleted;
+private:
+	JobSystem();
+	~JobSystem();
+
+	void WorkerLoop();
+	void RunPendingJobs();
+public:
+	static JobSystem* GetPtr();
+
+	// Runs job(0) to job(numJobs - 1) across the worker threads and the calling thread, and blocks until all of them
+	// have finished. This must only be called from the main thread.
+	void Dispatch(uint32_t numJobs, const std::function<void(uint32_t)>& job);
+public:
+	uint32_t GetNumThreads() const; // Includes the calling thread
+};
+
+namespace Jobs
+{
+	void ParallelFor(uint32_t numJobs, const std::function<void(uint32_t)>& job);
+	uint32_t GetNumThreads();
+}
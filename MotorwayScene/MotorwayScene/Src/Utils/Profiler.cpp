@@ -0,0 +1,163 @@
+#include "Profiler.h"
+#include "LoggingManager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace Profiling
+{
+	std::atomic<bool> capturing(false);
+}
+
+namespace
+{
+	// How many zones each thread can record in a capture, anything after that is dropped
+	constexpr uint32_t MAX_EVENTS_PER_THREAD = 1 << 16;
+}
+
+Profiler::Profiler() :
+	m_captureIndex(0), m_numCaptureFrames(0), m_numCapturedFrames(0), m_captureStartTime(0), m_numDroppedEvents(0)
+{}
+
+Profiler::~Profiler() {}
+
+Profiler* Profiler::GetPtr()
+{
+	static Profiler singleton;
+	return &singleton;
+}
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer()
+{
+	thread_local ThreadBuffer* buffer = nullptr;
+	if (buffer)
+		return buffer;
+
+	// Only taken once per thread, every zone after this goes straight into the buffer
+	std::lock_guard<std::mutex> lock(m_registryMutex);
+
+	m_threadBuffers.emplace_back(new ThreadBuffer());
+	buffer = m_threadBuffers.back().get();
+	buffer->m_threadIndex = (uint32_t)(m_threadBuffers.size() - 1);
+	buffer->m_name = "Thread " + std::to_string(buffer->m_threadIndex);
+	buffer->m_events.reset(new ZoneEvent[MAX_EVENTS_PER_THREAD]);
+	buffer->m_numEvents = 0;
+	buffer->m_captureIndex = m_captureIndex.load();
+
+	return buffer;
+}
+
+void Profiler::BeginCapture(uint32_t numFrames, const std::string& outputPath)
+{
+	if (IsCapturing())
+	{
+		OutputLog("A profile capture is already running", Logging::Severity::WARNING);
+		return;
+	}
+
+	m_numCaptureFrames = std::max(numFrames, 1u);
+	m_numCapturedFrames = 0;
+	m_capturePath = outputPath;
+	m_numDroppedEvents = 0;
+	m_captureStartTime = GetTimestamp();
+
+	// The threads see the new capture index before they see the capture start, so none of them keep last capture's zones
+	m_captureIndex.fetch_add(1, std::memory_order_release);
+	Profiling::capturing.store(true, std::memory_order_release);
+
+	OutputLog("Capturing a profile of the next " + std::to_string(m_numCaptureFrames) + " frames",
+		Logging::Severity::NOTIFICATION);
+}
+
+void Profiler::EndFrame()
+{
+	if (!IsCapturing() || ++m_numCapturedFrames < m_numCaptureFrames)
+		return;
+
+	Profiling::capturing.store(false, std::memory_order_release);
+	this->WriteCapture();
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	ThreadBuffer* buffer = this->GetThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(m_registryMutex);
+	buffer->m_name = name;
+}
+
+void Profiler::RecordZone(const char* name, int64_t startTime, int64_t endTime, const AllocationCounts& allocations)
+{
+	// Zones still open when the capture ended are left out, rather than written into the next one
+	if (!Profiling::capturing.load(std::memory_order_acquire))
+		return;
+
+	ThreadBuffer* buffer = this->GetThreadBuffer();
+
+	const uint32_t captureIndex = m_captureIndex.load(std::memory_order_acquire);
+	if (buffer->m_captureIndex.load(std::memory_order_relaxed) != captureIndex)
+	{
+		buffer->m_numEvents.store(0, std::memory_order_relaxed);
+		buffer->m_captureIndex.store(captureIndex, std::memory_order_relaxed);
+	}
+
+	const uint32_t eventIndex = buffer->m_numEvents.load(std::memory_order_relaxed);
+	if (eventIndex == MAX_EVENTS_PER_THREAD)
+	{
+		m_numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	buffer->m_events[eventIndex] = { name, startTime, endTime, allocations };
+	buffer->m_numEvents.store(eventIndex + 1, std::memory_order_release);
+}
+
+void Profiler::WriteCapture()
+{
+	std::ofstream file(m_capturePath);
+	if (!file.is_open())
+	{
+		OutputLog("Failed to write the profile capture to \"" + m_capturePath + "\"", Logging::Severity::WARNING);
+		return;
+	}
+
+	// Chrome's trace event format, with the times in microseconds from the start of the capture
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+	std::lock_guard<std::mutex> lock(m_registryMutex);
+
+	size_t numWrittenEvents = 0;
+	bool firstEvent = true;
+	for (const auto& buffer : m_threadBuffers)
+	{
+		file << (firstEvent ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " <<
+			buffer->m_threadIndex << ", \"args\": {\"name\": \"" << buffer->m_name << "\"}}";
+		firstEvent = false;
+
+		const uint32_t numEvents = buffer->m_numEvents.load(std::memory_order_acquire);
+		if (buffer->m_captureIndex.load(std::memory_order_relaxed) != m_captureIndex.load())
+			continue;
+
+		for (uint32_t i = 0; i < numEvents; i++)
+		{
+			const ZoneEvent& zone = buffer->m_events[i];
+			file << ",\n{\"name\": \"" << zone.m_name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->m_threadIndex <<
+				", \"ts\": " << (double)(zone.m_startTime - m_captureStartTime) / 1000.0 << ", \"dur\": " <<
+				(double)(zone.m_endTime - zone.m_startTime) / 1000.0 << ", \"args\": {\"allocations\": " <<
+				zone.m_allocations.m_allocations << ", \"allocated_bytes\": " << zone.m_allocations.m_bytes << "}}";
+		}
+
+		numWrittenEvents += numEvents;
+	}
+
+	file << "\n]}\n";
+
+	std::string message = "Wrote " + std::to_string(numWrittenEvents) + " zones over " +
+		std::to_string(m_numCaptureFrames) + " frames to \"" + m_capturePath + "\"";
+	if (m_numDroppedEvents > 0)
+		message += ", " + std::to_string(m_numDroppedEvents.load()) + " were dropped as their thread's buffer was full";
+
+	OutputLog(message, Logging::Severity::NOTIFICATION);
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+#include "Utils/AllocationTracker.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef unsigned int uint32_t;
+
+// Times the rest of the enclosing scope, the name has to be a string literal as only the pointer is kept
+#define PROFILE_ZONE_CONCAT_INNER(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name)
+
+namespace Profiling
+{
+	extern std::atomic<bool> capturing; // Read by every zone, so it's kept outside of the profiler
+}
+
+/*
+	Profiler : Records the zones timed on every thread while a capture is running, and writes them out as Chrome
+	trace events (which chrome://tracing or Perfetto can open) once the capture has run for the frames asked for, along
+	with the heap allocations each zone made on its thread (including those of the zones inside it). Each
+	thread writes its zones into a buffer of its own without locking, the lock is only taken the first time a thread
+	records anything. Outside of a capture a zone costs a single branch on a flag that's almost never set.
+*/
+class Profiler
+{
+private:
+	struct ZoneEvent
+	{
+		const char* m_name;
+		int64_t m_startTime, m_endTime; // In nanoseconds on the steady clock
+		AllocationCounts m_allocations;
+	};
+
+	struct ThreadBuffer
+	{
+		std::string m_name;
+		uint32_t m_threadIndex;
+		std::unique_ptr<ZoneEvent[]> m_events;
+
+		// Only the owning thread writes, the count is published after each event so the main thread can read them
+		std::atomic<uint32_t> m_numEvents;
+		std::atomic<uint32_t> m_captureIndex; // The capture the events are from, so the owning thread knows to start over
+	};
+
+	std::mutex m_registryMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+
+	std::atomic<uint32_t> m_captureIndex;
+	uint32_t m_numCaptureFrames, m_numCapturedFrames;
+	int64_t m_captureStartTime;
+	std::string m_capturePath;
+	std::atomic<uint32_t> m_numDroppedEvents;
+private:
+	Profiler();
+	~Profiler();
+
+	ThreadBuffer* GetThreadBuffer();
+	void WriteCapture();
+public:
+	static Profiler* GetPtr();
+
+	static bool IsCapturing()
+	{
+		return Profiling::capturing.load(std::memory_order_relaxed);
+	}
+
+	static int64_t GetTimestamp()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/*
+		BeginCapture() : Starts recording the zones of every thread, this must only be called from the main thread.
+		[numFrames] - How many calls to EndFrame() the capture runs for before it's written out
+		[outputPath] - Where the trace is written
+	*/
+	void BeginCapture(uint32_t numFrames, const std::string& outputPath);
+
+	// Counts a frame of the capture, and writes it out once it has run for long enough
+	void EndFrame();
+
+	// The name the calling thread is shown under in the trace
+	void SetThreadName(const std::string& name);
+
+	void RecordZone(const char* name, int64_t startTime, int64_t endTime, const AllocationCounts& allocations);
+};
+
+class ProfileZone
+{
+private:
+	const char* m_name;
+	int64_t m_startTime; // Zero when the zone started outside of a capture
+	AllocationCounts m_startAllocations;
+public:
+	explicit ProfileZone(const char* name) :
+		m_name(name), m_startTime(0)
+	{
+		if (Profiler::IsCapturing())
+		{
+			m_startTime = Profiler::GetTimestamp();
+			m_startAllocations = AllocationTracker::GetThreadTotals();
+		}
+	}
+
+	~ProfileZone()
+	{
+		if (m_startTime == 0)
+			return;
+
+		const AllocationCounts totals = AllocationTracker::GetThreadTotals();
+		Profiler::GetPtr()->RecordZone(m_name, m_startTime, Profiler::GetTimestamp(), 
+			{ totals.m_allocations - m_startAllocations.m_allocations, totals.m_bytes - m_startAllocations.m_bytes });
+	}
+};
\ No newline at end of file
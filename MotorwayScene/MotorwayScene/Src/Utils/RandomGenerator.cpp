@@ -10,6 +10,11 @@ namespace
 
 namespace Random
 {
+	void SetSeed(uint32_t seed)
+	{
+		randEngine.seed(seed);
+	}
+
 	int GenerateInt(int min, int max)
 	{
 		std::uniform_int_distribution<int> randGenerator(min, max);
@@ -1,7 +1,12 @@
 #pragma once
 
+typedef unsigned int uint32_t;
+
 namespace Random
 {
+	// The generator is seeded from the clock at startup, this restarts it so the numbers after it are the same every run
+	void SetSeed(uint32_t seed);
+
 	int GenerateInt(int min, int max);
 	float GenerateFloat(float min, float max);
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "ResourceManager.h"
+#include "Profiler.h"
+#include "Graphics/GLDebug.h"
 #include <glad/glad.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -16,6 +18,8 @@ ShaderManager* ShaderManager::GetPtr()
 void ShaderManager::LoadShader(const std::string& key, const std::string& vertexPath, 
 	const std::string& fragmentPath, const std::string& geometryPath) const
 {
+	PROFILE_ZONE("ShaderManager::LoadShader");
+
 	// Only load the shader if it hasn't been
 	bool shaderLoaded = false;
 	for (const auto shader : m_shaders)
@@ -29,7 +33,10 @@ void ShaderManager::LoadShader(const std::string& key, const std::string& vertex
 	}
 
 	if (!shaderLoaded)
+	{
 		m_shaders[key] = std::make_shared<ShaderProgram>(vertexPath, fragmentPath, geometryPath);
+		GLDebug::LabelObject(GLDebug::ObjectType::PROGRAM, m_shaders[key]->m_ID, key);
+	}
 }
 
 std::shared_ptr<ShaderProgram> ShaderManager::GetShader(const std::string& key) const
@@ -62,6 +69,8 @@ TextureManager* TextureManager::GetPtr()
 
 void TextureManager::LoadTexture(const std::string& key, const std::string& path, bool srgb, bool flipVertical) const
 {
+	PROFILE_ZONE("TextureManager::LoadTexture");
+
 	// Only load the texture if it hasn't been
 	bool textureLoaded = false;
 	for (const auto texture : m_textures)
@@ -96,6 +105,8 @@ CubemapManager* CubemapManager::GetPtr()
 
 void CubemapManager::LoadCubemap(const std::string& key, const std::array<std::string, 6>& paths) const
 {
+	PROFILE_ZONE("CubemapManager::LoadCubemap");
+
 	// Only load the cubemap if it hasn't been
 	bool cubemapLoaded = false;
 	for (const auto cubemap : m_cubemaps)
@@ -129,8 +140,10 @@ ModelManager* ModelManager::GetPtr()
 }
 
 void ModelManager::LoadModel(const std::string& key, const std::string& modelPath, const std::string& textureDir, 
-	float shininess, const glm::mat4* instancedData, size_t numInstances) const
+	float shininess, const glm::mat4* instancedData, size_t numInstances, bool positionStream) const
 {
+	PROFILE_ZONE("ModelManager::LoadModel");
+
 	// Only load the model if it hasn't been
 	bool modelLoaded = false;
 	for (const auto model : m_models)
@@ -143,7 +156,8 @@ void ModelManager::LoadModel(const std::string& key, const std::string& modelPat
 	}
 
 	if (!modelLoaded)
-		m_models.insert(std::pair<std::string, Model>(key, Model(modelPath, textureDir, shininess, instancedData, numInstances)));
+		m_models.insert(std::pair<std::string, Model>(key, Model(modelPath, textureDir, shininess, instancedData, numInstances, 
+			positionStream)));
 }
 
 const Model* ModelManager::GetModel(const std::string& key)
@@ -192,9 +206,10 @@ namespace Resource
 	}
 
 	void LoadModel(const std::string& key, const std::string& modelPath, const std::string& textureDir, float shininess,
-		const glm::mat4* instancedData, size_t numInstances)
+		const glm::mat4* instancedData, size_t numInstances, bool positionStream)
 	{
-		return ModelManager::GetPtr()->LoadModel(key, modelPath, textureDir, shininess, instancedData, numInstances);
+		return ModelManager::GetPtr()->LoadModel(key, modelPath, textureDir, shininess, instancedData, numInstances, 
+			positionStream);
 	}
 
 	const Model* GetModel(const std::string& key)
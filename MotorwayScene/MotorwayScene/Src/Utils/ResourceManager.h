@@ -64,7 +64,7 @@ public:
 	static ModelManager* GetPtr();
 
 	void LoadModel(const std::string& key, const std::string& modelPath, const std::string& textureDir, float shininess,
-		const glm::mat4* instancedData, size_t numInstances) const;
+		const glm::mat4* instancedData, size_t numInstances, bool positionStream) const;
 	const Model* GetModel(const std::string& key);
 };
 
@@ -84,7 +84,8 @@ namespace Resource
 	std::shared_ptr<CubemapComponent> GetCubemap(const std::string& key);
 
 	void LoadModel(const std::string& key, const std::string& modelPath, const std::string& textureDir = "", 
-		float shininess = 64.0f, const glm::mat4* instancedData = nullptr, size_t numInstances = 0);
+		float shininess = 64.0f, const glm::mat4* instancedData = nullptr, size_t numInstances = 0, 
+		bool positionStream = false);
 	const Model* GetModel(const std::string& key);
 }
 